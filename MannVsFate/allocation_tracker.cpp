@@ -0,0 +1,398 @@
+#include "allocation_tracker.h"
+
+#if ALLOCATION_TRACKING
+
+#include "json.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <new>
+
+namespace
+{
+	constexpr std::size_t phase_count = static_cast<std::size_t>(allocation_tracker::phase::count);
+	constexpr std::size_t subsystem_count = static_cast<std::size_t>(allocation_tracker::subsystem::count);
+
+	// Every block is preceded by a header that remembers what it was counted as, so that freeing it can be counted the same way.
+	// The header keeps the block aligned like malloc would.
+	struct alignas(alignof(std::max_align_t)) block_header
+	{
+		std::size_t size;
+		allocation_tracker::subsystem tag;
+	};
+
+	// The counts of one subsystem in one phase.
+	// These are only ever zero initialized statically, so that the first allocations of the program are counted too.
+	struct counters
+	{
+		std::atomic<std::uint64_t> allocations;
+		std::atomic<std::uint64_t> frees;
+		std::atomic<std::uint64_t> bytes;
+	};
+
+	// The totals of one wave, which are only recorded when a wave ends.
+	struct wave_counters
+	{
+		// How many times the wave was generated, counting candidates and rerolls.
+		unsigned int generations;
+		std::uint64_t allocations;
+		std::uint64_t bytes;
+		std::int64_t peak_live_bytes;
+	};
+
+	counters phase_counters[phase_count][subsystem_count];
+	// The most live bytes there were while any thread was allocating in each phase.
+	std::atomic<std::int64_t> phase_peaks[phase_count];
+	// The bytes that are live, and the most that there have been, in total and by subsystem.
+	std::atomic<std::int64_t> live_bytes;
+	std::atomic<std::int64_t> peak_live_bytes;
+	std::atomic<std::int64_t> subsystem_live_bytes[subsystem_count];
+	std::atomic<std::int64_t> subsystem_peaks[subsystem_count];
+
+	// What the calling thread is doing.
+	thread_local allocation_tracker::phase current_phase = allocation_tracker::phase::other;
+	thread_local allocation_tracker::subsystem current_subsystem = allocation_tracker::subsystem::untagged;
+	thread_local int current_wave = 0;
+	// The calling thread's running totals, which waves are measured against.
+	thread_local std::uint64_t thread_allocations = 0;
+	thread_local std::uint64_t thread_bytes = 0;
+	// The most live bytes that the calling thread has seen since its current wave started.
+	thread_local std::int64_t thread_peak = 0;
+
+	// Guards the waves, since candidate waves are generated on several threads.
+	std::mutex waves_mutex;
+
+	std::map<int, wave_counters>& get_waves()
+	{
+		static std::map<int, wave_counters> waves;
+		return waves;
+	}
+
+	// Raise an atomic maximum to a value.
+	void update_max(std::atomic<std::int64_t>& max, std::int64_t value)
+	{
+		std::int64_t previous = max.load(std::memory_order_relaxed);
+		while (previous < value && !max.compare_exchange_weak(previous, value, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	void* allocate(std::size_t size) noexcept
+	{
+		block_header* header = static_cast<block_header*>(std::malloc(sizeof(block_header) + size));
+		if (header == nullptr)
+		{
+			return nullptr;
+		}
+		header->size = size;
+		header->tag = current_subsystem;
+
+		const std::size_t phase_index = static_cast<std::size_t>(current_phase);
+		const std::size_t subsystem_index = static_cast<std::size_t>(current_subsystem);
+		const std::int64_t signed_size = static_cast<std::int64_t>(size);
+
+		counters& c = phase_counters[phase_index][subsystem_index];
+		c.allocations.fetch_add(1, std::memory_order_relaxed);
+		c.bytes.fetch_add(size, std::memory_order_relaxed);
+
+		const std::int64_t live = live_bytes.fetch_add(signed_size, std::memory_order_relaxed) + signed_size;
+		update_max(peak_live_bytes, live);
+		update_max(phase_peaks[phase_index], live);
+		update_max(subsystem_peaks[subsystem_index], subsystem_live_bytes[subsystem_index].fetch_add(signed_size, std::memory_order_relaxed) + signed_size);
+
+		++thread_allocations;
+		thread_bytes += size;
+		thread_peak = std::max(thread_peak, live);
+
+		return header + 1;
+	}
+
+	void deallocate(void* block) noexcept
+	{
+		if (block == nullptr)
+		{
+			return;
+		}
+		block_header* header = static_cast<block_header*>(block) - 1;
+		const std::size_t subsystem_index = static_cast<std::size_t>(header->tag);
+		const std::int64_t signed_size = static_cast<std::int64_t>(header->size);
+
+		phase_counters[static_cast<std::size_t>(current_phase)][subsystem_index].frees.fetch_add(1, std::memory_order_relaxed);
+		live_bytes.fetch_sub(signed_size, std::memory_order_relaxed);
+		subsystem_live_bytes[subsystem_index].fetch_sub(signed_size, std::memory_order_relaxed);
+
+		std::free(header);
+	}
+
+	void* allocate_or_throw(std::size_t size)
+	{
+		void* block = allocate(size);
+		if (block == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		return block;
+	}
+}
+
+// The replacements of the global allocation functions. The aligned versions aren't replaced, since nothing in the generator overaligns its types.
+
+void* operator new(std::size_t size)
+{
+	return allocate_or_throw(size);
+}
+
+void* operator new[](std::size_t size)
+{
+	return allocate_or_throw(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+
+void operator delete(void* block) noexcept
+{
+	deallocate(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+	deallocate(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+	deallocate(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept
+{
+	deallocate(block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept
+{
+	deallocate(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept
+{
+	deallocate(block);
+}
+
+allocation_tracker::scoped_phase::scoped_phase(phase p, int wave)
+	: active(true), previous_phase(current_phase), previous_wave(current_wave), starts_wave(wave != 0),
+	start_allocations(thread_allocations), start_bytes(thread_bytes), previous_peak(thread_peak)
+{
+	current_phase = p;
+	if (starts_wave)
+	{
+		current_wave = wave;
+		thread_peak = live_bytes.load(std::memory_order_relaxed);
+	}
+}
+
+allocation_tracker::scoped_phase::~scoped_phase()
+{
+	stop();
+}
+
+void allocation_tracker::scoped_phase::stop()
+{
+	if (!active)
+	{
+		return;
+	}
+	active = false;
+	current_phase = previous_phase;
+
+	if (starts_wave)
+	{
+		// Take the counts before recording them, since recording them can allocate.
+		const std::uint64_t allocations = thread_allocations - start_allocations;
+		const std::uint64_t bytes = thread_bytes - start_bytes;
+		const std::int64_t peak = thread_peak;
+		{
+			std::lock_guard<std::mutex> lock(waves_mutex);
+			// New entries of the map are value initialized to zero.
+			wave_counters& w = get_waves()[current_wave];
+			++w.generations;
+			w.allocations += allocations;
+			w.bytes += bytes;
+			w.peak_live_bytes = std::max(w.peak_live_bytes, peak);
+		}
+		current_wave = previous_wave;
+		thread_peak = std::max(previous_peak, peak);
+	}
+}
+
+allocation_tracker::scoped_tag::scoped_tag(subsystem s)
+	: previous_subsystem(current_subsystem)
+{
+	current_subsystem = s;
+}
+
+allocation_tracker::scoped_tag::~scoped_tag()
+{
+	current_subsystem = previous_subsystem;
+}
+
+bool allocation_tracker::is_enabled()
+{
+	return true;
+}
+
+void allocation_tracker::write_report(const std::string& filename)
+{
+	nlohmann::json report;
+	report["live_bytes"] = live_bytes.load();
+	report["peak_live_bytes"] = peak_live_bytes.load();
+
+	std::uint64_t total_allocations = 0;
+	std::uint64_t total_bytes = 0;
+	nlohmann::json phases = nlohmann::json::object();
+	for (std::size_t i = 0; i < phase_count; ++i)
+	{
+		std::uint64_t allocations = 0;
+		std::uint64_t frees = 0;
+		std::uint64_t bytes = 0;
+		nlohmann::json subsystems = nlohmann::json::object();
+		for (std::size_t j = 0; j < subsystem_count; ++j)
+		{
+			const counters& c = phase_counters[i][j];
+			if (c.allocations == 0 && c.frees == 0)
+			{
+				continue;
+			}
+			nlohmann::json node;
+			node["allocations"] = c.allocations.load();
+			node["frees"] = c.frees.load();
+			node["bytes"] = c.bytes.load();
+			subsystems[get_subsystem_name(static_cast<subsystem>(j))] = node;
+			allocations += c.allocations;
+			frees += c.frees;
+			bytes += c.bytes;
+		}
+		if (allocations == 0 && frees == 0)
+		{
+			continue;
+		}
+
+		nlohmann::json node;
+		node["allocations"] = allocations;
+		node["frees"] = frees;
+		node["bytes"] = bytes;
+		node["peak_live_bytes"] = phase_peaks[i].load();
+		node["subsystems"] = subsystems;
+		phases[get_phase_name(static_cast<phase>(i))] = node;
+		total_allocations += allocations;
+		total_bytes += bytes;
+	}
+	report["allocations"] = total_allocations;
+	report["bytes"] = total_bytes;
+	report["phases"] = phases;
+
+	nlohmann::json subsystems = nlohmann::json::object();
+	for (std::size_t j = 0; j < subsystem_count; ++j)
+	{
+		std::uint64_t allocations = 0;
+		std::uint64_t bytes = 0;
+		for (std::size_t i = 0; i < phase_count; ++i)
+		{
+			allocations += phase_counters[i][j].allocations;
+			bytes += phase_counters[i][j].bytes;
+		}
+		nlohmann::json node;
+		node["allocations"] = allocations;
+		node["bytes"] = bytes;
+		node["live_bytes"] = subsystem_live_bytes[j].load();
+		node["peak_live_bytes"] = subsystem_peaks[j].load();
+		subsystems[get_subsystem_name(static_cast<subsystem>(j))] = node;
+	}
+	report["subsystems"] = subsystems;
+
+	nlohmann::json waves = nlohmann::json::array();
+	{
+		std::lock_guard<std::mutex> lock(waves_mutex);
+		for (const auto& wave : get_waves())
+		{
+			nlohmann::json node;
+			node["number"] = wave.first;
+			node["generations"] = wave.second.generations;
+			node["allocations"] = wave.second.allocations;
+			node["bytes"] = wave.second.bytes;
+			node["peak_live_bytes"] = wave.second.peak_live_bytes;
+			waves.push_back(node);
+		}
+	}
+	report["waves"] = waves;
+
+	std::ofstream file(filename);
+	if (!file)
+	{
+		const std::string exstr = "allocation_tracker::write_report exception: Couldn't write the allocation report to \"" + filename + "\".";
+		throw std::exception(exstr.c_str());
+	}
+	file << report.dump(1) << std::endl;
+}
+
+#else
+
+bool allocation_tracker::is_enabled()
+{
+	return false;
+}
+
+void allocation_tracker::write_report(const std::string&)
+{
+	throw std::exception("allocation_tracker::write_report exception: This build doesn't track allocations. Build it with ALLOCATION_TRACKING set to 1.");
+}
+
+#endif
+
+const char* allocation_tracker::get_phase_name(phase p)
+{
+	switch (p)
+	{
+	case phase::other:
+		return "other";
+	case phase::load:
+		return "load";
+	case phase::wave:
+		return "wave";
+	case phase::writing:
+		return "writing";
+	default:
+		return "unknown";
+	}
+}
+
+const char* allocation_tracker::get_subsystem_name(subsystem s)
+{
+	switch (s)
+	{
+	case subsystem::untagged:
+		return "untagged";
+	case subsystem::tfbot_attributes:
+		return "tfbot_attributes";
+	case subsystem::weapons:
+		return "weapons";
+	case subsystem::list_reader:
+		return "list_reader";
+	case subsystem::writer_strings:
+		return "writer_strings";
+	default:
+		return "unknown";
+	}
+}
\ No newline at end of file
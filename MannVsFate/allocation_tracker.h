@@ -0,0 +1,123 @@
+// An instrumented build mode that counts every heap allocation.
+// With ALLOCATION_TRACKING set to 1, the global operator new and delete are replaced with versions that count the allocations, bytes and live bytes
+// of each phase of generating a mission, each wave and each tagged subsystem. With it set to 0, the phases and tags compile to nothing.
+
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+// Set this to 1 here or in the project's preprocessor definitions to build with allocation tracking.
+#ifndef ALLOCATION_TRACKING
+#define ALLOCATION_TRACKING 0
+#endif
+
+#include <cstdint>
+#include <string>
+
+class allocation_tracker
+{
+public:
+	// The phases that allocations are counted in. Phases can be nested, in which case allocations count towards the innermost one.
+	enum class phase
+	{
+		// Anything outside of the other phases, such as reading the arguments.
+		other,
+		// Loading the data and setting up the generators.
+		load,
+		// Generating one wave, apart from writing it.
+		wave,
+		// Writing the popfile, its waves and its Missions.
+		writing,
+		// The number of phases.
+		count
+	};
+
+	// The subsystems that allocations can be tagged with. Tags can be nested, in which case allocations are tagged with the innermost one.
+	enum class subsystem
+	{
+		// Allocations outside of any tag.
+		untagged,
+		// The attribute sets and maps of TFBots, and everything else that generating a bot builds.
+		tfbot_attributes,
+		// Reading the weapons and choosing and randomizing bots' weapons.
+		weapons,
+		// Reading lists with list_reader.
+		list_reader,
+		// The strings and streams of the popfile writer.
+		writer_strings,
+		// The number of subsystems.
+		count
+	};
+
+	// Counts the calling thread's allocations towards a phase from construction to destruction.
+	class scoped_phase
+	{
+	public:
+#if ALLOCATION_TRACKING
+		// Constructor. The phase's allocations are also counted towards a wave, unless the wave is 0, in which case the thread's current wave is kept.
+		explicit scoped_phase(phase p, int wave = 0);
+		// Destructor. Goes back to the previous phase, unless the phase has been stopped.
+		~scoped_phase();
+
+		// Go back to the previous phase now instead of on destruction.
+		void stop();
+#else
+		explicit scoped_phase(phase, int = 0) {}
+		void stop() {}
+#endif
+
+		scoped_phase(const scoped_phase&) = delete;
+		scoped_phase& operator=(const scoped_phase&) = delete;
+
+#if ALLOCATION_TRACKING
+	private:
+		// Whether the phase is still being counted.
+		bool active;
+		// The phase that the thread was in before.
+		phase previous_phase;
+		// The wave that the thread was generating before.
+		int previous_wave;
+		// Whether this phase started a wave.
+		bool starts_wave;
+		// The thread's allocation and byte counts when the phase started.
+		std::uint64_t start_allocations;
+		std::uint64_t start_bytes;
+		// The most live bytes that the thread had seen before the phase started.
+		std::int64_t previous_peak;
+#endif
+	};
+
+	// Tags the calling thread's allocations with a subsystem from construction to destruction.
+	class scoped_tag
+	{
+	public:
+#if ALLOCATION_TRACKING
+		// Constructor.
+		explicit scoped_tag(subsystem s);
+		// Destructor. Goes back to the previous tag.
+		~scoped_tag();
+#else
+		explicit scoped_tag(subsystem) {}
+#endif
+
+		scoped_tag(const scoped_tag&) = delete;
+		scoped_tag& operator=(const scoped_tag&) = delete;
+
+#if ALLOCATION_TRACKING
+	private:
+		// The tag that the thread had before.
+		subsystem previous_subsystem;
+#endif
+	};
+
+	// Whether this build tracks allocations.
+	static bool is_enabled();
+
+	// Write the counts as JSON. Throws if the file can't be written or this build doesn't track allocations.
+	static void write_report(const std::string& filename);
+
+	// Get the name of a phase or a subsystem as it appears in the report.
+	static const char* get_phase_name(phase p);
+	static const char* get_subsystem_name(subsystem s);
+};
+
+#endif
\ No newline at end of file
@@ -2,7 +2,12 @@
 #include "rand_util.h"
 #include "pressure_manager.h"
 #include "cosmetics_generator.h"
+#include "generator_data.h"
+#include "profiler.h"
+#include "allocation_tracker.h"
+#include "event_counters.h"
 #include <algorithm>
+#include <array>
 
 // Set to 0 to disable debug messages for the bot generator.
 #define BOT_GENERATOR_DEBUG 0
@@ -11,37 +16,64 @@
 #include <iostream>
 #endif
 
-bot_generator::bot_generator(const pressure_manager& pm, cosmetics_generator& cosgen)
+namespace
+{
+	// The skill levels a bot can have, in increasing order of difficulty.
+	constexpr std::array<const char*, 4> skills{ "Easy", "Normal", "Hard", "Expert" };
+
+	// The projectile types that any projectile weapon can be overridden to fire.
+	constexpr std::array<int, 4> projectile_types{
+		1, // Bullet
+		2, // Rocket
+		5, // Syringe
+		6, // Flare
+	};
+
+	// The projectile types that weapons with arc fire can be overridden to fire.
+	constexpr std::array<int, 15> arc_projectile_types{
+		1, // Bullet
+		2, // Rocket
+		5, // Syringe
+		6, // Flare
+		3, // Pipebomb
+		8, // Huntsman Arrow
+		11, // Crusader's Crossbow Bolt
+		12, // Cow Mangler 5000 Projectile
+		13, // Righteous Bison Projectile
+		18, // Rescue Ranger Arrow
+		19, // Festive Huntsman Arrow
+		22, // Festive Jarate
+		23, // Festive Crusader's Crossbow Bolt
+		24, // Self Aware Beauty Mark
+		25, // Mutated Milk
+		//26, // Grappling Hook
+	};
+}
+
+bot_generator::bot_generator(const pressure_manager& pm, generator_data& data)
 	: wave_pressure(pm),
-	cosmetics(cosgen),
-	random_names("data/names/verbs.txt", "data/names/titles.txt", "data/names/adjectives.txt", "data/names/nouns.txt"),
+	cosmetics(data.get_cosmetics()),
+	loadouts(data.get_loadouts()),
+	random_names(data.get_random_names()),
 	giant_chance(0.1f),
 	boss_chance(0.15f),
 	giant_chance_increase(0.05f),
 	boss_chance_increase(0.01f),
 	engies_enabled(true),
 	generating_doombot(false),
-	possible_classes{ player_class::scout,
-	player_class::soldier,
-	player_class::pyro,
-	player_class::demoman,
-	player_class::heavyweapons,
-	player_class::engineer,
-	player_class::medic,
-	player_class::sniper,
-	player_class::spy },
 	give_bots_cosmetics(false),
 	fire_chance(0.025f),
 	bleed_chance(0.2f),
 	nonbosses_can_get_bleed(false),
+	bot_scale_chance(0.15f),
 	minimum_bot_scale(0.6f),
 	maximum_bot_scale(1.75f),
 	minimum_giant_scale(1.25f),
-	bot_scale_chance(0.15f),
-	force_bot_scale(-1.0f)
+	force_bot_scale(-1.0f),
+	bots_generated(0)
 {}
 
-void bot_generator::set_possible_classes(const std::vector<player_class>& classes)
+void bot_generator::set_possible_classes(const class_table& classes)
 {
 	possible_classes = classes;
 }
@@ -51,11 +83,21 @@ void bot_generator::set_giant_chance(float in)
 	giant_chance = in;
 }
 
+float bot_generator::get_giant_chance() const
+{
+	return giant_chance;
+}
+
 void bot_generator::set_boss_chance(float in)
 {
 	boss_chance = in;
 }
 
+float bot_generator::get_boss_chance() const
+{
+	return boss_chance;
+}
+
 void bot_generator::set_giant_chance_increase(float in)
 {
 	giant_chance_increase = in;
@@ -141,8 +183,20 @@ void bot_generator::set_force_bot_scale(float in)
 	force_bot_scale = in;
 }
 
+void bot_generator::compile_tables()
+{
+	if (give_bots_cosmetics)
+	{
+		cosmetics.compile_tables(possible_classes);
+	}
+}
+
 tfbot_meta bot_generator::generate_bot()
 {
+	const profiler::scoped_timer timer(profiler::phase::bot_generation);
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::tfbot_attributes);
+	++bots_generated;
+
 #if BOT_GENERATOR_DEBUG
 	std::cout << "Started generating new TFBot." << std::endl;
 #endif
@@ -157,35 +211,13 @@ tfbot_meta bot_generator::generate_bot()
 
 	const float decay_rate_per_player = wave_pressure.get_pressure_decay_rate_per_player();
 
-	// If engineers are disabled, remove them from the possible classes vector.
-	if (!engies_enabled)
-	{
-		possible_classes.erase(std::remove(possible_classes.begin(), possible_classes.end(), player_class::engineer), possible_classes.end());
-	}
-
-	// Make sure that doombots cannot be spies.
-	bool has_removed_spy = false;
-	if (bot_meta.is_doom)
-	{
-		if (std::find(possible_classes.begin(), possible_classes.end(), player_class::spy) != possible_classes.end())
-		{
-			possible_classes.erase(std::remove(possible_classes.begin(), possible_classes.end(), player_class::spy), possible_classes.end());
-			has_removed_spy = true;
-		}
-	}
-
 	// Give the bot a random name!
 	bot.name = random_names.get_random_name();
 	// Randomize the bot's class.
-	//std::cout << "Number of possible classes: " << possible_classes.size() << std::endl;
-	bot.cl = possible_classes.at(rand_int(0, possible_classes.size()));
+	// Engineers are left out on maps that don't support them, and doombots cannot be spies.
+	bot.cl = possible_classes.get_random(engies_enabled, bot_meta.is_doom);
 	player_class item_class = bot.cl;
 
-	if (has_removed_spy)
-	{
-		possible_classes.emplace_back(player_class::spy);
-	}
-
 #if BOT_GENERATOR_DEBUG
 	std::cout << "Chose bot class." << std::endl;
 #endif
@@ -208,22 +240,10 @@ tfbot_meta bot_generator::generate_bot()
 
 	// Get the bot's class icon.
 	bot_meta.set_base_class_icon(get_class_icon(bot.cl));
-	const std::string item_class_icon = get_class_icon(item_class);
 
 	// Give the bot items!
-	const std::string initial_path = "data/items/" + item_class_icon + '/';
-	//const std::string initial_path_bot = "data/items/" + bot.class_icon + '/';
-
-	const std::string file_secondary = initial_path + "secondary.txt";
-	const std::string file_melee = initial_path + "melee.txt";
-	//item_reader.load(file_secondary);
-	//item_reader.load(file_melee);
-	const std::string secondary_name = item_reader.get_random(file_secondary);
-	const std::string melee_name = item_reader.get_random(file_melee);
-	//bot.items.emplace_back(secondary);
-	//bot.items.emplace_back(melee);
-	weapon& secondary = bot_meta.add_weapon(secondary_name, weapon_reader);
-	weapon& melee = bot_meta.add_weapon(melee_name, weapon_reader);
+	const weapon& secondary = bot_meta.add_weapon(loadouts.get_random(item_class, weapon::slot::secondary));
+	const weapon& melee = bot_meta.add_weapon(loadouts.get_random(item_class, weapon::slot::melee));
 
 #if BOT_GENERATOR_DEBUG
 	std::cout << "Loaded and added secondary and melee weapons." << std::endl;
@@ -241,11 +261,7 @@ tfbot_meta bot_generator::generate_bot()
 		// pda2 = Cloaks
 		// building = Sappers
 
-		const std::string file_pda2 = initial_path + "pda2.txt";
-		//item_reader.load(file_pda2);
-		const std::string pda2_name = item_reader.get_random(file_pda2);
-		//bot.items.emplace_back(pda2);
-		weapon& pda2 = bot_meta.add_weapon(pda2_name, weapon_reader);
+		bot_meta.add_weapon(loadouts.get_random(item_class, weapon::slot::pda2));
 
 		// Changing a Spy's sapper makes them incapable of sapping for some reason.
 		// At this point in time, sapper swaps are disabled.
@@ -265,11 +281,7 @@ tfbot_meta bot_generator::generate_bot()
 	{
 		// Spies do not have primary weapons.
 
-		const std::string file_primary = initial_path + "primary.txt";
-		//item_reader.load(file_primary);
-		const std::string primary_name = item_reader.get_random(file_primary);
-		//bot.items.emplace_back(primary);
-		weapon& primary = bot_meta.add_weapon(primary_name, weapon_reader);
+		const weapon& primary = bot_meta.add_weapon(loadouts.get_random(item_class, weapon::slot::primary));
 
 		randomize_weapon(primary, bot_meta);
 
@@ -283,48 +295,20 @@ tfbot_meta bot_generator::generate_bot()
 
 			if (rand_chance(0.3f))
 			{
-				std::vector<weapon_restrictions> restrictions;
+				// Only restrict the bot to weapons that it can actually switch to.
+				// Bit n of the mask is set if weapon_restrictions value n is a candidate.
+				unsigned int restrictions = weapon_restriction_flag(weapon_restrictions::melee);
 
 				// Spies do not have primary weapons.
-				if (bot.cl != player_class::spy)
+				if (bot.cl != player_class::spy && primary.can_be_switched_to)
 				{
-					restrictions.emplace_back(weapon_restrictions::primary);
+					restrictions |= weapon_restriction_flag(weapon_restrictions::primary);
 				}
-				restrictions.emplace_back(weapon_restrictions::secondary);
-				restrictions.emplace_back(weapon_restrictions::melee);
-				bot.weapon_restriction = restrictions.at(rand_int(0, restrictions.size()));
-
-				if (bot.weapon_restriction == weapon_restrictions::secondary)
+				if (secondary.can_be_switched_to)
 				{
-					if (!secondary.can_be_switched_to)
-					{
-						// Choose a weapon restriction that's NOT SecondaryOnly.
-						restrictions.erase(std::remove(restrictions.begin(), restrictions.end(),
-							weapon_restrictions::secondary), restrictions.end());
-						bot.weapon_restriction = restrictions.at(rand_int(0, restrictions.size()));
-					}
-				}
-				if (bot.weapon_restriction == weapon_restrictions::primary)
-				{
-					if (!primary.can_be_switched_to)
-					{
-						// Choose a weapon restriction that's NOT SecondaryOnly.
-						restrictions.erase(std::remove(restrictions.begin(), restrictions.end(),
-							weapon_restrictions::primary), restrictions.end());
-						bot.weapon_restriction = restrictions.at(rand_int(0, restrictions.size()));
-					}
-					// Check secondary again in case primary was hit first.
-					if (bot.weapon_restriction == weapon_restrictions::secondary)
-					{
-						if (!secondary.can_be_switched_to)
-						{
-							// Choose a weapon restriction that's NOT SecondaryOnly.
-							restrictions.erase(std::remove(restrictions.begin(), restrictions.end(),
-								weapon_restrictions::secondary), restrictions.end());
-							bot.weapon_restriction = restrictions.at(rand_int(0, restrictions.size()));
-						}
-					}
+					restrictions |= weapon_restriction_flag(weapon_restrictions::secondary);
 				}
+				bot.weapon_restriction = static_cast<weapon_restrictions>(rand_set_bit(restrictions));
 			}
 
 #if BOT_GENERATOR_DEBUG
@@ -798,6 +782,10 @@ tfbot_meta bot_generator::generate_bot()
 			{
 				bot_meta.set_base_class_icon("spy_slow");
 			}
+			break;
+
+		default:
+			break;
 		}
 	}
 
@@ -869,7 +857,7 @@ tfbot_meta bot_generator::generate_bot()
 
 				if (rand_chance(0.5f))
 				{
-					bot_meta.add_weapon("The B.A.S.E. Jumper", weapon_reader);
+					bot_meta.add_weapon(loadouts.get_base_jumper(bot.cl));
 
 					// If necessary, make the bot jump more often. Otherwise, it will take FOREVER to get out of spawn.
 					if (bot.auto_jump_min < 1.0f)
@@ -905,7 +893,6 @@ tfbot_meta bot_generator::generate_bot()
 			bot_meta.pressure *= 1.2f;
 		}
 	}
-	bool instant_reload = false;
 	if (rand_chance(0.1f * chance_mult) || (bot.cl == player_class::engineer && rand_chance(0.8f)))
 	{
 		float fire_rate_bonus = rand_float(0.1f, 2.0f);
@@ -934,6 +921,9 @@ tfbot_meta bot_generator::generate_bot()
 					bot_meta.set_base_class_icon("sniper_bow_multi");
 				}
 				break;
+
+			default:
+				break;
 			}
 		}
 	}
@@ -966,6 +956,9 @@ tfbot_meta bot_generator::generate_bot()
 						bot_meta.set_base_class_icon("sniper_bow_multi");
 					}
 					break;
+
+				default:
+					break;
 				}
 			}
 		}
@@ -982,7 +975,6 @@ tfbot_meta bot_generator::generate_bot()
 			if (will_get_instant_reload)
 			{
 				bot.character_attributes["faster reload rate"] = -1;
-				instant_reload = true;
 
 				if (will_be_overlord_heavy_or_sniper)
 				{
@@ -1025,6 +1017,9 @@ tfbot_meta bot_generator::generate_bot()
 						bot_meta.set_base_class_icon("sniper_bow_multi");
 					}
 					break;
+
+				default:
+					break;
 				}
 			}
 		}
@@ -1112,7 +1107,6 @@ tfbot_meta bot_generator::generate_bot()
 	}
 
 	// Set a random skill level for the bot.
-	std::vector<std::string> skills({ "Easy", "Normal", "Hard", "Expert" });
 	int skill_index = rand_int(0, skills.size());
 	bot.skill = skills.at(skill_index);
 	float skill_pressure = (skill_index * 0.5f) + 1.0f; // skill_index * 0.5f
@@ -1216,6 +1210,11 @@ tfbot_meta bot_generator::generate_bot()
 	return bot_meta;
 }
 
+unsigned int bot_generator::get_bots_generated() const
+{
+	return bots_generated;
+}
+
 void bot_generator::check_bot_scale(tfbot_meta& bot_meta)
 {
 	tfbot& bot = bot_meta.get_bot();
@@ -1264,6 +1263,7 @@ void bot_generator::make_bot_into_giant_pure(tfbot_meta& bot_meta)
 
 void bot_generator::make_bot_into_giant(tfbot_meta& bot_meta)
 {
+	event_counters::add(event_counters::counter::giant_conversions);
 	tfbot& bot = bot_meta.get_bot();
 
 	// Being a giant multiplies the TFBot's health by 15.
@@ -1337,8 +1337,9 @@ void bot_generator::wave_ended()
 	boss_chance += boss_chance_increase;
 }
 
-void bot_generator::randomize_weapon(weapon& wep, tfbot_meta& bot_meta)
+void bot_generator::randomize_weapon(const weapon& wep, tfbot_meta& bot_meta)
 {
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::weapons);
 	tfbot& bot = bot_meta.get_bot();
 
 #if BOT_GENERATOR_DEBUG
@@ -1455,36 +1456,10 @@ void bot_generator::randomize_weapon(weapon& wep, tfbot_meta& bot_meta)
 		{
 			if (rand_chance(0.2f * chance_mult))
 			{
-				//int proj_type; // = rand_int(1, 27);
-
-				std::vector<int> possibilities{
-					1, // Bullet
-					2, // Rocket
-					5, // Syringe
-					6, // Flare
-				};
-
-				if (wep.arc_fire)
-				{
-					// Some projectiles require arcs to fire properly.
-
-					possibilities.emplace_back(3); // Pipebomb
-					possibilities.emplace_back(8); // Huntsman Arrow
-					possibilities.emplace_back(11); // Crusader's Crossbow Bolt
-					possibilities.emplace_back(12); // Cow Mangler 5000 Projectile
-					possibilities.emplace_back(13); // Righteous Bison Projectile
-					possibilities.emplace_back(18); // Rescue Ranger Arrow
-					possibilities.emplace_back(19); // Festive Huntsman Arrow
-					possibilities.emplace_back(22); // Festive Jarate
-					possibilities.emplace_back(23); // Festive Crusader's Crossbow Bolt
-					possibilities.emplace_back(24); // Self Aware Beauty Mark
-					possibilities.emplace_back(25); // Mutated Milk
-				}
-
-				//possibilities.emplace_back(26); // Grappling Hook
-
-				int proj_type = possibilities.at(rand_int(0, possibilities.size()));;
-				item_attributes["override projectile type"] = proj_type;
+				// Some projectiles require arcs to fire properly, so they're only available to arc fire weapons.
+				const int proj_type = wep.arc_fire
+					? arc_projectile_types.at(rand_int(0, arc_projectile_types.size()))
+					: projectile_types.at(rand_int(0, projectile_types.size()));
 
 				/*
 				// Fix invalid values.
@@ -1533,12 +1508,7 @@ void bot_generator::randomize_weapon(weapon& wep, tfbot_meta& bot_meta)
 	{
 		if ((rand_chance(0.5f * chance_mult) || wep.is_a("tf_weapon_jar")))
 		{
-			float lower_range = 0.0001f;
 			float upper_range = 2.0f;
-			if (wep.is_a("Bonk! Atomic Punch"))
-			{
-				lower_range = 0.2f;
-			}
 			if (wep.is_a("tf_weapon_jar"))
 			{
 				upper_range = 0.12f;
@@ -1555,13 +1525,17 @@ void bot_generator::randomize_weapon(weapon& wep, tfbot_meta& bot_meta)
 		}
 	}
 
+	// The weapon is shared with every other bot that drew it, so track the buffs given to this bot's copy locally.
+	bool burns = wep.burns;
+	bool bleeds = wep.bleeds;
+
 	if (bot_meta.is_boss || nonbosses_can_get_bleed)
 	{
-		if (!wep.burns && rand_chance(bleed_chance * chance_mult)) // 0.01f
+		if (!burns && rand_chance(bleed_chance * chance_mult)) // 0.01f
 		{
 			// Enable bleeding.
 			item_attributes["bleeding duration"] = 5.0f;
-			wep.bleeds = true;
+			bleeds = true;
 
 			// Knife particles.
 			item_attributes["attach particle effect static"] = 43;
@@ -1583,11 +1557,11 @@ void bot_generator::randomize_weapon(weapon& wep, tfbot_meta& bot_meta)
 		}
 	}
 
-	if (!wep.bleeds && rand_chance(fire_chance * chance_mult))
+	if (!bleeds && rand_chance(fire_chance * chance_mult))
 	{
 		// Enable burning.
 		item_attributes["Set DamageType Ignite"] = 1;
-		wep.burns = true;
+		burns = true;
 
 		// Add some cool fire particles.
 		item_attributes["attach particle effect static"] = 13;
@@ -1654,7 +1628,7 @@ void bot_generator::randomize_weapon(weapon& wep, tfbot_meta& bot_meta)
 		}
 	}
 
-	if (!wep.burns && !wep.bleeds)
+	if (!burns && !bleeds)
 	{
 		if (rand_chance(0.03f * chance_mult))
 		{
@@ -6,21 +6,25 @@
 #include "random_name_generator.h"
 #include "tfbot.h"
 #include "tfbot_meta.h"
-#include "json_reader_weapon.h"
+#include "loadout_table.h"
+#include "class_table.h"
 
 class pressure_manager;
 class cosmetics_generator;
+class generator_data;
 
 class bot_generator
 {
 public:
-	// Constructor.
-	bot_generator(const pressure_manager& pm, cosmetics_generator& cosgen);
+	// Constructor. The weapons, names and cosmetics are borrowed from the generator data.
+	bot_generator(const pressure_manager& pm, generator_data& data);
 
 	// Accessors.
-	void set_possible_classes(const std::vector<player_class>& classes);
+	void set_possible_classes(const class_table& classes);
 	void set_giant_chance(float in);
+	float get_giant_chance() const;
 	void set_boss_chance(float in);
+	float get_boss_chance() const;
 	void set_giant_chance_increase(float in);
 	void set_boss_chance_increase(float in);
 	void set_engies_enabled(bool in);
@@ -41,6 +45,8 @@ public:
 
 	// Generate a random TFBot.
 	tfbot_meta generate_bot();
+	// Get how many TFBots have been generated in total.
+	unsigned int get_bots_generated() const;
 
 	// Perform a sanity check on the bot's scale.
 	void check_bot_scale(tfbot_meta& bot_meta);
@@ -55,7 +61,10 @@ public:
 	void wave_ended();
 
 	// Add a bunch of weapon-specific attributes to a weapon.
-	void randomize_weapon(weapon& wep, tfbot_meta& bot_meta);
+	void randomize_weapon(const weapon& wep, tfbot_meta& bot_meta);
+
+	// Build the tables that depend on the current settings, loading any lists that they need.
+	void compile_tables();
 
 	// Returns a muted pressure per player and mutes it more as the players gain more currency.
 	float get_muted_damage_pressure(const float base) const;
@@ -64,15 +73,12 @@ private:
 	// Injected dependencies.
 	const pressure_manager& wave_pressure;
 	cosmetics_generator& cosmetics;
-
-	// The weapon JSON reader is contained by this class so it only has to read the JSON data once.
-	json_reader_weapon weapon_reader;
-	// The item reader.
-	list_reader item_reader;
+	// Every class' weapons, resolved from the item lists once at startup.
+	const loadout_table& loadouts;
 	// The random name generator.
-	random_name_generator random_names;
+	const random_name_generator& random_names;
 	// The possible classes that the bot generator can choose from.
-	std::vector<player_class> possible_classes;
+	class_table possible_classes;
 	// The multiplier on most random chance calls. A higher value here means more of the random chances will likely return true.
 	float chance_mult;
 	// The chance that a standard robot will end up being a giant.
@@ -111,6 +117,8 @@ private:
 	float minimum_giant_scale;
 	// If not negative, forces ALL bots to be this scale.
 	float force_bot_scale;
+	// How many TFBots have been generated in total.
+	unsigned int bots_generated;
 };
 
 #endif
\ No newline at end of file
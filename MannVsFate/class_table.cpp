@@ -0,0 +1,54 @@
+#include "class_table.h"
+#include "rand_util.h"
+#include <string>
+
+class_table::class_table(const int flags)
+	: flags(flags)
+{
+	const int engineer = player_class_flag(player_class::engineer);
+	const int spy = player_class_flag(player_class::spy);
+
+	tables.at(0) = compile(flags, 0);
+	tables.at(1) = compile(flags, engineer);
+	tables.at(2) = compile(flags, spy);
+	tables.at(3) = compile(flags, engineer | spy);
+
+	if (tables.at(0).count == 0)
+	{
+		throw std::exception("class_table exception: No classes are enabled!");
+	}
+}
+
+class_table::table class_table::compile(const int flags, const int excluded_flags)
+{
+	table result;
+	for (int i = 0; i < player_class_count; ++i)
+	{
+		const player_class cl = static_cast<player_class>(i);
+		const int flag = player_class_flag(cl);
+		if ((flags & flag) && !(excluded_flags & flag))
+		{
+			result.classes.at(result.count) = cl;
+			++result.count;
+		}
+	}
+	return result;
+}
+
+player_class class_table::get_random(const bool engies_enabled, const bool doombot) const
+{
+	const int context = (doombot ? 2 : 0) + (engies_enabled ? 0 : 1);
+	const table& t = tables.at(context);
+	if (t.count == 0)
+	{
+		const std::string exstr = "class_table::get_random exception: No classes are available for this "
+			+ std::string(doombot ? "doombot" : "robot") + " (class bitfield " + std::to_string(flags) + ")!";
+		throw std::exception(exstr.c_str());
+	}
+	return t.classes.at(rand_int(0, t.count));
+}
+
+bool class_table::contains(const player_class cl) const
+{
+	return (flags & player_class_flag(cl)) != 0;
+}
\ No newline at end of file
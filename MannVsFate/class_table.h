@@ -0,0 +1,43 @@
+// Immutable tables of the classes that robots can be, compiled from a class bitfield.
+
+#ifndef CLASS_TABLE_H
+#define CLASS_TABLE_H
+
+#include "player_class.h"
+#include <array>
+
+class class_table
+{
+public:
+	// The bitfield containing every class.
+	static constexpr int all_classes = (1 << player_class_count) - 1;
+
+	// Constructor. Bit n of flags enables the class with index n (1 = scout, 2 = soldier, ..., 256 = spy).
+	explicit class_table(const int flags = all_classes);
+
+	// Get a random class for the given context.
+	// engies_enabled is false on maps that don't support enemy engineers.
+	// Doombots can never be spies.
+	player_class get_random(const bool engies_enabled, const bool doombot) const;
+
+	// Returns true if the class is enabled in the bitfield.
+	bool contains(const player_class cl) const;
+
+private:
+	// A fixed-capacity list of classes.
+	struct table
+	{
+		std::array<player_class, player_class_count> classes;
+		int count = 0;
+	};
+
+	// Compile a table containing every class in flags except for the excluded ones.
+	static table compile(const int flags, const int excluded_flags);
+
+	// The bitfield this table was compiled from.
+	int flags;
+	// The tables for each context, indexed by (doombot ? 2 : 0) + (engies_enabled ? 0 : 1).
+	std::array<table, 4> tables;
+};
+
+#endif // CLASS_TABLE_H
\ No newline at end of file
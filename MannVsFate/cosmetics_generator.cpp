@@ -2,55 +2,101 @@
 #include "tfbot.h"
 #include "rand_util.h"
 #include "player_class.h"
+#include <algorithm>
 
 const std::string cosmetics_generator::root_path = "data/items/";
 
 cosmetics_generator::cosmetics_generator(std::vector<item_category> categories)
 	: categories(categories),
 	cosmetic_chance(0.8f)
-{}
+{
+	// Work out which files each class draws each category from ahead of time.
+	for (int i = 0; i < player_class_count; ++i)
+	{
+		const player_class cl = static_cast<player_class>(i);
+		std::vector<std::vector<std::string>>& sources_by_category = class_sources.at(i);
+		sources_by_category.resize(categories.size());
 
-void cosmetics_generator::add_cosmetic(std::string file_name, const std::vector<player_class> non_root_classes, bool has_root_file)
+		for (unsigned int j = 0; j < categories.size(); ++j)
+		{
+			const item_category& cat = categories.at(j);
+			std::vector<std::string>& sources = sources_by_category.at(j);
+			if (cat.is_for_all_classes)
+			{
+				// Use the root file as a source.
+				sources.emplace_back(root_path + cat.category_name + ".txt");
+			}
+			// Whether the class matches any of the non-root classes.
+			if (std::find(cat.specific_classes.begin(), cat.specific_classes.end(), cl) != cat.specific_classes.end())
+			{
+				// Use the class-specific file as a source.
+				sources.emplace_back(root_path + get_class_icon(cl) + '/' + cat.category_name + ".txt");
+			}
+		}
+	}
+}
+
+void cosmetics_generator::compile_tables(const class_table& classes)
 {
-	if (rand_chance(cosmetic_chance))
+	const std::lock_guard<std::mutex> lock(compile_mutex);
+
+	// Load the lists of every table that's about to be built together, so that they're read concurrently.
+	std::vector<std::string> preloads;
+	for (int i = 0; i < player_class_count; ++i)
 	{
-		std::vector<std::string> sources;
-		if (has_root_file)
+		if (class_tables.at(i).compiled || !classes.contains(static_cast<player_class>(i)))
 		{
-			// Use the root file as a source.
-			sources.emplace_back(root_path + file_name + ".txt");
+			continue;
 		}
-		// Whether the bot's class matches any of the non-root classes.
-		bool bot_matches = false;
-		for (unsigned int i = 0; i < non_root_classes.size(); ++i)
+		for (const std::vector<std::string>& sources : class_sources.at(i))
 		{
-			if (non_root_classes.at(i) == bot->cl)
-			{
-				bot_matches = true;
-				break;
-			}
+			preloads.insert(preloads.end(), sources.begin(), sources.end());
 		}
-		if (bot_matches)
+	}
+	item_reader.preload(preloads);
+
+	for (int i = 0; i < player_class_count; ++i)
+	{
+		class_table_entry& entry = class_tables.at(i);
+		if (entry.compiled || !classes.contains(static_cast<player_class>(i)))
 		{
-			// Use the class-specific file as a source.
-			sources.emplace_back(root_path + get_class_icon(bot->cl) + '/' + file_name + ".txt");
+			continue;
 		}
-		if (!sources.empty())
+
+		for (const std::vector<std::string>& sources : class_sources.at(i))
 		{
-			const std::string item_name = item_reader.get_random(sources);
-			bot->items.emplace(item_name);
+			cosmetic_pool pool;
+			for (const std::string& source : sources)
+			{
+				const std::vector<std::string_view>& items = item_reader.get_list(source);
+				pool.insert(pool.end(), items.begin(), items.end());
+			}
+			// Categories that the class has no items in are left out, so they cost nothing per bot.
+			if (!pool.empty())
+			{
+				entry.pools.emplace_back(std::move(pool));
+			}
 		}
+		entry.compiled = true;
 	}
 }
 
-void cosmetics_generator::add_cosmetics(tfbot* bot)
+void cosmetics_generator::add_cosmetics(tfbot* bot) const
 {
-	this->bot = bot;
+	const class_table_entry& entry = class_tables.at(static_cast<int>(bot->cl));
+	if (!entry.compiled)
+	{
+		const std::string exstr = "cosmetics_generator::add_cosmetics exception: The cosmetic table for " + player_class_to_string(bot->cl) + " wasn't compiled.";
+		throw std::exception(exstr.c_str());
+	}
 
-	for (unsigned int i = 0; i < categories.size(); ++i)
+	// Every category has the same chance of giving the bot a cosmetic, drawn evenly from the category's pool.
+	for (const cosmetic_pool& pool : entry.pools)
 	{
-		item_category& cat = categories.at(i);
-		add_cosmetic(cat.category_name, cat.specific_classes, cat.is_for_all_classes);
+		if (rand_chance(cosmetic_chance))
+		{
+			bot->items.emplace(pool[rand_int(0, pool.size())]);
+		}
 	}
 
 	/*
@@ -3,29 +3,47 @@
 
 #include "list_reader.h"
 #include "item_category.h"
+#include "class_table.h"
+#include <array>
+#include <mutex>
 
 class tfbot;
 
 // Generates cosmetics for a bot.
+// The cosmetic pools are shared by every mission generated at once, so the tables are compiled under a lock and only read afterwards.
 class cosmetics_generator
 {
 public:
 	cosmetics_generator(std::vector<item_category> categories);
 	// Add cosmetics (hats etc) to a robot.
-	void add_cosmetics(tfbot* bot);
+	void add_cosmetics(tfbot* bot) const;
+	// Build the cosmetic tables of the given classes that haven't been built yet, loading every list they draw from at once.
+	// Cosmetics can only be added to bots of these classes.
+	void compile_tables(const class_table& classes);
 
 private:
-	// Potentially adds a single cosmetic to a robot, depending on random chance.
-	// file_name is the single name of the files that will be read for cosmetics.
-	// The files will have the same name, but may be located in different folders.
-	// non_root_classes are the classes beyond the root folder that are viable for this cosmetic.
-	// has_root_file is whether or not a cosmetics file exists in the root directory for any class to draw from.
-	void add_cosmetic(std::string file_name, const std::vector<player_class> non_root_classes, bool has_root_file = false);
+	// Every item that a class can wear from one category, merged from the shared list and the class' own list.
+	// The items point into the item reader's lists.
+	typedef std::vector<std::string_view> cosmetic_pool;
+
+	// The cosmetic pools of a class.
+	struct class_table_entry
+	{
+		// One pool per category that the class has items in.
+		std::vector<cosmetic_pool> pools;
+		// Whether the pools have been built.
+		bool compiled = false;
+	};
 
 	// A collection of the categories of cosmetics.
 	std::vector<item_category> categories;
-	// The bot that is receiving the cosmetics.
-	tfbot* bot;
+	// The files to draw each category's cosmetics from, indexed by class and then by category.
+	// A category that a class can't use has no files.
+	std::array<std::vector<std::vector<std::string>>, player_class_count> class_sources;
+	// The cosmetic pools of each class.
+	std::array<class_table_entry, player_class_count> class_tables;
+	// Guards compiling the cosmetic tables.
+	std::mutex compile_mutex;
 	// The item reader to use for each cosmetic file.
 	list_reader item_reader;
 	// The chance that any given cosmetic will be added.
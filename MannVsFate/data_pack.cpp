@@ -0,0 +1,792 @@
+#include "data_pack.h"
+#include "json_reader_item_category.h"
+#include "json_reader_map.h"
+#include "json_reader_weapon.h"
+#include "list_reader.h"
+#include "loadout_table.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+// Set to 1 to print debug messages while compiling the pack.
+#define DATA_PACK_DEBUG 0
+
+#if DATA_PACK_DEBUG == 1
+#include <iostream>
+#endif
+
+// The pack is an 8-byte magic string, followed by a body of 32-bit words in native byte order, followed by the string data.
+// Strings are stored once each in the string data and referenced from the body as an offset and a length.
+// Lists and maps are indexed with perfect hash tables, so a lookup is two hashes and one string comparison.
+
+namespace
+{
+	constexpr char magic[8] = { 'M', 'V', 'F', 'P', 'A', 'C', 'K', '\0' };
+
+	// The header words at the start of the body. Most of them point to the word where a section starts.
+	enum header : std::uint32_t
+	{
+		w_format_version,
+		w_string_data_offset,
+		w_string_data_size,
+		w_source_count,
+		w_sources,
+		w_list_count,
+		w_lists,
+		w_list_index,
+		w_phrases,
+		w_weapon_count,
+		w_weapons,
+		w_weapon_names,
+		w_pools,
+		w_base_jumpers,
+		w_map_count,
+		w_maps,
+		w_map_index,
+		w_map_strings,
+		w_category_count,
+		w_categories,
+		header_words
+	};
+
+	// The sizes of each record, in words.
+	constexpr std::uint32_t string_ref_words = 2;
+	constexpr std::uint32_t source_words = string_ref_words + 4;
+	constexpr std::uint32_t list_words = string_ref_words + 2;
+	constexpr std::uint32_t weapon_words = 4;
+	constexpr std::uint32_t pool_words = 2;
+	constexpr std::uint32_t map_words = string_ref_words * 3 + 5 + 2 * 5;
+	constexpr std::uint32_t category_words = string_ref_words + 2;
+
+	// The order of the weapon flags in a weapon record.
+	enum weapon_flag : std::uint32_t
+	{
+		has_projectiles = 1 << 0,
+		arc_fire = 1 << 1,
+		can_be_switched_to = 1 << 2,
+		does_damage = 1 << 3,
+		bots_too_dumb_to_use = 1 << 4,
+		can_be_charged = 1 << 5,
+		burns = 1 << 6,
+		explodes = 1 << 7,
+		bleeds = 1 << 8,
+		has_effect_charge_bar = 1 << 9,
+		projectile_override_crash_risk = 1 << 10
+	};
+
+	// Normalize a file name for lookups, since Windows file names are case-insensitive.
+	std::string normalize_key(std::string_view key)
+	{
+		std::string result(key);
+		for (char& c : result)
+		{
+			c = c == '\\' ? '/' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+		}
+		return result;
+	}
+
+	// Hash a key with a seed. The seed picks one function out of a family of hash functions.
+	// This is FNV-1a with a finalizer, so that neighbouring seeds give unrelated slots.
+	std::uint32_t hash(std::string_view key, std::uint32_t seed)
+	{
+		std::uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+		for (const char c : key)
+		{
+			h ^= static_cast<unsigned char>(c);
+			h *= 16777619u;
+		}
+		h ^= h >> 16;
+		h *= 0x85ebca6bu;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35u;
+		h ^= h >> 16;
+		return h;
+	}
+
+	// Build a perfect hash index for a set of distinct keys using hash and displace.
+	// Keys are grouped into buckets, then each bucket, biggest first, searches for a seed that sends all of its keys to free slots.
+	// Returns the index words (the bucket count followed by each bucket's seed) and fills in the slot of each key.
+	std::vector<std::uint32_t> build_index(const std::vector<std::string>& keys, std::vector<std::uint32_t>& slots)
+	{
+		const std::uint32_t key_count = static_cast<std::uint32_t>(keys.size());
+		const std::uint32_t bucket_count = key_count / 2 + 1;
+
+		std::vector<std::vector<std::uint32_t>> buckets(bucket_count);
+		for (std::uint32_t i = 0; i < key_count; ++i)
+		{
+			buckets.at(hash(keys.at(i), 0) % bucket_count).emplace_back(i);
+		}
+
+		std::vector<std::uint32_t> order(bucket_count);
+		for (std::uint32_t i = 0; i < bucket_count; ++i)
+		{
+			order.at(i) = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [&buckets](std::uint32_t a, std::uint32_t b)
+		{
+			return buckets.at(a).size() > buckets.at(b).size();
+		});
+
+		std::vector<std::uint32_t> index(bucket_count + 1, 0);
+		index.at(0) = bucket_count;
+		slots.assign(key_count, 0);
+		std::vector<bool> taken(key_count, false);
+		std::vector<std::uint32_t> candidate;
+
+		for (const std::uint32_t b : order)
+		{
+			const std::vector<std::uint32_t>& bucket = buckets.at(b);
+			if (bucket.empty())
+			{
+				break;
+			}
+
+			for (std::uint32_t seed = 1;; ++seed)
+			{
+				if (seed == 0x100000)
+				{
+					throw std::exception("data_pack exception: Couldn't build a perfect hash index.");
+				}
+
+				candidate.clear();
+				bool fits = true;
+				for (const std::uint32_t key : bucket)
+				{
+					const std::uint32_t slot = hash(keys.at(key), seed) % key_count;
+					if (taken.at(slot) || std::find(candidate.begin(), candidate.end(), slot) != candidate.end())
+					{
+						fits = false;
+						break;
+					}
+					candidate.emplace_back(slot);
+				}
+
+				if (fits)
+				{
+					for (std::size_t i = 0; i < bucket.size(); ++i)
+					{
+						taken.at(candidate.at(i)) = true;
+						slots.at(bucket.at(i)) = candidate.at(i);
+					}
+					index.at(b + 1) = seed;
+					break;
+				}
+			}
+		}
+
+		return index;
+	}
+
+	// Lays out the body and the string data of a pack.
+	class pack_builder
+	{
+	public:
+		pack_builder()
+			: body(header_words, 0)
+		{}
+
+		// The index of the next word to be pushed.
+		std::uint32_t here() const
+		{
+			return static_cast<std::uint32_t>(body.size());
+		}
+
+		void set(const std::uint32_t index, const std::uint32_t value)
+		{
+			body.at(index) = value;
+		}
+
+		void push(const std::uint32_t value)
+		{
+			body.emplace_back(value);
+		}
+
+		void push_float(const float value)
+		{
+			std::uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			push(bits);
+		}
+
+		void push_u64(const std::uint64_t value)
+		{
+			push(static_cast<std::uint32_t>(value));
+			push(static_cast<std::uint32_t>(value >> 32));
+		}
+
+		// Push a reference to a string, storing the string's characters only if they haven't been stored yet.
+		void push_string(std::string_view str)
+		{
+			auto itr = interned.find(std::string(str));
+			if (itr == interned.end())
+			{
+				itr = interned.emplace(std::string(str), static_cast<std::uint32_t>(string_data.size())).first;
+				string_data.append(str);
+			}
+			push(itr->second);
+			push(static_cast<std::uint32_t>(str.size()));
+		}
+
+		void write(const std::string& filename)
+		{
+			set(w_string_data_offset, static_cast<std::uint32_t>(sizeof(magic) + body.size() * sizeof(std::uint32_t)));
+			set(w_string_data_size, static_cast<std::uint32_t>(string_data.size()));
+
+			std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+			if (!file)
+			{
+				const std::string exstr = "data_pack exception: Couldn't write pack file \"" + filename + "\".";
+				throw std::exception(exstr.c_str());
+			}
+			file.write(magic, sizeof(magic));
+			file.write(reinterpret_cast<const char*>(body.data()), body.size() * sizeof(std::uint32_t));
+			file.write(string_data.data(), string_data.size());
+		}
+
+	private:
+		std::vector<std::uint32_t> body;
+		std::string string_data;
+		// The offset of each string that has been stored in the string data.
+		std::unordered_map<std::string, std::uint32_t> interned;
+	};
+}
+
+const std::string data_pack::default_filename = "data/mvf.pack";
+
+const data_pack* data_pack::active = nullptr;
+
+void data_pack::compile(const std::string& pack_filename)
+{
+	pack_builder builder;
+	builder.set(w_format_version, format_version);
+
+	const std::vector<source_file> sources = find_sources(pack_filename);
+
+	builder.set(w_source_count, static_cast<std::uint32_t>(sources.size()));
+	builder.set(w_sources, builder.here());
+	for (const source_file& source : sources)
+	{
+		builder.push_string(source.path);
+		builder.push_u64(source.size);
+		builder.push_u64(static_cast<std::uint64_t>(source.modified));
+	}
+
+	// Every text file in the data directory is a list.
+	list_reader reader;
+	std::vector<std::string> list_keys;
+	std::vector<const std::vector<std::string_view>*> list_phrases;
+	for (const source_file& source : sources)
+	{
+		if (std::filesystem::path(source.path).extension() == ".txt")
+		{
+			list_keys.emplace_back(normalize_key(source.path));
+			list_phrases.emplace_back(&reader.get_list(source.path));
+		}
+	}
+
+	std::vector<std::uint32_t> list_slots;
+	const std::vector<std::uint32_t> list_index = build_index(list_keys, list_slots);
+	std::vector<std::uint32_t> list_by_slot(list_keys.size());
+	for (std::size_t i = 0; i < list_keys.size(); ++i)
+	{
+		list_by_slot.at(list_slots.at(i)) = static_cast<std::uint32_t>(i);
+	}
+
+	builder.set(w_list_count, static_cast<std::uint32_t>(list_keys.size()));
+	builder.set(w_lists, builder.here());
+	std::uint32_t phrase_count = 0;
+	for (const std::uint32_t i : list_by_slot)
+	{
+		builder.push_string(list_keys.at(i));
+		builder.push(phrase_count);
+		builder.push(static_cast<std::uint32_t>(list_phrases.at(i)->size()));
+		phrase_count += static_cast<std::uint32_t>(list_phrases.at(i)->size());
+	}
+
+	builder.set(w_list_index, builder.here());
+	for (const std::uint32_t w : list_index)
+	{
+		builder.push(w);
+	}
+
+	builder.set(w_phrases, builder.here());
+	for (const std::uint32_t i : list_by_slot)
+	{
+		for (const std::string_view phrase : *list_phrases.at(i))
+		{
+			builder.push_string(phrase);
+		}
+	}
+
+	// Resolve every class' weapons, then store each pool as a run of weapon records.
+	const json_reader_weapon weapon_reader;
+	const loadout_table loadouts(weapon_reader, reader);
+
+	std::vector<const weapon*> weapons;
+	std::vector<std::uint32_t> pools;
+	for (int i = 0; i < player_class_count; ++i)
+	{
+		for (int j = 0; j < loadout_table::slot_count; ++j)
+		{
+			const std::vector<weapon>& pool = loadouts.get_pool(static_cast<player_class>(i), static_cast<weapon::slot>(j));
+			pools.emplace_back(static_cast<std::uint32_t>(weapons.size()));
+			pools.emplace_back(static_cast<std::uint32_t>(pool.size()));
+			for (const weapon& wep : pool)
+			{
+				weapons.emplace_back(&wep);
+			}
+		}
+	}
+	std::vector<std::uint32_t> base_jumpers;
+	for (int i = 0; i < player_class_count; ++i)
+	{
+		base_jumpers.emplace_back(static_cast<std::uint32_t>(weapons.size()));
+		weapons.emplace_back(&loadouts.get_base_jumper(static_cast<player_class>(i)));
+	}
+
+	builder.set(w_weapon_count, static_cast<std::uint32_t>(weapons.size()));
+	builder.set(w_weapons, builder.here());
+	std::uint32_t weapon_name_count = 0;
+	for (const weapon* wep : weapons)
+	{
+		std::uint32_t flags = 0;
+		const auto set_flag = [&flags](bool set, weapon_flag flag)
+		{
+			if (set)
+			{
+				flags |= flag;
+			}
+		};
+		set_flag(wep->has_projectiles, has_projectiles);
+		set_flag(wep->arc_fire, arc_fire);
+		set_flag(wep->can_be_switched_to, can_be_switched_to);
+		set_flag(wep->does_damage, does_damage);
+		set_flag(wep->bots_too_dumb_to_use, bots_too_dumb_to_use);
+		set_flag(wep->can_be_charged, can_be_charged);
+		set_flag(wep->burns, burns);
+		set_flag(wep->explodes, explodes);
+		set_flag(wep->bleeds, bleeds);
+		set_flag(wep->has_effect_charge_bar, has_effect_charge_bar);
+		set_flag(wep->projectile_override_crash_risk, projectile_override_crash_risk);
+
+		builder.push(weapon_name_count);
+		builder.push(static_cast<std::uint32_t>(wep->names.size()));
+		builder.push(static_cast<std::uint32_t>(wep->type));
+		builder.push(flags);
+		weapon_name_count += static_cast<std::uint32_t>(wep->names.size());
+	}
+
+	builder.set(w_weapon_names, builder.here());
+	for (const weapon* wep : weapons)
+	{
+		for (const std::string& name : wep->names)
+		{
+			builder.push_string(name);
+		}
+	}
+
+	builder.set(w_pools, builder.here());
+	for (const std::uint32_t w : pools)
+	{
+		builder.push(w);
+	}
+
+	builder.set(w_base_jumpers, builder.here());
+	for (const std::uint32_t w : base_jumpers)
+	{
+		builder.push(w);
+	}
+
+	// Resolve every map profile.
+	const json_reader_map map_reader;
+	const std::vector<std::string> map_names = map_reader.get_map_names();
+	std::vector<map_profile> profiles;
+	for (const std::string& map_name : map_names)
+	{
+		profiles.emplace_back(map_reader.read(map_name));
+	}
+
+	std::vector<std::uint32_t> map_slots;
+	const std::vector<std::uint32_t> map_index = build_index(map_names, map_slots);
+	std::vector<std::uint32_t> map_by_slot(map_names.size());
+	for (std::size_t i = 0; i < map_names.size(); ++i)
+	{
+		map_by_slot.at(map_slots.at(i)) = static_cast<std::uint32_t>(i);
+	}
+
+	builder.set(w_map_count, static_cast<std::uint32_t>(map_names.size()));
+	builder.set(w_maps, builder.here());
+	std::vector<const std::vector<std::string>*> map_strings;
+	std::uint32_t map_string_count = 0;
+	for (const std::uint32_t i : map_by_slot)
+	{
+		const map_profile& profile = profiles.at(i);
+		builder.push_string(map_names.at(i));
+		builder.push_float(profile.bot_path_length);
+		builder.push_float(profile.scale_mega);
+		builder.push_float(profile.scale_doom);
+		builder.push(profile.engies ? 1 : 0);
+		builder.push_float(profile.max_tank_speed);
+		builder.push_string(profile.wave_start_relay);
+		builder.push_string(profile.wave_finished_relay);
+		for (const std::vector<std::string>* strings : { &profile.spawnbots, &profile.spawnbots_giant,
+			&profile.spawnbots_mega, &profile.spawnbots_doom, &profile.tank_path_starting_points })
+		{
+			builder.push(map_string_count);
+			builder.push(static_cast<std::uint32_t>(strings->size()));
+			map_string_count += static_cast<std::uint32_t>(strings->size());
+			map_strings.emplace_back(strings);
+		}
+	}
+
+	builder.set(w_map_index, builder.here());
+	for (const std::uint32_t w : map_index)
+	{
+		builder.push(w);
+	}
+
+	builder.set(w_map_strings, builder.here());
+	for (const std::vector<std::string>* strings : map_strings)
+	{
+		for (const std::string& str : *strings)
+		{
+			builder.push_string(str);
+		}
+	}
+
+	// Store each cosmetic category's classes as a class bitfield.
+	const json_reader_item_category category_reader;
+	const std::vector<item_category> categories = category_reader.read();
+
+	builder.set(w_category_count, static_cast<std::uint32_t>(categories.size()));
+	builder.set(w_categories, builder.here());
+	for (const item_category& cat : categories)
+	{
+		std::uint32_t class_flags = 0;
+		for (const player_class cl : cat.specific_classes)
+		{
+			class_flags |= player_class_flag(cl);
+		}
+		builder.push_string(cat.category_name);
+		builder.push(cat.is_for_all_classes ? 1 : 0);
+		builder.push(class_flags);
+	}
+
+#if DATA_PACK_DEBUG == 1
+	std::cout << "Packed " << sources.size() << " sources, " << list_keys.size() << " lists, "
+		<< weapons.size() << " weapons, " << map_names.size() << " maps and " << categories.size() << " cosmetic categories." << std::endl;
+#endif
+
+	builder.write(pack_filename);
+}
+
+std::unique_ptr<data_pack> data_pack::open(const std::string& pack_filename)
+{
+	std::error_code ec;
+	if (!std::filesystem::is_regular_file(pack_filename, ec))
+	{
+		return nullptr;
+	}
+	return std::make_unique<data_pack>(pack_filename);
+}
+
+data_pack::data_pack(const std::string& pack_filename)
+	: filename(pack_filename), file(pack_filename), contents(file.view()), word_count(header_words)
+{
+	if (contents.size() < sizeof(magic) + header_words * sizeof(std::uint32_t) ||
+		std::memcmp(contents.data(), magic, sizeof(magic)) != 0)
+	{
+		const std::string exstr = "data_pack exception: \"" + pack_filename + "\" isn't a data pack.";
+		throw std::exception(exstr.c_str());
+	}
+
+	const std::uint32_t string_data_offset = word(w_string_data_offset);
+	const std::uint32_t string_data_size = word(w_string_data_size);
+	if (string_data_offset < sizeof(magic) + header_words * sizeof(std::uint32_t) ||
+		static_cast<std::uint64_t>(string_data_offset) + string_data_size != contents.size())
+	{
+		const std::string exstr = "data_pack exception: \"" + pack_filename + "\" is truncated.";
+		throw std::exception(exstr.c_str());
+	}
+	word_count = static_cast<std::uint32_t>((string_data_offset - sizeof(magic)) / sizeof(std::uint32_t));
+}
+
+bool data_pack::is_stale() const
+{
+	if (word(w_format_version) != format_version)
+	{
+		return true;
+	}
+
+	const std::vector<source_file> sources = find_sources(filename);
+	if (sources.size() != word(w_source_count))
+	{
+		return true;
+	}
+
+	std::uint32_t w = word(w_sources);
+	for (const source_file& source : sources)
+	{
+		const std::uint64_t size = word(w + 2) | static_cast<std::uint64_t>(word(w + 3)) << 32;
+		const std::uint64_t modified = word(w + 4) | static_cast<std::uint64_t>(word(w + 5)) << 32;
+		if (string_at(w) != source.path || size != source.size || modified != static_cast<std::uint64_t>(source.modified))
+		{
+			return true;
+		}
+		w += source_words;
+	}
+
+	return false;
+}
+
+bool data_pack::find_list(const std::string& source_filename, std::vector<std::string_view>& phrases) const
+{
+	const std::string key = normalize_key(source_filename);
+	std::uint32_t slot;
+	if (!find_slot(word(w_list_index), word(w_list_count), key, slot))
+	{
+		return false;
+	}
+
+	const std::uint32_t w = word(w_lists) + slot * list_words;
+	if (string_at(w) != key)
+	{
+		return false;
+	}
+
+	const std::uint32_t first = word(w + 2);
+	const std::uint32_t count = word(w + 3);
+	const std::uint32_t phrases_word = word(w_phrases);
+	phrases.clear();
+	phrases.reserve(count);
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		phrases.emplace_back(string_at(phrases_word + (first + i) * string_ref_words));
+	}
+	return true;
+}
+
+bool data_pack::find_map(const std::string& map_name, map_profile& profile) const
+{
+	std::uint32_t slot;
+	if (!find_slot(word(w_map_index), word(w_map_count), map_name, slot))
+	{
+		return false;
+	}
+
+	std::uint32_t w = word(w_maps) + slot * map_words;
+	if (string_at(w) != map_name)
+	{
+		return false;
+	}
+	w += string_ref_words;
+
+	const auto read_float = [this](std::uint32_t index)
+	{
+		const std::uint32_t bits = word(index);
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	};
+
+	profile.bot_path_length = read_float(w);
+	profile.scale_mega = read_float(w + 1);
+	profile.scale_doom = read_float(w + 2);
+	profile.engies = word(w + 3) != 0;
+	profile.max_tank_speed = read_float(w + 4);
+	w += 5;
+	profile.wave_start_relay = std::string(string_at(w));
+	profile.wave_finished_relay = std::string(string_at(w + string_ref_words));
+	w += string_ref_words * 2;
+	profile.spawnbots = map_strings_at(w);
+	profile.spawnbots_giant = map_strings_at(w + 2);
+	profile.spawnbots_mega = map_strings_at(w + 4);
+	profile.spawnbots_doom = map_strings_at(w + 6);
+	profile.tank_path_starting_points = map_strings_at(w + 8);
+	return true;
+}
+
+std::vector<weapon> data_pack::get_pool(const player_class cl, const weapon::slot s) const
+{
+	const std::uint32_t w = word(w_pools) + (static_cast<std::uint32_t>(cl) * loadout_table::slot_count + static_cast<std::uint32_t>(s)) * pool_words;
+	const std::uint32_t first = word(w);
+	const std::uint32_t count = word(w + 1);
+
+	std::vector<weapon> pool;
+	pool.reserve(count);
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		pool.emplace_back(weapon_at(first + i));
+	}
+	return pool;
+}
+
+weapon data_pack::get_base_jumper(const player_class cl) const
+{
+	return weapon_at(word(word(w_base_jumpers) + static_cast<std::uint32_t>(cl)));
+}
+
+std::vector<item_category> data_pack::get_item_categories() const
+{
+	const std::uint32_t count = word(w_category_count);
+	std::uint32_t w = word(w_categories);
+
+	std::vector<item_category> categories(count);
+	for (item_category& cat : categories)
+	{
+		cat.category_name = std::string(string_at(w));
+		cat.is_for_all_classes = word(w + 2) != 0;
+		const std::uint32_t class_flags = word(w + 3);
+		for (int i = 0; i < player_class_count; ++i)
+		{
+			if (class_flags & player_class_flag(static_cast<player_class>(i)))
+			{
+				cat.specific_classes.emplace_back(static_cast<player_class>(i));
+			}
+		}
+		w += category_words;
+	}
+	return categories;
+}
+
+std::uint64_t data_pack::get_data_fingerprint()
+{
+	// 64-bit FNV-1a.
+	std::uint64_t h = 14695981039346656037ull;
+	const auto mix = [&h](const void* data, std::size_t length)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (std::size_t i = 0; i < length; ++i)
+		{
+			h ^= bytes[i];
+			h *= 1099511628211ull;
+		}
+	};
+
+	for (const source_file& source : find_sources(default_filename))
+	{
+		mix(source.path.data(), source.path.size() + 1);
+		mix(&source.size, sizeof(source.size));
+		mix(&source.modified, sizeof(source.modified));
+	}
+	return h;
+}
+
+const data_pack* data_pack::get_active()
+{
+	return active;
+}
+
+void data_pack::set_active(const data_pack* pack)
+{
+	active = pack;
+}
+
+std::vector<data_pack::source_file> data_pack::find_sources(const std::string& pack_filename)
+{
+	const std::string pack_key = normalize_key(pack_filename);
+	std::vector<source_file> sources;
+
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator("data"))
+	{
+		if (!entry.is_regular_file())
+		{
+			continue;
+		}
+		std::string path = entry.path().generic_string();
+		if (normalize_key(path) == pack_key)
+		{
+			continue;
+		}
+		sources.push_back({ std::move(path), entry.file_size(),
+			static_cast<std::int64_t>(entry.last_write_time().time_since_epoch().count()) });
+	}
+
+	std::sort(sources.begin(), sources.end(), [](const source_file& a, const source_file& b)
+	{
+		return a.path < b.path;
+	});
+	return sources;
+}
+
+bool data_pack::find_slot(std::uint32_t index_word, std::uint32_t key_count, std::string_view key, std::uint32_t& slot) const
+{
+	if (key_count == 0)
+	{
+		return false;
+	}
+	const std::uint32_t bucket_count = word(index_word);
+	const std::uint32_t seed = word(index_word + 1 + hash(key, 0) % bucket_count);
+	slot = hash(key, seed) % key_count;
+	return true;
+}
+
+std::uint32_t data_pack::word(std::uint32_t index) const
+{
+	if (index >= word_count)
+	{
+		throw std::exception("data_pack exception: Read past the end of the pack.");
+	}
+	std::uint32_t value;
+	std::memcpy(&value, contents.data() + sizeof(magic) + index * sizeof(std::uint32_t), sizeof(value));
+	return value;
+}
+
+std::string_view data_pack::string_at(std::uint32_t index) const
+{
+	const std::uint32_t offset = word(index);
+	const std::uint32_t length = word(index + 1);
+	const std::uint32_t string_data_size = word(w_string_data_size);
+	if (offset > string_data_size || length > string_data_size - offset)
+	{
+		throw std::exception("data_pack exception: String reference is out of range.");
+	}
+	return contents.substr(word(w_string_data_offset) + offset, length);
+}
+
+std::vector<std::string> data_pack::map_strings_at(std::uint32_t index) const
+{
+	const std::uint32_t first = word(index);
+	const std::uint32_t count = word(index + 1);
+	const std::uint32_t strings_word = word(w_map_strings);
+
+	std::vector<std::string> strings;
+	strings.reserve(count);
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		strings.emplace_back(string_at(strings_word + (first + i) * string_ref_words));
+	}
+	return strings;
+}
+
+weapon data_pack::weapon_at(std::uint32_t weapon_index) const
+{
+	const std::uint32_t w = word(w_weapons) + weapon_index * weapon_words;
+	const std::uint32_t first_name = word(w);
+	const std::uint32_t name_count = word(w + 1);
+	const std::uint32_t flags = word(w + 3);
+	const std::uint32_t names_word = word(w_weapon_names);
+
+	weapon wep;
+	wep.names.reserve(name_count);
+	for (std::uint32_t i = 0; i < name_count; ++i)
+	{
+		wep.names.emplace_back(string_at(names_word + (first_name + i) * string_ref_words));
+	}
+	wep.type = static_cast<weapon::slot>(word(w + 2));
+	wep.has_projectiles = (flags & has_projectiles) != 0;
+	wep.arc_fire = (flags & arc_fire) != 0;
+	wep.can_be_switched_to = (flags & can_be_switched_to) != 0;
+	wep.does_damage = (flags & does_damage) != 0;
+	wep.bots_too_dumb_to_use = (flags & bots_too_dumb_to_use) != 0;
+	wep.can_be_charged = (flags & can_be_charged) != 0;
+	wep.burns = (flags & burns) != 0;
+	wep.explodes = (flags & explodes) != 0;
+	wep.bleeds = (flags & bleeds) != 0;
+	wep.has_effect_charge_bar = (flags & has_effect_charge_bar) != 0;
+	wep.projectile_override_crash_risk = (flags & projectile_override_crash_risk) != 0;
+	return wep;
+}
\ No newline at end of file
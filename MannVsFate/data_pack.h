@@ -0,0 +1,100 @@
+// A precompiled binary image of the data directory.
+// Compiling the pack resolves every weapon, list, map profile and cosmetic category ahead of time, so startup only has to map one file.
+// The pack records the size and modification time of every source file, and a pack that no longer matches the data directory is ignored.
+
+#ifndef DATA_PACK_H
+#define DATA_PACK_H
+
+#include "mapped_file.h"
+#include "map_profile.h"
+#include "weapon.h"
+#include "item_category.h"
+#include "player_class.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class data_pack
+{
+public:
+	// Bump this whenever the layout of the pack changes so that old packs are treated as stale.
+	static constexpr std::uint32_t format_version = 2;
+	// Where the pack lives relative to the working directory.
+	static const std::string default_filename;
+
+	// Compile the data directory into a pack file. Throws if any of the data can't be resolved.
+	static void compile(const std::string& pack_filename);
+
+	// Open a pack file. Returns nullptr if the file doesn't exist.
+	// Throws if the file exists but isn't a pack.
+	static std::unique_ptr<data_pack> open(const std::string& pack_filename);
+
+	// Constructor. Maps the pack file and validates its header.
+	explicit data_pack(const std::string& pack_filename);
+
+	// Returns true if the pack was compiled by a different version or the data directory has changed since.
+	bool is_stale() const;
+
+	// Look up a list by the name of its source file. Returns false if the pack doesn't contain it.
+	// The phrases point into the pack's mapping.
+	bool find_list(const std::string& source_filename, std::vector<std::string_view>& phrases) const;
+
+	// Look up a map profile by map name. Returns false if the pack doesn't contain it.
+	bool find_map(const std::string& map_name, map_profile& profile) const;
+
+	// Get every weapon a class can have in a certain slot.
+	std::vector<weapon> get_pool(const player_class cl, const weapon::slot s) const;
+
+	// Get The B.A.S.E. Jumper as resolved for a given class.
+	weapon get_base_jumper(const player_class cl) const;
+
+	// Get every cosmetic item category.
+	std::vector<item_category> get_item_categories() const;
+
+	// Get a hash of the sizes and modification times of every data file, which changes whenever the data does.
+	static std::uint64_t get_data_fingerprint();
+
+	// The pack that readers consult before falling back to the data files. nullptr if there is none.
+	static const data_pack* get_active();
+	static void set_active(const data_pack* pack);
+
+private:
+	// A data file that the pack was compiled from.
+	struct source_file
+	{
+		std::string path;
+		std::uint64_t size;
+		std::int64_t modified;
+	};
+
+	// Find every file in the data directory, sorted by path.
+	static std::vector<source_file> find_sources(const std::string& pack_filename);
+
+	// Find the slot of a key in a perfect hash index. Returns false if the key can't be in the index.
+	bool find_slot(std::uint32_t index_word, std::uint32_t key_count, std::string_view key, std::uint32_t& slot) const;
+
+	// Read a 32-bit word from the pack's body.
+	std::uint32_t word(std::uint32_t index) const;
+	// Read a string reference (an offset and a length) starting at a word of the pack's body.
+	std::string_view string_at(std::uint32_t index) const;
+	// Read a list of map strings stored as the index of its first string and a count.
+	std::vector<std::string> map_strings_at(std::uint32_t index) const;
+	// Read a weapon record.
+	weapon weapon_at(std::uint32_t weapon_index) const;
+
+	// The name of the pack file.
+	std::string filename;
+	// The mapped pack file.
+	mapped_file file;
+	// The contents of the pack file.
+	std::string_view contents;
+	// The number of 32-bit words in the pack's body.
+	std::uint32_t word_count;
+
+	// The active pack.
+	static const data_pack* active;
+};
+
+#endif // DATA_PACK_H
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "difficulty_calibrator.h"
+#include "popfile_generator.h"
+#include "rand_util.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+	// The range of difficulties to search.
+	constexpr float min_difficulty = 0.05f;
+	constexpr float max_difficulty = 50.0f;
+	// The search stops once the difficulties surrounding the target are within this ratio of each other.
+	constexpr float precision = 1.01f;
+	// Every difficulty is measured on the same seeds, so that the differences between measurements come from the difficulty rather than from luck.
+	constexpr unsigned int base_seed = 1;
+}
+
+difficulty_calibrator::difficulty_calibrator(generator_data& data, int argc, char** argv, unsigned int worker_count)
+	: data(data),
+	args(argv, argv + argc),
+	worker_count(std::max(1u, worker_count)),
+	type(target_type::health),
+	target(0.0f),
+	samples(8)
+{}
+
+void difficulty_calibrator::set_target(target_type type, float value)
+{
+	this->type = type;
+	target = value;
+}
+
+void difficulty_calibrator::set_samples(unsigned int in)
+{
+	samples = std::max(1u, in);
+}
+
+float difficulty_calibrator::calibrate()
+{
+	const char* const target_name = type == target_type::duration ? "wave duration" : "wave health";
+
+	// The search works on the logarithm of the difficulty, since the difficulty is a multiplier.
+	float low = std::log(min_difficulty);
+	float high = std::log(max_difficulty);
+	std::vector<float> ends = measure({ min_difficulty, max_difficulty });
+	float low_value = ends.at(0);
+	float high_value = ends.at(1);
+
+	std::cout << "The average " << target_name << " is " << low_value << " at difficulty " << min_difficulty
+		<< " and " << high_value << " at difficulty " << max_difficulty << '.' << std::endl;
+
+	if ((low_value - target) * (high_value - target) > 0.0f)
+	{
+		const std::string exstr = "difficulty_calibrator exception: No difficulty between " + std::to_string(min_difficulty) + " and "
+			+ std::to_string(max_difficulty) + " reaches an average " + target_name + " of " + std::to_string(target) + '.';
+		throw std::exception(exstr.c_str());
+	}
+
+	while (high - low > std::log(precision))
+	{
+		// Split the range into one more piece than there are workers, and measure the difficulties in between.
+		std::vector<float> points;
+		std::vector<float> difficulties;
+		for (unsigned int i = 1; i <= worker_count; ++i)
+		{
+			points.emplace_back(low + (high - low) * i / (worker_count + 1));
+			difficulties.emplace_back(std::exp(points.back()));
+		}
+		const std::vector<float> values = measure(difficulties);
+
+		// Keep the first piece whose ends surround the target.
+		float previous = low;
+		float previous_value = low_value;
+		for (unsigned int i = 0; i <= points.size(); ++i)
+		{
+			const float point = i < points.size() ? points.at(i) : high;
+			const float value = i < points.size() ? values.at(i) : high_value;
+			if ((previous_value - target) * (value - target) <= 0.0f)
+			{
+				low = previous;
+				low_value = previous_value;
+				high = point;
+				high_value = value;
+				break;
+			}
+			previous = point;
+			previous_value = value;
+		}
+
+		std::cout << "The difficulty is between " << std::exp(low) << " (" << low_value << ") and "
+			<< std::exp(high) << " (" << high_value << ")." << std::endl;
+	}
+
+	// Interpolate between the surrounding difficulties.
+	float fraction = 0.5f;
+	if (high_value != low_value)
+	{
+		fraction = (target - low_value) / (high_value - low_value);
+	}
+	const float difficulty = std::exp(low + (high - low) * fraction);
+
+	std::cout << "The calibrated difficulty for an average " << target_name << " of " << target << " is:" << std::endl;
+	std::cout << "-difficulty " << difficulty << std::endl;
+
+	return difficulty;
+}
+
+std::vector<float> difficulty_calibrator::measure(const std::vector<float>& difficulties) const
+{
+	// Every sample of every difficulty is a separate job, so that the workers stay busy however the jobs are split.
+	const std::size_t job_count = difficulties.size() * samples;
+	std::vector<double> totals(job_count, 0.0);
+	std::vector<std::size_t> wave_counts(job_count, 0);
+	std::atomic<std::size_t> next_job(0);
+	std::exception_ptr error;
+	std::mutex error_mutex;
+
+	const auto work = [&]()
+	{
+		for (std::size_t job = next_job++; job < job_count; job = next_job++)
+		{
+			try
+			{
+				std::vector<std::string> job_args = args;
+				job_args.emplace_back("-difficulty");
+				job_args.emplace_back(std::to_string(difficulties.at(job / samples)));
+				std::vector<char*> argv;
+				for (std::string& arg : job_args)
+				{
+					argv.emplace_back(&arg[0]);
+				}
+				argv.emplace_back(nullptr);
+
+				popfile_generator popgen(data);
+				popgen.apply_arguments(static_cast<int>(job_args.size()), argv.data());
+				rand_seed(base_seed + static_cast<unsigned int>(job % samples));
+
+				for (const wave_generator::wave_summary& summary : popgen.simulate())
+				{
+					totals.at(job) += type == target_type::duration ? summary.duration : summary.health;
+					++wave_counts.at(job);
+				}
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(error_mutex);
+				if (error == nullptr)
+				{
+					error = std::current_exception();
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < std::min<std::size_t>(worker_count, job_count); ++i)
+	{
+		threads.emplace_back(work);
+	}
+	work();
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	if (error != nullptr)
+	{
+		std::rethrow_exception(error);
+	}
+
+	std::vector<float> values;
+	for (std::size_t i = 0; i < difficulties.size(); ++i)
+	{
+		double total = 0.0;
+		std::size_t waves = 0;
+		for (std::size_t job = i * samples; job < (i + 1) * samples; ++job)
+		{
+			total += totals.at(job);
+			waves += wave_counts.at(job);
+		}
+		values.emplace_back(waves != 0 ? static_cast<float>(total / waves) : 0.0f);
+	}
+	return values;
+}
\ No newline at end of file
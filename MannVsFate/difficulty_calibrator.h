@@ -0,0 +1,56 @@
+// Finds the -difficulty that makes missions meet a target, by simulating missions instead of tuning it by hand.
+// The difficulty is searched for in the same way as bisection, except that each round measures as many difficulties as there are worker threads,
+// narrowing the search down to the pair of neighbouring difficulties whose measurements surround the target.
+
+#ifndef DIFFICULTY_CALIBRATOR_H
+#define DIFFICULTY_CALIBRATOR_H
+
+#include <string>
+#include <vector>
+
+class generator_data;
+
+class difficulty_calibrator
+{
+public:
+	// What to calibrate the difficulty for.
+	enum class target_type
+	{
+		// The average number of seconds that a wave lasts.
+		duration,
+		// The average total health of the robots and tanks in a wave.
+		health
+	};
+
+	// Constructor. The arguments configure the simulated missions the same way as when generating a mission.
+	// The data must outlive the calibrator.
+	difficulty_calibrator(generator_data& data, int argc, char** argv, unsigned int worker_count);
+
+	// Set what to calibrate the difficulty for.
+	void set_target(target_type type, float value);
+	// Set how many missions to simulate for each difficulty.
+	void set_samples(unsigned int in);
+
+	// Search for the difficulty that meets the target, printing the progress and the result.
+	// Returns the calibrated difficulty.
+	float calibrate();
+
+private:
+	// Measure several difficulties at once. Each measurement is the average over every wave of every sample mission.
+	std::vector<float> measure(const std::vector<float>& difficulties) const;
+
+	// The data that the generators only read, shared by every simulated mission.
+	generator_data& data;
+	// The arguments to configure each simulated mission with. The difficulty is appended to them.
+	std::vector<std::string> args;
+	// How many threads simulate missions at once.
+	unsigned int worker_count;
+	// What the difficulty is calibrated for.
+	target_type type;
+	// The value to calibrate the measurement to.
+	float target;
+	// How many missions are simulated for each difficulty.
+	unsigned int samples;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "event_counters.h"
+
+thread_local event_counters::values event_counters::thread_values = {};
+
+const event_counters::values& event_counters::get_thread_values()
+{
+	return thread_values;
+}
+
+std::uint64_t event_counters::get(const values& v, counter c)
+{
+	return v.at(static_cast<std::size_t>(c));
+}
+
+event_counters::values event_counters::difference(const values& later, const values& earlier)
+{
+	values result;
+	for (std::size_t i = 0; i < counter_count; ++i)
+	{
+		result.at(i) = later.at(i) - earlier.at(i);
+	}
+	return result;
+}
+
+void event_counters::accumulate(values& total, const values& v)
+{
+	for (std::size_t i = 0; i < counter_count; ++i)
+	{
+		total.at(i) += v.at(i);
+	}
+}
+
+const char* event_counters::get_counter_name(counter c)
+{
+	switch (c)
+	{
+	case counter::rand_draws:
+		return "rand_draws";
+	case counter::health_fitting_iterations:
+		return "health_fitting_iterations";
+	case counter::giant_conversions:
+		return "giant_conversions";
+	case counter::virtual_spawns_created:
+		return "virtual_spawns_created";
+	case counter::virtual_spawns_retired:
+		return "virtual_spawns_retired";
+	case counter::simulation_ticks:
+		return "simulation_ticks";
+	case counter::list_loads:
+		return "list_loads";
+	case counter::bytes_written:
+		return "bytes_written";
+	default:
+		return "unknown";
+	}
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+// Counters of the work done in the generator's hot loops, such as random draws and simulated seconds.
+// Each thread has its own counters, which only ever go up, so the work of a wave is the difference between the counters at its end and at its start.
+// Unlike the profiler's timers, the counters are always on, since counting is a single increment.
+
+#ifndef EVENT_COUNTERS_H
+#define EVENT_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+class event_counters
+{
+public:
+	// The events that are counted.
+	enum class counter
+	{
+		// Numbers drawn from the random number generator.
+		rand_draws,
+		// Times a TFBot's health and count were refitted to the time left in its WaveSpawn.
+		health_fitting_iterations,
+		// Calls to bot_generator::make_bot_into_giant.
+		giant_conversions,
+		// Virtual spawns added to the pressure simulation.
+		virtual_spawns_created,
+		// Virtual spawns that died and were removed from the pressure simulation.
+		virtual_spawns_retired,
+		// Seconds that the pressure simulation stepped through.
+		simulation_ticks,
+		// Lists read by list_reader.
+		list_loads,
+		// Bytes written by the popfile writer, whether to a file or only measured.
+		bytes_written,
+		// The number of counters.
+		count
+	};
+
+	// The number of counters.
+	static constexpr std::size_t counter_count = static_cast<std::size_t>(counter::count);
+
+	// A value for each counter.
+	typedef std::array<std::uint64_t, counter_count> values;
+
+	// Add to one of the calling thread's counters.
+	static void add(counter c, std::uint64_t n = 1)
+	{
+		thread_values[static_cast<std::size_t>(c)] += n;
+	}
+
+	// Get the calling thread's counters.
+	static const values& get_thread_values();
+
+	// Get the value of one counter.
+	static std::uint64_t get(const values& v, counter c);
+
+	// Get how much each counter went up from one reading to a later one.
+	static values difference(const values& later, const values& earlier);
+	// Add each counter of one set of values to another.
+	static void accumulate(values& total, const values& v);
+
+	// Get the name of a counter as it appears in the profile and the stats.
+	static const char* get_counter_name(counter c);
+
+private:
+	// The calling thread's counters.
+	static thread_local values thread_values;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "generator_data.h"
+#include "json_reader_weapon.h"
+#include "data_pack.h"
+#include "profiler.h"
+#include "allocation_tracker.h"
+
+namespace
+{
+	// Build the loadout table from the data pack if there is one, so that the weapons JSON doesn't need to be parsed.
+	loadout_table load_loadouts(list_reader& item_reader)
+	{
+		const profiler::scoped_timer timer(profiler::phase::weapon_data);
+		const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::weapons);
+		if (const data_pack* pack = data_pack::get_active())
+		{
+			return loadout_table(*pack);
+		}
+		const json_reader_weapon weapon_reader;
+		return loadout_table(weapon_reader, item_reader);
+	}
+}
+
+generator_data::generator_data(const std::vector<item_category>& categories)
+	: loadouts(load_loadouts(item_reader)),
+	random_names("data/names/verbs.txt", "data/names/titles.txt", "data/names/adjectives.txt", "data/names/nouns.txt"),
+	cosmetics(categories)
+{}
+
+const loadout_table& generator_data::get_loadouts() const
+{
+	return loadouts;
+}
+
+const random_name_generator& generator_data::get_random_names() const
+{
+	return random_names;
+}
+
+cosmetics_generator& generator_data::get_cosmetics()
+{
+	return cosmetics;
+}
+
+map_profile generator_data::get_map_profile(const std::string& map_name)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+
+	auto itr = map_profiles.find(map_name);
+	if (itr == map_profiles.end())
+	{
+		// Take the profile from the data pack if it has the map, since that saves parsing the maps JSON.
+		map_profile profile;
+		const data_pack* pack = data_pack::get_active();
+		if (pack == nullptr || !pack->find_map(map_name, profile))
+		{
+			if (map_reader == nullptr)
+			{
+				map_reader = std::make_unique<json_reader_map>();
+			}
+			profile = map_reader->read(map_name);
+		}
+		itr = map_profiles.emplace(map_name, profile).first;
+	}
+	return itr->second;
+}
+
+std::vector<const std::vector<std::string_view>*> generator_data::get_lists(const std::vector<std::string>& sources)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+
+	lists.preload(sources);
+	std::vector<const std::vector<std::string_view>*> result;
+	result.reserve(sources.size());
+	for (const std::string& source : sources)
+	{
+		result.emplace_back(&lists.get_list(source));
+	}
+	return result;
+}
\ No newline at end of file
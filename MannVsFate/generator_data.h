@@ -0,0 +1,67 @@
+// The data that generating a mission reads but never changes: every class' weapons, the name lists, the cosmetic pools, other lists and the map profiles.
+// It's loaded once and borrowed by the generators of every mission, so a process that generates many missions, like -serve, only reads and resolves it once.
+// The weapons and the name lists are loaded by the constructor, since every mission needs them.
+// Lists, cosmetic pools and map profiles are loaded the first time a mission asks for them, under a lock, so missions can be generated on several threads at once.
+
+#ifndef GENERATOR_DATA_H
+#define GENERATOR_DATA_H
+
+#include "item_category.h"
+#include "list_reader.h"
+#include "loadout_table.h"
+#include "random_name_generator.h"
+#include "cosmetics_generator.h"
+#include "json_reader_map.h"
+#include "map_profile.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class generator_data
+{
+public:
+	// Constructor. The cosmetic categories are taken as a parameter so that they only have to be read once.
+	explicit generator_data(const std::vector<item_category>& categories);
+
+	// The generators keep references into the data, so it stays where it was made.
+	generator_data(const generator_data&) = delete;
+	generator_data& operator=(const generator_data&) = delete;
+
+	// Get every class' weapons.
+	const loadout_table& get_loadouts() const;
+	// Get the random name generator.
+	const random_name_generator& get_random_names() const;
+	// Get the cosmetics generator, whose cosmetic pools are shared by every mission.
+	cosmetics_generator& get_cosmetics();
+
+	// Get the profile of a map. It's taken from the data pack if the pack has the map, and from the maps JSON otherwise.
+	// Throws if the map has no profile.
+	map_profile get_map_profile(const std::string& map_name);
+	// Get several lists, loading the ones that haven't been loaded yet at once.
+	// The lists stay valid for as long as the generator data does. Throws if any of the files can't be read.
+	std::vector<const std::vector<std::string_view>*> get_lists(const std::vector<std::string>& sources);
+
+private:
+	// The item reader that the weapon lists are read with, when there's no data pack.
+	list_reader item_reader;
+	// Every class' weapons.
+	loadout_table loadouts;
+	// The random name generator.
+	random_name_generator random_names;
+	// The cosmetics generator.
+	cosmetics_generator cosmetics;
+
+	// Guards the lists, the map profiles and the maps JSON.
+	std::mutex mutex;
+	// The lists that missions have asked for, such as the randomized sound lists.
+	list_reader lists;
+	// The profile of each map that a mission has been generated for.
+	std::map<std::string, map_profile> map_profiles;
+	// The maps JSON. nullptr until a map that the data pack doesn't have is asked for.
+	std::unique_ptr<json_reader_map> map_reader;
+};
+
+#endif
\ No newline at end of file
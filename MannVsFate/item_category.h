@@ -2,6 +2,7 @@
 #define ITEM_CATEGORY_H
 
 #include "player_class.h"
+#include <string>
 #include <vector>
 
 // A data structure that describes a category of TF2 item.
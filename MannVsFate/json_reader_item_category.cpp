@@ -1,4 +1,6 @@
 #include "json_reader_item_category.h"
+#include <algorithm>
+#include <cctype>
 #include <fstream>
 
 json_reader_item_category::json_reader_item_category()
@@ -23,11 +25,64 @@ json_reader_item_category::json_reader_item_category()
 	categories_file.close();
 }
 
-std::vector<item_category> json_reader_item_category::read()
+std::vector<item_category> json_reader_item_category::read() const
 {
 	std::vector<item_category> result;
 
-	// TODO: Iterate through each node of cosmetics.json.
+	// Each node maps a category name to the classes that have items in it.
+	// "All" means that the category has a list shared by every class.
+	for (auto itr = categories_json.begin(); itr != categories_json.end(); ++itr)
+	{
+		item_category cat;
+		cat.category_name = itr.key();
+
+		std::vector<std::string> class_names;
+		try
+		{
+			class_names = itr.value().get<std::vector<std::string>>();
+		}
+		catch (const std::exception&)
+		{
+			const std::string exstr = "cosmetics.json exception: The entry for " + cat.category_name + " isn't a list of class names!";
+			throw std::exception(exstr.c_str());
+		}
+
+		for (const std::string& class_name : class_names)
+		{
+			if (class_name == "All")
+			{
+				cat.is_for_all_classes = true;
+			}
+			else
+			{
+				cat.specific_classes.emplace_back(read_class(class_name, cat.category_name));
+			}
+		}
+
+		result.emplace_back(cat);
+	}
 
 	return result;
+}
+
+player_class json_reader_item_category::read_class(const std::string& class_name, const std::string& category_name)
+{
+	// Classes can be named either by their full name or by their icon name (such as Heavy or Demo).
+	const auto matches = [&class_name](const std::string& name)
+	{
+		return name.size() == class_name.size() && std::equal(name.begin(), name.end(), class_name.begin(),
+			[](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b)); });
+	};
+
+	for (int i = 0; i < player_class_count; ++i)
+	{
+		const player_class cl = static_cast<player_class>(i);
+		if (matches(player_class_to_string(cl)) || matches(get_class_icon(cl)))
+		{
+			return cl;
+		}
+	}
+
+	const std::string exstr = "cosmetics.json exception: Unknown class " + class_name + " in the entry for " + category_name + '!';
+	throw std::exception(exstr.c_str());
 }
\ No newline at end of file
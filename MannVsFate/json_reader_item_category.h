@@ -5,14 +5,20 @@
 #include "json.hpp"
 #include <vector>
 
+// A JSON reader class for reading cosmetic item categories.
 class json_reader_item_category
 {
 public:
+	// Constructor.
 	json_reader_item_category();
 
-	std::vector<item_category> read();
+	// Read every item category from the categories JSON.
+	std::vector<item_category> read() const;
 
 private:
+	// Convert a class name from the categories JSON into a player class.
+	static player_class read_class(const std::string& class_name, const std::string& category_name);
+
 	// Represents the root of the file.
 	nlohmann::json categories_json;
 };
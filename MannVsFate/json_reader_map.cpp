@@ -0,0 +1,146 @@
+#include "json_reader_map.h"
+#include <fstream>
+
+json_reader_map::json_reader_map()
+{
+	std::ifstream maps_file("data/maps.json");
+	if (!maps_file)
+	{
+		const std::string exstr = "json_reader_map exception: Couldn't find maps file \"data/maps.json\".";
+		throw std::exception(exstr.c_str());
+	}
+
+	// Deserialize the JSON data.
+	try
+	{
+		maps_file >> maps_json;
+	}
+	catch (const std::exception&)
+	{
+		throw "maps.json exception: JSON parse error.";
+	}
+
+	maps_file.close();
+}
+
+map_profile json_reader_map::read(const std::string& map_name) const
+{
+	map_profile profile;
+
+	// Retrieve the map data node from the maps JSON.
+	nlohmann::json map_node;
+
+	try
+	{
+		map_node = maps_json.at(map_name);
+	}
+	catch (const std::exception&)
+	{
+		const std::string exstr = "maps.json exception: Couldn't find an entry for " + map_name + '!';
+		throw std::exception(exstr.c_str());
+	}
+
+	// Read the actual map data.
+
+	try
+	{
+		profile.bot_path_length = map_node.at("bot_path_length").get<float>();
+	}
+	catch (const std::exception&) {}
+
+	try
+	{
+		profile.scale_mega = map_node.at("scale_mega").get<float>();
+	}
+	catch (const std::exception&) {}
+
+	try
+	{
+		profile.scale_doom = map_node.at("scale_doom").get<float>();
+	}
+	catch (const std::exception&)
+	{
+		profile.scale_doom = profile.scale_mega;
+	}
+
+	try
+	{
+		profile.engies = map_node.at("engies").get<bool>();
+	}
+	catch (const std::exception&) {}
+
+	try
+	{
+		profile.wave_start_relay = map_node.at("wave_start_relay").get<std::string>();
+	}
+	catch (const std::exception&) {}
+
+	try
+	{
+		profile.wave_finished_relay = map_node.at("wave_finished_relay").get<std::string>();
+	}
+	catch (const std::exception&) {}
+
+	try
+	{
+		profile.spawnbots = map_node.at("spawnbots").get<std::vector<std::string>>();
+	}
+	catch (const std::exception&)
+	{
+		profile.spawnbots.emplace_back("spawnbot");
+	}
+
+	try
+	{
+		profile.spawnbots_giant = map_node.at("spawngiants").get<std::vector<std::string>>();
+	}
+	catch (const std::exception&)
+	{
+		profile.spawnbots_giant = profile.spawnbots;
+	}
+
+	try
+	{
+		profile.spawnbots_mega = map_node.at("spawnmegas").get<std::vector<std::string>>();
+	}
+	catch (const std::exception&)
+	{
+		profile.spawnbots_mega = profile.spawnbots_giant;
+	}
+
+	try
+	{
+		profile.spawnbots_doom = map_node.at("spawndooms").get<std::vector<std::string>>();
+	}
+	catch (const std::exception&)
+	{
+		profile.spawnbots_doom = profile.spawnbots_mega;
+	}
+
+	try
+	{
+		profile.tank_path_starting_points = map_node.at("spawntanks").get<std::vector<std::string>>();
+	}
+	catch (const std::exception&)
+	{
+		// If there are no tank spawn points provided, just assume this map has no tanks.
+	}
+
+	try
+	{
+		profile.max_tank_speed = map_node.at("max_tank_speed").get<float>();
+	}
+	catch (const std::exception&) {}
+
+	return profile;
+}
+
+std::vector<std::string> json_reader_map::get_map_names() const
+{
+	std::vector<std::string> names;
+	for (auto itr = maps_json.begin(); itr != maps_json.end(); ++itr)
+	{
+		names.emplace_back(itr.key());
+	}
+	return names;
+}
\ No newline at end of file
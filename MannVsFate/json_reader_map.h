@@ -0,0 +1,27 @@
+#ifndef JSON_READER_MAP_H
+#define JSON_READER_MAP_H
+
+#include "map_profile.h"
+#include "json.hpp"
+#include <string>
+#include <vector>
+
+// A JSON reader class for reading map data.
+class json_reader_map
+{
+public:
+	// Constructor.
+	json_reader_map();
+
+	// Read the profile of a map from the maps JSON.
+	map_profile read(const std::string& map_name) const;
+
+	// Get the names of every map in the maps JSON.
+	std::vector<std::string> get_map_names() const;
+
+private:
+	// Represents the root of the file.
+	nlohmann::json maps_json;
+};
+
+#endif // JSON_READER_MAP_H
\ No newline at end of file
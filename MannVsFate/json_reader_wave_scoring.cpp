@@ -0,0 +1,79 @@
+#include "json_reader_wave_scoring.h"
+#include <algorithm>
+#include <fstream>
+
+json_reader_wave_scoring::json_reader_wave_scoring(const std::string& filename)
+	: filename(filename)
+{
+	std::ifstream scoring_file(filename);
+	if (!scoring_file)
+	{
+		const std::string exstr = "json_reader_wave_scoring exception: Couldn't find wave scoring file \"" + filename + "\".";
+		throw std::exception(exstr.c_str());
+	}
+
+	try
+	{
+		scoring_file >> scoring_json;
+	}
+	catch (const std::exception&)
+	{
+		const std::string exstr = filename + " exception: JSON parse error.";
+		throw std::exception(exstr.c_str());
+	}
+
+	scoring_file.close();
+}
+
+wave_scoring json_reader_wave_scoring::read() const
+{
+	wave_scoring scoring;
+
+	try
+	{
+		scoring.target_duration = scoring_json.at("target_duration").get<float>();
+	}
+	catch (const std::exception&) {}
+
+	try
+	{
+		scoring.duration_weight = scoring_json.at("duration_weight").get<float>();
+	}
+	catch (const std::exception&) {}
+
+	try
+	{
+		scoring.pressure_weight = scoring_json.at("pressure_weight").get<float>();
+	}
+	catch (const std::exception&) {}
+
+	// The curve is a list of [progress, pressure] pairs.
+	const auto curve_node = scoring_json.find("pressure_curve");
+	if (curve_node != scoring_json.end())
+	{
+		std::vector<std::vector<float>> points;
+		try
+		{
+			points = curve_node->get<std::vector<std::vector<float>>>();
+		}
+		catch (const std::exception&) {}
+
+		for (const std::vector<float>& point : points)
+		{
+			if (point.size() != 2)
+			{
+				points.clear();
+				break;
+			}
+			scoring.pressure_curve.emplace_back(point.at(0), point.at(1));
+		}
+		if (points.empty())
+		{
+			const std::string exstr = filename + " exception: pressure_curve must be a list of [progress, pressure] pairs.";
+			throw std::exception(exstr.c_str());
+		}
+		std::sort(scoring.pressure_curve.begin(), scoring.pressure_curve.end());
+	}
+
+	return scoring;
+}
\ No newline at end of file
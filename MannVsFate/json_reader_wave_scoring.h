@@ -0,0 +1,25 @@
+#ifndef JSON_READER_WAVE_SCORING_H
+#define JSON_READER_WAVE_SCORING_H
+
+#include "wave_scoring.h"
+#include "json.hpp"
+#include <string>
+
+// A JSON reader class for reading how candidate waves are scored.
+class json_reader_wave_scoring
+{
+public:
+	// Constructor.
+	explicit json_reader_wave_scoring(const std::string& filename);
+
+	// Read the scoring settings. Settings that the file leaves out keep their defaults.
+	wave_scoring read() const;
+
+private:
+	// The name of the file, for error messages.
+	std::string filename;
+	// Represents the root of the file.
+	nlohmann::json scoring_json;
+};
+
+#endif
\ No newline at end of file
@@ -178,7 +178,7 @@ void json_reader_weapon::read_weapon_node(weapon& wep, const std::string& weapon
 		}
 		else if (restriction == "melee")
 		{
-			wep.type == weapon::slot::melee;
+			wep.type = weapon::slot::melee;
 		}
 	}
 	catch (const std::exception&) {}
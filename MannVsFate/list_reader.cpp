@@ -1,7 +1,15 @@
 #include "list_reader.h"
 #include "rand_util.h"
-#include <fstream>
-#include <string>
+#include "data_pack.h"
+#include "profiler.h"
+#include "allocation_tracker.h"
+#include "event_counters.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <set>
+#include <thread>
 
 // If 1, print debug messages to std::cout.
 #define LIST_READER_DEBUG 0
@@ -12,52 +20,178 @@
 
 #endif
 
-void list_reader::load(const std::string& source_filename)
+list_reader::list& list_reader::load(const std::string& source_filename)
 {
 	// Check if there's already an entry for the file in the lists map.
 	// If there already is an entry, this function does nothing, thus saving computation power.
-	if (lists.find(source_filename) == lists.end())
+	auto itr = lists.find(source_filename);
+	if (itr == lists.end())
 	{
-		std::ifstream file(source_filename);
-		if (file)
-		{
-			// Instantiate a vector for the corresponding filename within the lists map.
-			// This vector will contain the list of items read from the file.
-			lists.emplace(source_filename, std::vector<std::string>());
-			std::string phrase;
-			while (std::getline(file, phrase))
-			{
-				lists.at(source_filename).emplace_back(phrase);
+		itr = lists.emplace(source_filename, read(source_filename)).first;
+		event_counters::add(event_counters::counter::list_loads);
+	}
+	return itr->second;
+}
+
+list_reader::list list_reader::read(const std::string& source_filename)
+{
+	const profiler::scoped_timer timer(profiler::phase::list_data);
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::list_reader);
+	list new_list;
+	const data_pack* pack = data_pack::get_active();
+	if (pack == nullptr || !pack->find_list(source_filename, new_list.phrases))
+	{
+		// Map the file rather than reading it so that the phrases don't need their own allocations.
+		new_list.file = std::make_unique<mapped_file>(source_filename);
+		new_list.phrases = split_lines(new_list.file->view());
+	}
 
 #if LIST_READER_DEBUG == 1
-				std::cout << "Appended phrase " << phrase << " to vector " << source_filename << '.' << std::endl;
+	for (const std::string_view phrase : new_list.phrases)
+	{
+		std::cout << "Appended phrase " << phrase << " to vector " << source_filename << '.' << std::endl;
+	}
 #endif
+
+	return new_list;
+}
+
+void list_reader::preload(const std::vector<preload_request>& requests)
+{
+	// Work out which lists actually need loading, skipping duplicates and lists that are already loaded.
+	std::vector<const preload_request*> pending;
+	std::set<std::pair<const list_reader*, std::string>> seen;
+	for (const preload_request& request : requests)
+	{
+		if (request.reader->lists.count(request.source_filename) == 0 &&
+			seen.emplace(request.reader, request.source_filename).second)
+		{
+			pending.emplace_back(&request);
+		}
+	}
+
+	if (pending.empty())
+	{
+		return;
+	}
+	// The lists are counted here rather than as they're read, since they're read on threads of their own.
+	event_counters::add(event_counters::counter::list_loads, pending.size());
+
+	// A few threads are enough to overlap the file reads; the lists are small.
+	const unsigned int max_threads = std::max(1u, std::min(std::thread::hardware_concurrency(), 4u));
+	const std::size_t thread_count = std::min<std::size_t>(pending.size(), max_threads);
+
+	std::vector<list> loaded(pending.size());
+	std::vector<std::exception_ptr> errors(pending.size());
+	std::atomic<std::size_t> next(0);
+
+	const auto work = [&]()
+	{
+		for (std::size_t i = next++; i < pending.size(); i = next++)
+		{
+			try
+			{
+				loaded.at(i) = read(pending.at(i)->source_filename);
 			}
-			file.close();
+			catch (...)
+			{
+				errors.at(i) = std::current_exception();
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(thread_count - 1);
+	for (std::size_t i = 1; i < thread_count; ++i)
+	{
+		threads.emplace_back(work);
+	}
+	// The calling thread does its share of the work too.
+	work();
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	for (const std::exception_ptr& error : errors)
+	{
+		if (error)
+		{
+			std::rethrow_exception(error);
 		}
-		else
+	}
+
+	// Only the calling thread touches the list readers themselves.
+	for (std::size_t i = 0; i < pending.size(); ++i)
+	{
+		pending.at(i)->reader->lists.emplace(pending.at(i)->source_filename, std::move(loaded.at(i)));
+	}
+}
+
+void list_reader::preload(const std::vector<std::string>& sources)
+{
+	std::vector<preload_request> requests;
+	requests.reserve(sources.size());
+	for (const std::string& source : sources)
+	{
+		requests.push_back({ this, source });
+	}
+	preload(requests);
+}
+
+std::vector<std::string_view> list_reader::split_lines(std::string_view contents)
+{
+	std::vector<std::string_view> lines;
+
+	const char* const begin = contents.data();
+	const char* const end = begin + contents.size();
+
+	// Count the lines first so that the vector only allocates once.
+	// memchr is vectorized by the standard library, so this is a fast scan even for big lists.
+	std::size_t line_count = 0;
+	for (const char* p = begin; p < end; ++line_count)
+	{
+		const void* newline = std::memchr(p, '\n', end - p);
+		p = newline ? static_cast<const char*>(newline) + 1 : end;
+	}
+	lines.reserve(line_count);
+
+	for (const char* p = begin; p < end;)
+	{
+		const void* newline = std::memchr(p, '\n', end - p);
+		const char* line_end = newline ? static_cast<const char*>(newline) : end;
+		std::string_view line(p, line_end - p);
+		// Files saved with Windows line endings would otherwise leave a carriage return on each phrase.
+		if (!line.empty() && line.back() == '\r')
 		{
-			const std::string exstr = "list_reader::load exception: File \"" + source_filename + "\" not found!";
-			throw std::exception(exstr.c_str());
+			line.remove_suffix(1);
 		}
+		lines.emplace_back(line);
+		p = newline ? line_end + 1 : end;
 	}
+
+	return lines;
 }
 
-std::string list_reader::get_random(const std::string& source)
+std::string_view list_reader::get_random(const std::string& source)
 {
-	load(source);
-	const std::vector<std::string>& vec = lists.at(source);
+	const std::vector<std::string_view>& vec = load(source).phrases;
 	const int index = rand_int(0, vec.size());
 	return vec.at(index);
 }
 
-std::string list_reader::get_random(const std::vector<std::string>& sources)
+std::string_view list_reader::get_random(const std::vector<std::string>& sources)
 {
-	std::vector<std::vector<std::string>*> vec;
-	for (unsigned int i = 0; i < sources.size(); ++i)
+	std::vector<const std::vector<std::string_view>*> vec;
+	vec.reserve(sources.size());
+	for (const std::string& source : sources)
 	{
-		load(sources[i]);
-		vec.emplace_back(&lists.at(sources[i]));
+		vec.emplace_back(&load(source).phrases);
 	}
 	return rand_element_from_many_collections(vec);
+}
+
+const std::vector<std::string_view>& list_reader::get_list(const std::string& source)
+{
+	return load(source).phrases;
 }
\ No newline at end of file
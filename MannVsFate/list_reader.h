@@ -1,23 +1,62 @@
 #ifndef LIST_READER_H
 #define LIST_READER_H
 
+#include "mapped_file.h"
 #include <map>
+#include <memory>
+#include <string>
+#include <string_view>
 #include <vector>
 
+// Reads lists of phrases from files, one phrase per line.
+// Lists are taken from the active data pack when it has them. Otherwise files are memory-mapped.
+// Either way, each phrase is a view into a mapping, so phrases stay valid for as long as the list reader and the data pack do.
 class list_reader
 {
 public:
+	// A list that should be loaded into a certain list reader ahead of time.
+	struct preload_request
+	{
+		list_reader* reader;
+		std::string source_filename;
+	};
+
+	// Load many lists at once, reading the files concurrently on a small pool of threads.
+	// Lists that are already loaded are skipped. Throws if any of the files can't be read.
+	static void preload(const std::vector<preload_request>& requests);
+	// Load several lists into this list reader at once.
+	void preload(const std::vector<std::string>& sources);
+
 	// Get a random element from a certain list.
-	std::string get_random(const std::string& source);
+	std::string_view get_random(const std::string& source);
 	// Get a random element from several lists.
-	std::string get_random(const std::vector<std::string>& sources);
+	std::string_view get_random(const std::vector<std::string>& sources);
+	// Get an entire list, loading it first if necessary.
+	const std::vector<std::string_view>& get_list(const std::string& source);
 
 private:
+	// A list loaded from a file.
+	struct list
+	{
+		// The mapped file that the phrases point into. nullptr if the list came from the data pack.
+		std::unique_ptr<mapped_file> file;
+		// Each line of the file.
+		std::vector<std::string_view> phrases;
+	};
+
 	// Load a list from a file. If the file is already loaded, this function does nothing.
-	void load(const std::string& source_filename);
+	// Returns the loaded list.
+	list& load(const std::string& source_filename);
+
+	// Read a list from the data pack or from its file.
+	// This doesn't touch any list reader, so it's safe to call from several threads at once.
+	static list read(const std::string& source_filename);
+
+	// Split a file's contents into lines.
+	static std::vector<std::string_view> split_lines(std::string_view contents);
 
 	// The collection of lists loaded from files.
-	std::map<std::string, std::vector<std::string>> lists;
+	std::map<std::string, list> lists;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "loadout_table.h"
+#include "json_reader_weapon.h"
+#include "list_reader.h"
+#include "data_pack.h"
+#include "rand_util.h"
+
+loadout_table::loadout_table(const json_reader_weapon& weapon_reader, list_reader& item_reader)
+{
+	base_jumpers.reserve(player_class_count);
+
+	// Read every item list up front so that the files are read concurrently.
+	std::vector<std::string> files;
+	for (int i = 0; i < player_class_count; ++i)
+	{
+		for (const weapon::slot s : get_loaded_slots(static_cast<player_class>(i)))
+		{
+			files.emplace_back(get_item_file(static_cast<player_class>(i), s));
+		}
+	}
+	item_reader.preload(files);
+
+	for (int i = 0; i < player_class_count; ++i)
+	{
+		const player_class cl = static_cast<player_class>(i);
+
+		for (const weapon::slot s : get_loaded_slots(cl))
+		{
+			load_pool(weapon_reader, item_reader, cl, s, get_item_file(cl, s));
+		}
+
+		base_jumpers.emplace_back(weapon_reader.read_weapon("The B.A.S.E. Jumper", cl));
+	}
+}
+
+loadout_table::loadout_table(const data_pack& pack)
+{
+	base_jumpers.reserve(player_class_count);
+
+	for (int i = 0; i < player_class_count; ++i)
+	{
+		const player_class cl = static_cast<player_class>(i);
+
+		for (int j = 0; j < slot_count; ++j)
+		{
+			const weapon::slot s = static_cast<weapon::slot>(j);
+			pools.at(i).at(j) = pack.get_pool(cl, s);
+		}
+
+		base_jumpers.emplace_back(pack.get_base_jumper(cl));
+	}
+}
+
+std::array<weapon::slot, 3> loadout_table::get_loaded_slots(const player_class cl)
+{
+	if (cl == player_class::spy)
+	{
+		// Spies have cloaks instead of primary weapons.
+		// Sapper swaps are disabled, so the building slot isn't loaded.
+		return { weapon::slot::secondary, weapon::slot::melee, weapon::slot::pda2 };
+	}
+	return { weapon::slot::secondary, weapon::slot::melee, weapon::slot::primary };
+}
+
+std::string loadout_table::get_item_file(const player_class cl, const weapon::slot s)
+{
+	static const std::array<const char*, slot_count> slot_files{ "primary.txt", "secondary.txt", "melee.txt", "building.txt", "pda2.txt" };
+	return "data/items/" + get_class_icon(cl) + '/' + slot_files.at(static_cast<int>(s));
+}
+
+void loadout_table::load_pool(const json_reader_weapon& weapon_reader, list_reader& item_reader,
+	const player_class cl, const weapon::slot s, const std::string& file_name)
+{
+	const std::vector<std::string_view>& names = item_reader.get_list(file_name);
+	std::vector<weapon>& pool = pools.at(static_cast<int>(cl)).at(static_cast<int>(s));
+	pool.reserve(names.size());
+
+	for (const std::string_view name : names)
+	{
+		try
+		{
+			pool.emplace_back(weapon_reader.read_weapon(std::string(name), cl));
+		}
+		catch (const std::exception& e)
+		{
+			const std::string exstr = "loadout_table exception: " + file_name + " lists an unknown item. " + e.what();
+			throw std::exception(exstr.c_str());
+		}
+	}
+
+	if (pool.empty())
+	{
+		const std::string exstr = "loadout_table exception: Item list \"" + file_name + "\" is empty!";
+		throw std::exception(exstr.c_str());
+	}
+}
+
+const weapon& loadout_table::get_random(const player_class cl, const weapon::slot s) const
+{
+	const std::vector<weapon>& pool = pools[static_cast<int>(cl)][static_cast<int>(s)];
+	return pool.at(rand_int(0, pool.size()));
+}
+
+const weapon& loadout_table::get_base_jumper(const player_class cl) const
+{
+	return base_jumpers.at(static_cast<int>(cl));
+}
+
+const std::vector<weapon>& loadout_table::get_pool(const player_class cl, const weapon::slot s) const
+{
+	return pools.at(static_cast<int>(cl)).at(static_cast<int>(s));
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+// A table of every weapon each class can be given, resolved once at startup.
+
+#ifndef LOADOUT_TABLE_H
+#define LOADOUT_TABLE_H
+
+#include "weapon.h"
+#include "player_class.h"
+#include <array>
+#include <string>
+#include <vector>
+
+class json_reader_weapon;
+class list_reader;
+class data_pack;
+
+class loadout_table
+{
+public:
+	// The number of weapon slots in the weapon::slot enum.
+	static constexpr int slot_count = 5;
+
+	// Constructor. Reads every class' item lists and resolves each item through the weapon reader.
+	// Throws if a list contains an item that has no entry in the weapons JSON.
+	loadout_table(const json_reader_weapon& weapon_reader, list_reader& item_reader);
+	// Constructor. Copies every class' weapons out of a compiled data pack.
+	explicit loadout_table(const data_pack& pack);
+
+	// Get a random weapon for a class from one of its slots.
+	const weapon& get_random(const player_class cl, const weapon::slot s) const;
+
+	// Get The B.A.S.E. Jumper as resolved for a given class.
+	const weapon& get_base_jumper(const player_class cl) const;
+
+	// Get every weapon a class can have in one of its slots.
+	const std::vector<weapon>& get_pool(const player_class cl, const weapon::slot s) const;
+
+private:
+	// Get the slots whose item lists are loaded for a class.
+	static std::array<weapon::slot, 3> get_loaded_slots(const player_class cl);
+	// Get the item list file of one of a class' slots.
+	static std::string get_item_file(const player_class cl, const weapon::slot s);
+
+	// Resolve every item in an item list file into the pool for the given class and slot.
+	void load_pool(const json_reader_weapon& weapon_reader, list_reader& item_reader,
+		const player_class cl, const weapon::slot s, const std::string& file_name);
+
+	// The weapon pools, indexed by class and then by slot.
+	std::array<std::array<std::vector<weapon>, slot_count>, player_class_count> pools;
+	// The B.A.S.E. Jumper for each class, since the weapon's slot depends on the class.
+	std::vector<weapon> base_jumpers;
+};
+
+#endif // LOADOUT_TABLE_H
\ No newline at end of file
@@ -4,348 +4,214 @@
 // This is a Team Fortress 2 Mann vs Machine random mission generator.
 // Recommended to be played with a bomb respawn plugin setting the bomb respawn to 15 seconds.
 
-#include "bot_generator.h"
-#include "tank_generator.h"
-#include "wave_generator.h"
-#include "cosmetics_generator.h"
-#include "currency_manager.h"
-#include "pressure_manager.h"
+#include "popfile_generator.h"
+#include "generator_data.h"
+#include "popfile_server.h"
+#include "mission_pool.h"
+#include "difficulty_calibrator.h"
 #include "json_reader_item_category.h"
+#include "data_pack.h"
+#include "profiler.h"
+#include "allocation_tracker.h"
+#include "time_util.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <thread>
 
-int toint(const char* in)
+// Open the compiled data pack, if there is one that still matches the data files.
+std::unique_ptr<data_pack> load_data_pack()
 {
-	return std::stoi(in);
-}
-
-float tofloat(const char* in)
-{
-	return std::stof(in);
+	try
+	{
+		std::unique_ptr<data_pack> pack = data_pack::open(data_pack::default_filename);
+		if (pack != nullptr && pack->is_stale())
+		{
+			std::cout << "The data pack is out of date, so the data files will be read instead. Run with -pack to rebuild it." << std::endl;
+			pack.reset();
+		}
+		return pack;
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << e.what() << " The data files will be read instead." << std::endl;
+		return nullptr;
+	}
 }
 
 int main(int argc, char** argv)
 {
 	try
 	{
-		// Instantiate the popfile generator and all of its dependencies.
-		currency_manager cm;
-		pressure_manager pm(cm);
-		json_reader_item_category jric;
-		cosmetics_generator cosgen(jric.read());
-		bot_generator botgen(pm, cosgen);
-		tank_generator tankgen(pm);
-		wave_generator gen(cm, pm, botgen, tankgen);
+		// Compiling the data pack, serving popfiles and calibrating the difficulty replace generating a single mission.
+		// They have to be set up before anything reads the data files.
+		std::string serve_path;
+		std::string pool_config;
+		unsigned int serve_workers = std::max(1u, std::thread::hardware_concurrency());
+		std::unique_ptr<difficulty_calibrator::target_type> calibration_type;
+		float calibration_target = 0.0f;
+		unsigned int calibration_samples = 8;
+		std::string profile_filename;
+		std::string trace_filename;
+		std::string allocations_filename;
+		for (int i = 1; i < argc; ++i)
+		{
+			if (std::strcmp(argv[i], "-pack") == 0)
+			{
+				data_pack::compile(data_pack::default_filename);
+				std::cout << "Compiled the data files into " << data_pack::default_filename << '.' << std::endl;
+				return 0;
+			}
+			if (std::strcmp(argv[i], "-serve") == 0 && i + 1 < argc)
+			{
+				++i;
+				serve_path = argv[i];
+				continue;
+			}
+			if (std::strcmp(argv[i], "-pool") == 0 && i + 1 < argc)
+			{
+				++i;
+				pool_config = argv[i];
+				continue;
+			}
+			if (std::strcmp(argv[i], "-workers") == 0 && i + 1 < argc)
+			{
+				++i;
+				serve_workers = std::stoi(argv[i]);
+				continue;
+			}
+			if (std::strcmp(argv[i], "-calibrateduration") == 0 && i + 1 < argc)
+			{
+				++i;
+				calibration_type = std::make_unique<difficulty_calibrator::target_type>(difficulty_calibrator::target_type::duration);
+				calibration_target = std::stof(argv[i]);
+				continue;
+			}
+			if (std::strcmp(argv[i], "-calibratehealth") == 0 && i + 1 < argc)
+			{
+				++i;
+				calibration_type = std::make_unique<difficulty_calibrator::target_type>(difficulty_calibrator::target_type::health);
+				calibration_target = std::stof(argv[i]);
+				continue;
+			}
+			if (std::strcmp(argv[i], "-calibrationsamples") == 0 && i + 1 < argc)
+			{
+				++i;
+				calibration_samples = std::stoi(argv[i]);
+				continue;
+			}
+			if (std::strcmp(argv[i], "-profile") == 0 && i + 1 < argc)
+			{
+				++i;
+				profile_filename = argv[i];
+				continue;
+			}
+			if (std::strcmp(argv[i], "-trace") == 0 && i + 1 < argc)
+			{
+				++i;
+				trace_filename = argv[i];
+				continue;
+			}
+			if (std::strcmp(argv[i], "-allocations") == 0 && i + 1 < argc)
+			{
+				++i;
+				allocations_filename = argv[i];
+				continue;
+			}
+		}
 
-		// Interpret command line arguments.
-		if (argc > 1)
+		// The profiler has to be active before the data is loaded so that loading is timed too.
+		std::unique_ptr<profiler> prof;
+		if (!profile_filename.empty() || !trace_filename.empty())
+		{
+			prof = std::make_unique<profiler>();
+			prof->set_tracing(!trace_filename.empty());
+			profiler::set_active(prof.get());
+		}
+		// Counting allocations takes a build of its own, so find out before generating anything.
+		if (!allocations_filename.empty() && !allocation_tracker::is_enabled())
+		{
+			throw std::exception("main exception: This build doesn't track allocations, so -allocations can't be used. Build it with ALLOCATION_TRACKING set to 1.");
+		}
+		// Write whichever of the profile, the trace and the allocation report were asked for.
+		const auto write_profile = [&]()
 		{
-			for (int i = 1; i < argc; ++i)
+			if (!profile_filename.empty())
 			{
-				if (std::strcmp(argv[i], "-map") == 0)
-				{
-					++i;
-					gen.set_map_name(argv[i]);
-					continue;
-				}
-				if (std::strcmp(argv[i], "-name") == 0)
-				{
-					++i;
-					gen.set_mission_name(argv[i]);
-					continue;
-				}
-				if (std::strcmp(argv[i], "-startingcurrency") == 0)
-				{
-					++i;
-					cm.set_currency(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-waves") == 0)
-				{
-					++i;
-					gen.set_waves(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-respawnwavetime") == 0)
-				{
-					++i;
-					gen.set_respawn_wave_time(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-halloween") == 0)
-				{
-					gen.set_event_popfile(1);
-					continue;
-				}
-				if (std::strcmp(argv[i], "-fixedrespawnwavetime") == 0)
-				{
-					gen.set_fixed_respawn_wave_time(true);
-					continue;
-				}
-				if (std::strcmp(argv[i], "-busterdamagethreshold") == 0)
-				{
-					++i;
-					gen.set_add_sentry_buster_when_damage_dealt_exceeds(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-busterkillthreshold") == 0)
-				{
-					++i;
-					gen.set_add_sentry_buster_when_kill_count_exceeds(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-botspawnattack") == 0)
-				{
-					gen.set_can_bots_attack_while_in_spawn_room(true);
-					continue;
-				}
-				if (std::strcmp(argv[i], "-bustercooldown") == 0)
-				{
-					++i;
-					gen.set_sentry_buster_cooldown(tofloat(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-players") == 0)
-				{
-					++i;
-					pm.set_players(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-wavecurrency") == 0)
-				{
-					++i;
-					cm.set_currency_per_wave(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-time") == 0)
-				{
-					++i;
-					gen.set_max_time(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-tankchance") == 0)
-				{
-					++i;
-					gen.set_tank_chance(tofloat(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-icons") == 0)
-				{
-					++i;
-					gen.set_max_icons(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-wavespawns") == 0)
-				{
-					++i;
-					gen.set_max_wavespawns(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-classes") == 0)
-				{
-					++i;
-					const int flags = toint(argv[i]);
-					std::vector<player_class> possible_classes;
+				prof->write_report(profile_filename);
+				std::cout << "Wrote the profile to " << profile_filename << '.' << std::endl;
+			}
+			if (!trace_filename.empty())
+			{
+				prof->write_trace(trace_filename);
+				std::cout << "Wrote the trace to " << trace_filename << '.' << std::endl;
+			}
+			if (!allocations_filename.empty())
+			{
+				allocation_tracker::write_report(allocations_filename);
+				std::cout << "Wrote the allocation report to " << allocations_filename << '.' << std::endl;
+			}
+		};
+
+		const auto load_start = std::chrono::steady_clock::now();
+		profiler::scoped_timer load_timer(profiler::phase::data_load);
+		allocation_tracker::scoped_phase load_allocations(allocation_tracker::phase::load);
+
+		std::unique_ptr<data_pack> pack = load_data_pack();
+		if (pack == nullptr && (!serve_path.empty() || !pool_config.empty() || calibration_type != nullptr))
+		{
+			// A server or a pool keeps running for a long time, so it's worth compiling the pack to have all of the data resident in one mapping.
+			// Calibration sets up generators for hundreds of simulated missions, which is only quick with the pack.
+			data_pack::compile(data_pack::default_filename);
+			pack = data_pack::open(data_pack::default_filename);
+		}
+		data_pack::set_active(pack.get());
 
-					if (flags & 1)
-					{
-						possible_classes.emplace_back(player_class::scout);
-					}
-					if (flags & 2)
-					{
-						possible_classes.emplace_back(player_class::soldier);
-					}
-					if (flags & 4)
-					{
-						possible_classes.emplace_back(player_class::pyro);
-					}
-					if (flags & 8)
-					{
-						possible_classes.emplace_back(player_class::demoman);
-					}
-					if (flags & 16)
-					{
-						possible_classes.emplace_back(player_class::heavyweapons);
-					}
-					if (flags & 32)
-					{
-						possible_classes.emplace_back(player_class::engineer);
-					}
-					if (flags & 64)
-					{
-						possible_classes.emplace_back(player_class::medic);
-					}
-					if (flags & 128)
-					{
-						possible_classes.emplace_back(player_class::sniper);
-					}
-					if (flags & 256)
-					{
-						possible_classes.emplace_back(player_class::spy);
-					}
+		const std::vector<item_category> categories = pack != nullptr ? pack->get_item_categories() : json_reader_item_category().read();
+		// Every mission that this process generates borrows the same data.
+		generator_data data(categories);
 
-					botgen.set_possible_classes(possible_classes);
+		if (!serve_path.empty())
+		{
+			popfile_server server(serve_path, data, serve_workers);
+			server.run();
+			return 0;
+		}
 
-					continue;
-				}
-				if (std::strcmp(argv[i], "-botmaxtime") == 0)
-				{
-					++i;
-					gen.set_max_tfbot_wavespawn_time(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-tankmaxtime") == 0)
-				{
-					++i;
-					gen.set_max_tank_wavespawn_time(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-difficulty") == 0)
-				{
-					++i;
-					pm.set_pressure_decay_rate_multiplier_in_time(tofloat(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-giantchance") == 0)
-				{
-					++i;
-					botgen.set_giant_chance(tofloat(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-bosschance") == 0)
-				{
-					++i;
-					botgen.set_boss_chance(tofloat(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-giantchanceincrease") == 0)
-				{
-					++i;
-					botgen.set_giant_chance_increase(tofloat(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-bosschanceincrease") == 0)
-				{
-					++i;
-					botgen.set_boss_chance_increase(tofloat(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-currencyspread") == 0)
-				{
-					++i;
-					cm.set_currency_per_wave_spread(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-wackysounds") == 0)
-				{
-					++i;
-					gen.set_use_wacky_sounds(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-wackyvoratio") == 0)
-				{
-					++i;
-					gen.set_wacky_sound_vo_ratio(tofloat(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-wavespawncurrency") == 0)
-				{
-					++i;
-					cm.set_currency_per_wavespawn(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-wavespawncurrencyspread") == 0)
-				{
-					++i;
-					cm.set_currency_per_wavespawn_spread(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-wavespawncurrencylimit") == 0)
-				{
-					++i;
-					cm.set_currency_per_wavespawn_limit(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-doombot") == 0)
-				{
-					gen.set_doombot_enabled(true);
-					continue;
-				}
-				if (std::strcmp(argv[i], "-cosmetics") == 0)
-				{
-					botgen.set_give_bots_cosmetics(true);
-					continue;
-				}
-				if (std::strcmp(argv[i], "-bothp") == 0)
-				{
-					++i;
-					gen.set_force_tfbot_hp(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-tankhp") == 0)
-				{
-					++i;
-					gen.set_force_tank_hp(toint(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-tankspeed") == 0)
-				{
-					++i;
-					gen.set_force_tank_speed(tofloat(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-firechance") == 0)
-				{
-					++i;
-					botgen.set_fire_chance(tofloat(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-bleedchance") == 0)
-				{
-					++i;
-					botgen.set_bleed_chance(tofloat(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-bleedforall") == 0)
-				{
-					botgen.set_nonbosses_can_get_bleed(true);
-					continue;
-				}
-				if (std::strcmp(argv[i], "-botscalechance") == 0)
-				{
-					++i;
-					botgen.set_bot_scale_chance(tofloat(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-minimumbotscale") == 0)
-				{
-					++i;
-					botgen.set_minimum_bot_scale(tofloat(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-maximumbotscale") == 0)
-				{
-					++i;
-					botgen.set_maximum_bot_scale(tofloat(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-minimumgiantscale") == 0)
-				{
-					++i;
-					botgen.set_minimum_giant_scale(tofloat(argv[i]));
-					continue;
-				}
-				if (std::strcmp(argv[i], "-forcebotscale") == 0)
-				{
-					++i;
-					botgen.set_force_bot_scale(tofloat(argv[i]));
-					continue;
-				}
-			}
+		if (!pool_config.empty())
+		{
+			mission_pool pool(pool_config, data, serve_workers);
+			pool.run();
+			return 0;
 		}
 
+		if (calibration_type != nullptr)
+		{
+			load_timer.stop();
+			load_allocations.stop();
+			difficulty_calibrator calibrator(data, argc, argv, serve_workers);
+			calibrator.set_target(*calibration_type, calibration_target);
+			calibrator.set_samples(calibration_samples);
+			calibrator.calibrate();
+			write_profile();
+			return 0;
+		}
+
+		// Instantiate the popfile generator and all of its dependencies.
+		popfile_generator popgen(data);
+		load_timer.stop();
+		load_allocations.stop();
+
+		std::cout << "Loaded the data in " << milliseconds_between(load_start, std::chrono::steady_clock::now()) << " ms." << std::endl;
+
+		// Interpret command line arguments.
+		popgen.apply_arguments(argc, argv);
+
 		// Generate the actual mission.
-		gen.generate_mission(argc, argv);
+		popgen.generate(argc, argv);
+
+		write_profile();
 	}
 	catch (const std::exception& e)
 	{
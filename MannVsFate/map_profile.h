@@ -0,0 +1,37 @@
+#ifndef MAP_PROFILE_H
+#define MAP_PROFILE_H
+
+#include <string>
+#include <vector>
+
+// The properties of an MVM map that the wave generator needs to know about.
+// Every property is already resolved, so properties that a map doesn't specify hold their fallback values.
+struct map_profile
+{
+	// The relative length of the map's bot path. mvm_bigrock is used as a basis, with a length of 1.0f.
+	float bot_path_length = 1.0f;
+	// The biggest scale that an enemy can have when navigating through the map.
+	float scale_mega = 1.75f;
+	// The scale of a doombot on this map.
+	float scale_doom = 1.75f;
+	// Whether enemy engineers can spawn on this map.
+	bool engies = true;
+	// The highest speed at which tanks can move on this map. Negative if the map doesn't limit it.
+	float max_tank_speed = -1.0f;
+	// The name of the wave_start_relay entity.
+	std::string wave_start_relay = "wave_start_relay";
+	// The name of the wave_finished_relay entity.
+	std::string wave_finished_relay = "wave_finished_relay";
+	// The collection of possible starting points for each generic robot spawn.
+	std::vector<std::string> spawnbots;
+	// The collection of possible starting points for each large robot spawn.
+	std::vector<std::string> spawnbots_giant;
+	// The collection of possible starting points for each boss/mega robot spawn.
+	std::vector<std::string> spawnbots_mega;
+	// The collection of possible starting points for each doom robot spawn.
+	std::vector<std::string> spawnbots_doom;
+	// The collection of starting points for each tank path. Empty if the map has no tanks.
+	std::vector<std::string> tank_path_starting_points;
+};
+
+#endif // MAP_PROFILE_H
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+mapped_file::mapped_file(const std::string& filename)
+	: contents(""), length(0), file_handle(INVALID_HANDLE_VALUE), mapping_handle(nullptr)
+{
+	file_handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file_handle == INVALID_HANDLE_VALUE)
+	{
+		const std::string exstr = "mapped_file exception: File \"" + filename + "\" not found!";
+		throw std::exception(exstr.c_str());
+	}
+
+	LARGE_INTEGER file_size;
+	GetFileSizeEx(file_handle, &file_size);
+	length = static_cast<std::size_t>(file_size.QuadPart);
+
+	// Empty files can't be mapped, but there's nothing to read from them anyway.
+	if (length != 0)
+	{
+		mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		const void* view = mapping_handle ? MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (view == nullptr)
+		{
+			if (mapping_handle)
+			{
+				CloseHandle(mapping_handle);
+			}
+			CloseHandle(file_handle);
+			const std::string exstr = "mapped_file exception: Couldn't map file \"" + filename + "\".";
+			throw std::exception(exstr.c_str());
+		}
+		contents = static_cast<const char*>(view);
+	}
+}
+
+mapped_file::~mapped_file()
+{
+	if (length != 0)
+	{
+		UnmapViewOfFile(contents);
+		CloseHandle(mapping_handle);
+	}
+	CloseHandle(file_handle);
+}
+
+#else
+
+mapped_file::mapped_file(const std::string& filename)
+	: contents(""), length(0)
+{
+	const int fd = open(filename.c_str(), O_RDONLY);
+	if (fd == -1)
+	{
+		const std::string exstr = "mapped_file exception: File \"" + filename + "\" not found!";
+		throw std::exception(exstr.c_str());
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) == 0)
+	{
+		length = static_cast<std::size_t>(file_stat.st_size);
+	}
+
+	// Empty files can't be mapped, but there's nothing to read from them anyway.
+	if (length != 0)
+	{
+		void* view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (view == MAP_FAILED)
+		{
+			close(fd);
+			const std::string exstr = "mapped_file exception: Couldn't map file \"" + filename + "\".";
+			throw std::exception(exstr.c_str());
+		}
+		contents = static_cast<const char*>(view);
+	}
+
+	// The mapping stays valid after the descriptor is closed.
+	close(fd);
+}
+
+mapped_file::~mapped_file()
+{
+	if (length != 0)
+	{
+		munmap(const_cast<char*>(contents), length);
+	}
+}
+
+#endif
+
+std::string_view mapped_file::view() const
+{
+	return std::string_view(contents, length);
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+// A read-only memory mapping of an entire file.
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+
+class mapped_file
+{
+public:
+	// Constructor. Maps the whole file into memory. Throws if the file can't be opened or mapped.
+	explicit mapped_file(const std::string& filename);
+	// Destructor. Unmaps the file.
+	~mapped_file();
+
+	// The mapping can't be shared between owners.
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+
+	// Get the contents of the file.
+	std::string_view view() const;
+
+private:
+	// The start of the mapped contents.
+	const char* contents;
+	// The size of the file in bytes.
+	std::size_t length;
+
+#ifdef _WIN32
+	// The handles of the file and its mapping object.
+	void* file_handle;
+	void* mapping_handle;
+#endif
+};
+
+#endif // MAPPED_FILE_H
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "mission_cache.h"
+#include "data_pack.h"
+#include "wave_generator.h"
+#include "popfile_writer.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+mission_cache::mission_cache(const std::string& directory, std::uintmax_t max_bytes)
+	: directory(directory), max_bytes(max_bytes)
+{
+	std::filesystem::create_directories(this->directory);
+}
+
+std::string mission_cache::make_key(const std::string& normalized_options, unsigned int seed)
+{
+	std::stringstream key_text;
+	key_text << wave_generator::get_version() << '\n'
+		<< data_pack::format_version << '\n'
+		<< data_pack::get_data_fingerprint() << '\n'
+		<< seed << '\n'
+		<< normalized_options;
+	const std::string text = key_text.str();
+
+	// 64-bit FNV-1a.
+	std::uint64_t h = 14695981039346656037ull;
+	for (const char c : text)
+	{
+		h ^= static_cast<unsigned char>(c);
+		h *= 1099511628211ull;
+	}
+
+	char hex[17];
+	std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(h));
+	return hex;
+}
+
+bool mission_cache::fetch(const std::string& key, const std::string& popfile_name, int argc, char** argv) const
+{
+	const std::filesystem::path entry = get_entry(key);
+	std::error_code ec;
+	if (!std::filesystem::is_regular_file(entry, ec))
+	{
+		return false;
+	}
+
+	// The modification time of an entry doubles as the last time it was used.
+	std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), ec);
+
+	// The header is the comments and blank lines before the WaveSchedule. Everything after it is copied as it is.
+	std::ifstream cached(entry, std::ios::binary);
+	std::string line;
+	std::streampos body_start = cached.tellg();
+	while (std::getline(cached, line) && (line.empty() || line == "\r" || line.compare(0, 2, "//") == 0))
+	{
+		body_start = cached.tellg();
+	}
+	cached.clear();
+	cached.seekg(body_start);
+
+	popfile_writer writer;
+	writer.popfile_open(popfile_name);
+	writer.write_popfile_header(wave_generator::get_version(), argc, argv);
+	writer.popfile_copy_write(cached);
+	writer.popfile_close();
+	return true;
+}
+
+void mission_cache::store(const std::string& key, const std::string& popfile_name) const
+{
+	// Stage the entry under a name of its own, so that another thread storing the same key can't leave half an entry behind.
+	std::stringstream staged_name;
+	staged_name << key << '.' << std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+	const std::filesystem::path staged = directory / staged_name.str();
+
+	place(popfile_name, staged);
+	std::filesystem::rename(staged, get_entry(key));
+
+	evict();
+}
+
+std::filesystem::path mission_cache::get_entry(const std::string& key) const
+{
+	return directory / (key + ".pop");
+}
+
+void mission_cache::place(const std::filesystem::path& from, const std::filesystem::path& to)
+{
+	std::error_code ec;
+	std::filesystem::remove(to, ec);
+	std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing);
+}
+
+void mission_cache::evict() const
+{
+	struct entry_info
+	{
+		std::filesystem::path path;
+		std::uintmax_t size;
+		std::filesystem::file_time_type last_used;
+	};
+
+	std::vector<entry_info> entries;
+	std::uintmax_t total = 0;
+	std::error_code ec;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory))
+	{
+		if (entry.is_regular_file(ec) && entry.path().extension() == ".pop")
+		{
+			entries.push_back({ entry.path(), entry.file_size(ec), entry.last_write_time(ec) });
+			total += entries.back().size;
+		}
+	}
+
+	if (total <= max_bytes)
+	{
+		return;
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const entry_info& a, const entry_info& b)
+	{
+		return a.last_used < b.last_used;
+	});
+	for (const entry_info& entry : entries)
+	{
+		if (total <= max_bytes)
+		{
+			break;
+		}
+		if (std::filesystem::remove(entry.path, ec))
+		{
+			total -= entry.size;
+		}
+	}
+}
\ No newline at end of file
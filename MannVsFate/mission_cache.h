@@ -0,0 +1,41 @@
+// An on-disk cache of generated popfiles, keyed by everything that decides a seeded mission's contents:
+// the data files, the generator version, the normalized options and the seed.
+// Entries are copied to where the popfile is wanted, and the least recently used entries are removed once the cache grows past its size limit.
+
+#ifndef MISSION_CACHE_H
+#define MISSION_CACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+class mission_cache
+{
+public:
+	// Constructor. Creates the cache directory if it doesn't exist.
+	mission_cache(const std::string& directory, std::uintmax_t max_bytes);
+
+	// Make the key of a mission from its normalized options and its seed.
+	static std::string make_key(const std::string& normalized_options, unsigned int seed);
+
+	// Put the cached popfile for a key at popfile_name. Returns false if the cache doesn't have the key.
+	// The entry's header is replaced with one listing argc and argv, since the options that don't change the mission, like -name, may differ.
+	bool fetch(const std::string& key, const std::string& popfile_name, int argc, char** argv) const;
+	// Add a generated popfile to the cache, then remove old entries if the cache is too big.
+	void store(const std::string& key, const std::string& popfile_name) const;
+
+private:
+	// Get the file of a cache entry.
+	std::filesystem::path get_entry(const std::string& key) const;
+	// Copy from to to, replacing whatever is at to.
+	static void place(const std::filesystem::path& from, const std::filesystem::path& to);
+	// Remove the least recently used entries until the cache fits in its size limit.
+	void evict() const;
+
+	// The directory that holds the entries.
+	std::filesystem::path directory;
+	// The most bytes that the entries can take up.
+	std::uintmax_t max_bytes;
+};
+
+#endif
\ No newline at end of file
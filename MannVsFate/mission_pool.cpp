@@ -0,0 +1,208 @@
+#include "mission_pool.h"
+#include "popfile_generator.h"
+#include "json.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// The name of the folder in each profile's folder that missions are generated in before they're ready.
+	const std::string staging_folder = ".staging";
+
+	// Make the calling thread yield to everything else, so that refilling the pool doesn't slow down a running game server.
+	void lower_thread_priority()
+	{
+#ifdef _WIN32
+		SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+		// On Linux, nice values belong to threads rather than processes.
+		setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#endif
+	}
+}
+
+mission_pool::mission_pool(const std::string& config_filename, generator_data& data, unsigned int worker_count)
+	: data(data), size(0), stopping(false), mission_count(0)
+{
+	std::ifstream config_file(config_filename);
+	if (!config_file)
+	{
+		const std::string exstr = "mission_pool exception: Couldn't find pool file \"" + config_filename + "\".";
+		throw std::exception(exstr.c_str());
+	}
+
+	nlohmann::json config;
+	try
+	{
+		config_file >> config;
+		directory = config.at("directory").get<std::string>();
+		size = config.at("size").get<unsigned int>();
+		for (const nlohmann::json& profile_node : config.at("profiles"))
+		{
+			profiles.emplace_back();
+			profile& prof = profiles.back();
+			prof.name = profile_node.at("name").get<std::string>();
+			prof.args = profile_node.at("args").get<std::vector<std::string>>();
+		}
+	}
+	catch (const std::exception& e)
+	{
+		const std::string exstr = "mission_pool exception: " + config_filename + " needs a directory, a size and a list of profiles with names and args. " + e.what();
+		throw std::exception(exstr.c_str());
+	}
+
+	for (profile& prof : profiles)
+	{
+		prof.directory = (std::filesystem::path(directory) / prof.name).string();
+		// Anything left in the staging folder was cut off by the last shutdown.
+		std::filesystem::remove_all(std::filesystem::path(prof.directory) / staging_folder);
+		std::filesystem::create_directories(std::filesystem::path(prof.directory) / staging_folder);
+	}
+
+	if (worker_count == 0)
+	{
+		worker_count = 1;
+	}
+	for (unsigned int i = 0; i < worker_count; ++i)
+	{
+		workers.emplace_back(&mission_pool::work, this);
+	}
+}
+
+mission_pool::~mission_pool()
+{
+	{
+		std::lock_guard<std::mutex> lock(jobs_mutex);
+		stopping = true;
+	}
+	jobs_ready.notify_all();
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void mission_pool::run()
+{
+	std::cout << "Keeping " << size << " missions ready for each of " << profiles.size() << " profiles in " << directory << '.' << std::endl;
+
+	while (true)
+	{
+		refill();
+		// Consumed popfiles are noticed by polling, since that works the same everywhere.
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+	}
+}
+
+unsigned int mission_pool::count_ready(const profile& prof) const
+{
+	unsigned int count = 0;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(prof.directory))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == ".pop")
+		{
+			++count;
+		}
+	}
+	return count;
+}
+
+void mission_pool::refill()
+{
+	unsigned int queued = 0;
+	{
+		std::lock_guard<std::mutex> lock(jobs_mutex);
+		for (profile& prof : profiles)
+		{
+			if (prof.broken)
+			{
+				continue;
+			}
+			for (unsigned int have = count_ready(prof) + prof.pending; have < size; ++have)
+			{
+				++prof.pending;
+				jobs.emplace_back(&prof);
+				++queued;
+			}
+		}
+	}
+	if (queued != 0)
+	{
+		jobs_ready.notify_all();
+	}
+}
+
+void mission_pool::work()
+{
+	lower_thread_priority();
+
+	while (true)
+	{
+		profile* prof;
+		{
+			std::unique_lock<std::mutex> lock(jobs_mutex);
+			jobs_ready.wait(lock, [this]() { return stopping || !jobs.empty(); });
+			if (stopping)
+			{
+				return;
+			}
+			prof = jobs.front();
+			jobs.pop_front();
+		}
+
+		try
+		{
+			generate(*prof);
+		}
+		catch (const std::exception& e)
+		{
+			std::cout << "Couldn't generate a mission for " << prof->name << ", so it won't be refilled: " << e.what() << std::endl;
+			prof->broken = true;
+		}
+		catch (const char* e)
+		{
+			std::cout << "Couldn't generate a mission for " << prof->name << ", so it won't be refilled: " << e << std::endl;
+			prof->broken = true;
+		}
+		--prof->pending;
+	}
+}
+
+void mission_pool::generate(profile& prof)
+{
+	// Build an argument list just like the one the program gets from the command line.
+	std::vector<std::string> args{ "MannVsFate" };
+	args.insert(args.end(), prof.args.begin(), prof.args.end());
+	std::vector<char*> argv;
+	for (std::string& arg : args)
+	{
+		argv.emplace_back(&arg[0]);
+	}
+	argv.emplace_back(nullptr);
+	const int argc = static_cast<int>(args.size());
+
+	// The time keeps names unique across restarts, and the count keeps them unique within a second.
+	const long long seconds = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	const std::string mission_name = prof.name + '_' + std::to_string(seconds) + '_' + std::to_string(mission_count++);
+
+	popfile_generator popgen(data);
+	popgen.apply_arguments(argc, argv.data());
+	popgen.set_mission_name(mission_name);
+	popgen.set_output_directory((std::filesystem::path(prof.directory) / staging_folder).string());
+	const std::filesystem::path staged = popgen.generate(argc, argv.data());
+
+	// Renaming within the same folder tree is atomic, so a popfile is never seen half written.
+	std::filesystem::rename(staged, std::filesystem::path(prof.directory) / staged.filename());
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+// Keeps a pool of ready-to-play popfiles for each of several mission profiles, so that a map change never has to wait for generation.
+// The pool is configured with a JSON file:
+//   {
+//     "directory" : "pool",
+//     "size" : 3,
+//     "profiles" : [ { "name" : "bigrock_4", "args" : ["-map", "mvm_bigrock", "-players", "4", "-difficulty", "3"] } ]
+//   }
+// Each profile gets its own folder in the directory. Taking a popfile out of a folder (moving or deleting it) consumes it,
+// and a low priority background thread generates a replacement. Popfiles only appear in a folder once they're complete.
+
+#ifndef MISSION_POOL_H
+#define MISSION_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class generator_data;
+
+class mission_pool
+{
+public:
+	// Constructor. Reads the pool configuration and creates the profile folders.
+	// The data must outlive the pool.
+	mission_pool(const std::string& config_filename, generator_data& data, unsigned int worker_count);
+	// Destructor.
+	~mission_pool();
+
+	// Watch the pool and refill it until the process is stopped.
+	void run();
+
+private:
+	// A kind of mission to keep in the pool.
+	struct profile
+	{
+		// The name of the profile, which is also the name of its folder.
+		std::string name;
+		// The command line arguments to generate the profile's missions with.
+		std::vector<std::string> args;
+		// The folder that the profile's ready popfiles are in.
+		std::string directory;
+		// The number of the profile's missions being generated right now.
+		std::atomic<unsigned int> pending{ 0 };
+		// Set once generating one of the profile's missions fails, since its arguments will keep failing.
+		std::atomic<bool> broken{ false };
+	};
+
+	// Count the ready popfiles of a profile.
+	unsigned int count_ready(const profile& prof) const;
+	// Queue enough missions to bring every profile back up to the pool size.
+	void refill();
+	// Take profiles off the queue and generate a mission for each.
+	void work();
+	// Generate one mission for a profile and move it into the profile's folder once it's complete.
+	void generate(profile& prof);
+
+	// The data that the generators only read, shared by every mission.
+	generator_data& data;
+	// The directory that holds every profile's folder.
+	std::string directory;
+	// How many ready popfiles to keep for each profile.
+	unsigned int size;
+	// The profiles.
+	std::deque<profile> profiles;
+
+	// Profiles waiting for a worker to generate a mission.
+	std::deque<profile*> jobs;
+	std::mutex jobs_mutex;
+	std::condition_variable jobs_ready;
+	// Set when the pool shuts down, so that the workers stop waiting for jobs.
+	bool stopping;
+	// The worker threads.
+	std::vector<std::thread> workers;
+	// Counts generated missions, so that each popfile gets a unique name.
+	std::atomic<unsigned int> mission_count;
+};
+
+#endif
\ No newline at end of file
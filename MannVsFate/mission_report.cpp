@@ -0,0 +1,169 @@
+#include "mission_report.h"
+#include "json.hpp"
+#include <algorithm>
+#include <fstream>
+
+namespace
+{
+	// The fraction of the robots that something is true of.
+	double ratio(int count, int robots)
+	{
+		return robots != 0 ? static_cast<double>(count) / robots : 0.0;
+	}
+
+	// The statistics that a wave and the whole mission have in common.
+	nlohmann::json stats_node(const mission_report::wave& w)
+	{
+		nlohmann::json classes = nlohmann::json::object();
+		for (int i = 0; i < player_class_count; ++i)
+		{
+			classes[player_class_to_string(static_cast<player_class>(i))] = w.classes.at(i);
+		}
+
+		nlohmann::json node;
+		node["duration"] = w.duration;
+		node["robot_health"] = w.robot_health;
+		node["tank_health"] = w.tank_health;
+		node["wavespawns"] = w.wavespawns;
+		node["peak_pressure"] = w.peak_pressure;
+		node["mean_pressure"] = w.mean_pressure;
+		node["currency_in"] = w.currency_in;
+		node["currency_out"] = w.currency_out;
+		node["currency_dropped"] = w.currency_dropped;
+		node["robots"] = w.robots;
+		node["giants"] = w.giants;
+		node["bosses"] = w.bosses;
+		node["tanks"] = w.tanks;
+		node["giant_ratio"] = ratio(w.giants, w.robots);
+		node["boss_ratio"] = ratio(w.bosses, w.robots);
+		node["classes"] = classes;
+		return node;
+	}
+}
+
+void mission_report::wave::add_robots(player_class cl, int count, int health, bool is_giant, bool is_boss)
+{
+	robot_health += static_cast<std::uint64_t>(health) * count;
+	robots += count;
+	if (is_giant)
+	{
+		giants += count;
+	}
+	if (is_boss)
+	{
+		bosses += count;
+	}
+	classes.at(static_cast<std::size_t>(cl)) += count;
+}
+
+void mission_report::wave::add_tanks(int count, int health)
+{
+	tank_health += static_cast<std::uint64_t>(health) * count;
+	tanks += count;
+}
+
+void mission_report::read(const std::string& filename)
+{
+	std::ifstream file(filename);
+	if (!file)
+	{
+		const std::string exstr = "mission_report::read exception: Couldn't read the report \"" + filename + "\".";
+		throw std::exception(exstr.c_str());
+	}
+	const nlohmann::json report = nlohmann::json::parse(file);
+
+	// The ratios and the mission totals are worked out again when the report is written.
+	for (const nlohmann::json& node : report.at("waves"))
+	{
+		wave w;
+		w.number = node.at("number").get<int>();
+		w.duration = node.at("duration").get<int>();
+		w.robot_health = node.at("robot_health").get<std::uint64_t>();
+		w.tank_health = node.at("tank_health").get<std::uint64_t>();
+		w.wavespawns = node.at("wavespawns").get<int>();
+		w.icons = node.at("icons").get<int>();
+		w.peak_pressure = node.at("peak_pressure").get<float>();
+		w.mean_pressure = node.at("mean_pressure").get<float>();
+		w.currency_in = node.at("currency_in").get<int>();
+		w.currency_out = node.at("currency_out").get<int>();
+		w.currency_dropped = node.at("currency_dropped").get<int>();
+		w.robots = node.at("robots").get<int>();
+		w.giants = node.at("giants").get<int>();
+		w.bosses = node.at("bosses").get<int>();
+		w.tanks = node.at("tanks").get<int>();
+		const nlohmann::json& classes = node.at("classes");
+		for (int i = 0; i < player_class_count; ++i)
+		{
+			w.classes.at(i) = classes.at(player_class_to_string(static_cast<player_class>(i))).get<int>();
+		}
+		record_wave(w);
+	}
+}
+
+void mission_report::write(const std::string& filename) const
+{
+	// The mission's totals. Its pressure is the peak over every wave and the mean over every simulated second.
+	wave total;
+	double pressure_seconds = 0.0;
+	nlohmann::json wave_nodes = nlohmann::json::array();
+	for (const std::pair<const int, wave>& recorded : waves)
+	{
+		const wave& w = recorded.second;
+		nlohmann::json node = stats_node(w);
+		node["number"] = w.number;
+		node["icons"] = w.icons;
+		wave_nodes.push_back(node);
+
+		total.duration += w.duration;
+		total.robot_health += w.robot_health;
+		total.tank_health += w.tank_health;
+		total.wavespawns += w.wavespawns;
+		total.peak_pressure = std::max(total.peak_pressure, w.peak_pressure);
+		pressure_seconds += static_cast<double>(w.mean_pressure) * w.duration;
+		total.currency_dropped += w.currency_dropped;
+		total.robots += w.robots;
+		total.giants += w.giants;
+		total.bosses += w.bosses;
+		total.tanks += w.tanks;
+		for (int i = 0; i < player_class_count; ++i)
+		{
+			total.classes.at(i) += w.classes.at(i);
+		}
+	}
+	if (!waves.empty())
+	{
+		total.currency_in = waves.begin()->second.currency_in;
+		total.currency_out = waves.rbegin()->second.currency_out;
+	}
+	if (total.duration != 0)
+	{
+		total.mean_pressure = static_cast<float>(pressure_seconds / total.duration);
+	}
+
+	nlohmann::json report;
+	report["mission"] = stats_node(total);
+	report["waves"] = wave_nodes;
+
+	std::ofstream file(filename);
+	if (!file)
+	{
+		const std::string exstr = "mission_report::write exception: Couldn't write the report \"" + filename + "\".";
+		throw std::exception(exstr.c_str());
+	}
+	file << report.dump(1) << std::endl;
+}
+
+void mission_report::record_wave(const wave& w)
+{
+	waves[w.number] = w;
+}
+
+std::string mission_report::get_report_filename(const std::string& popfile_name)
+{
+	const std::string extension = ".pop";
+	if (popfile_name.size() >= extension.size() && popfile_name.compare(popfile_name.size() - extension.size(), extension.size(), extension) == 0)
+	{
+		return popfile_name.substr(0, popfile_name.size() - extension.size()) + "_report.json";
+	}
+	return popfile_name + "_report.json";
+}
\ No newline at end of file
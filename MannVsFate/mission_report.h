@@ -0,0 +1,70 @@
+// A summary of a mission's waves, written as JSON next to its popfile.
+// The statistics are gathered while each wave is generated, so nothing has to read the popfile back to get them.
+
+#ifndef MISSION_REPORT_H
+#define MISSION_REPORT_H
+
+#include "player_class.h"
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+
+class mission_report
+{
+public:
+	// The statistics of one wave. The Sentry Buster isn't counted.
+	struct wave
+	{
+		// The number of the wave, starting from 1.
+		int number = 0;
+		// How many seconds the simulated wave lasts.
+		int duration = 0;
+		// The total health of every robot in the wave.
+		std::uint64_t robot_health = 0;
+		// The total health of every tank in the wave.
+		std::uint64_t tank_health = 0;
+		// How many WaveSpawns the wave has, not counting the sounds.
+		int wavespawns = 0;
+		// How many different icons the wave has.
+		int icons = 0;
+		// The highest and the mean pressure after each simulated second, measured in seconds of pressure decay.
+		float peak_pressure = 0.0f;
+		float mean_pressure = 0.0f;
+		// How much currency the players have when the wave starts.
+		int currency_in = 0;
+		// How much currency the players have when the wave ends.
+		int currency_out = 0;
+		// How much currency the wave's WaveSpawns drop.
+		int currency_dropped = 0;
+		// How many robots and tanks the wave spawns.
+		int robots = 0;
+		int giants = 0;
+		int bosses = 0;
+		int tanks = 0;
+		// How many robots of each class the wave spawns, indexed by player_class.
+		std::array<int, player_class_count> classes = {};
+
+		// Count a WaveSpawn of robots.
+		void add_robots(player_class cl, int count, int health, bool is_giant, bool is_boss);
+		// Count a WaveSpawn of tanks.
+		void add_tanks(int count, int health);
+	};
+
+	// Read a report written before. Throws if it can't be read.
+	void read(const std::string& filename);
+	// Write the report. Throws if it can't be written.
+	void write(const std::string& filename) const;
+
+	// Record a wave, replacing the wave with the same number if it was already recorded.
+	void record_wave(const wave& w);
+
+	// Get the file name that the report of a popfile is written to.
+	static std::string get_report_filename(const std::string& popfile_name);
+
+private:
+	// The recorded waves, by number.
+	std::map<int, wave> waves;
+};
+
+#endif
\ No newline at end of file
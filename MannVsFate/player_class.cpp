@@ -89,4 +89,9 @@ std::string get_class_icon(const player_class cl)
 	{
 		return player_class_to_string(cl);
 	}
+}
+
+int player_class_flag(const player_class cl)
+{
+	return 1 << static_cast<int>(cl);
 }
\ No newline at end of file
@@ -16,6 +16,9 @@ enum class player_class
 	spy
 };
 
+// The number of classes in the player_class enum.
+constexpr int player_class_count = 9;
+
 std::string player_class_to_string(const player_class cl);
 
 player_class get_random_class();
@@ -26,4 +29,7 @@ int get_class_default_health(const player_class cl);
 // Returns a class icon for MVM based on a given class.
 std::string get_class_icon(const player_class cl);
 
+// Returns the bit representing a given class in a class bitfield (such as the one given to -classes).
+int player_class_flag(const player_class cl);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,517 @@
+#include "popfile_generator.h"
+#include "class_table.h"
+#include "mission_cache.h"
+#include "rand_util.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+	// Read a whole file. A file that can't be read is empty.
+	std::string read_contents(const char* filename)
+	{
+		std::ifstream file(filename, std::ios::binary);
+		std::stringstream contents;
+		contents << file.rdbuf();
+		return contents.str();
+	}
+}
+
+popfile_generator::popfile_generator(generator_data& data)
+	: data(data),
+	cache_size(256 * 1024 * 1024),
+	pm(cm),
+	botgen(pm, data),
+	tankgen(pm),
+	gen(cm, pm, botgen, tankgen, data)
+{}
+
+void popfile_generator::apply_arguments(int argc, char** argv)
+{
+	numeric_values.clear();
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "-map") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_map_name(argv[i]);
+			continue;
+		}
+		if (std::strcmp(argv[i], "-name") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_mission_name(argv[i]);
+			continue;
+		}
+		if (std::strcmp(argv[i], "-startingcurrency") == 0)
+		{
+			next_argument(argc, argv, i);
+			cm.set_currency(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-waves") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_waves(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-respawnwavetime") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_respawn_wave_time(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-halloween") == 0)
+		{
+			gen.set_event_popfile(1);
+			continue;
+		}
+		if (std::strcmp(argv[i], "-fixedrespawnwavetime") == 0)
+		{
+			gen.set_fixed_respawn_wave_time(true);
+			continue;
+		}
+		if (std::strcmp(argv[i], "-busterdamagethreshold") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_add_sentry_buster_when_damage_dealt_exceeds(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-busterkillthreshold") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_add_sentry_buster_when_kill_count_exceeds(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-botspawnattack") == 0)
+		{
+			gen.set_can_bots_attack_while_in_spawn_room(true);
+			continue;
+		}
+		if (std::strcmp(argv[i], "-bustercooldown") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_sentry_buster_cooldown(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-players") == 0)
+		{
+			next_argument(argc, argv, i);
+			pm.set_players(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-wavecurrency") == 0)
+		{
+			next_argument(argc, argv, i);
+			cm.set_currency_per_wave(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-time") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_max_time(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-tankchance") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_tank_chance(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-icons") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_max_icons(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-wavespawns") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_max_wavespawns(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-classes") == 0)
+		{
+			next_argument(argc, argv, i);
+			// Bit n of the bitfield enables the class with index n in the player_class enum.
+			botgen.set_possible_classes(class_table(read_int(argv, i)));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-botmaxtime") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_max_tfbot_wavespawn_time(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-tankmaxtime") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_max_tank_wavespawn_time(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-difficulty") == 0)
+		{
+			next_argument(argc, argv, i);
+			pm.set_pressure_decay_rate_multiplier_in_time(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-giantchance") == 0)
+		{
+			next_argument(argc, argv, i);
+			botgen.set_giant_chance(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-bosschance") == 0)
+		{
+			next_argument(argc, argv, i);
+			botgen.set_boss_chance(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-giantchanceincrease") == 0)
+		{
+			next_argument(argc, argv, i);
+			botgen.set_giant_chance_increase(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-bosschanceincrease") == 0)
+		{
+			next_argument(argc, argv, i);
+			botgen.set_boss_chance_increase(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-currencyspread") == 0)
+		{
+			next_argument(argc, argv, i);
+			cm.set_currency_per_wave_spread(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-wackysounds") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_use_wacky_sounds(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-wackyvoratio") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_wacky_sound_vo_ratio(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-wavespawncurrency") == 0)
+		{
+			next_argument(argc, argv, i);
+			cm.set_currency_per_wavespawn(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-wavespawncurrencyspread") == 0)
+		{
+			next_argument(argc, argv, i);
+			cm.set_currency_per_wavespawn_spread(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-wavespawncurrencylimit") == 0)
+		{
+			next_argument(argc, argv, i);
+			cm.set_currency_per_wavespawn_limit(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-doombot") == 0)
+		{
+			gen.set_doombot_enabled(true);
+			continue;
+		}
+		if (std::strcmp(argv[i], "-cosmetics") == 0)
+		{
+			botgen.set_give_bots_cosmetics(true);
+			continue;
+		}
+		if (std::strcmp(argv[i], "-bothp") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_force_tfbot_hp(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-tankhp") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_force_tank_hp(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-tankspeed") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_force_tank_speed(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-firechance") == 0)
+		{
+			next_argument(argc, argv, i);
+			botgen.set_fire_chance(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-bleedchance") == 0)
+		{
+			next_argument(argc, argv, i);
+			botgen.set_bleed_chance(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-bleedforall") == 0)
+		{
+			botgen.set_nonbosses_can_get_bleed(true);
+			continue;
+		}
+		if (std::strcmp(argv[i], "-botscalechance") == 0)
+		{
+			next_argument(argc, argv, i);
+			botgen.set_bot_scale_chance(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-minimumbotscale") == 0)
+		{
+			next_argument(argc, argv, i);
+			botgen.set_minimum_bot_scale(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-maximumbotscale") == 0)
+		{
+			next_argument(argc, argv, i);
+			botgen.set_maximum_bot_scale(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-minimumgiantscale") == 0)
+		{
+			next_argument(argc, argv, i);
+			botgen.set_minimum_giant_scale(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-forcebotscale") == 0)
+		{
+			next_argument(argc, argv, i);
+			botgen.set_force_bot_scale(read_float(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-rerollwave") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_reroll_wave(read_int(argv, i));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-candidates") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_candidates(std::max(1, read_int(argv, i)));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-wavespawncandidates") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_wavespawn_candidates(std::max(1, read_int(argv, i)));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-scoring") == 0)
+		{
+			next_argument(argc, argv, i);
+			gen.set_scoring_filename(argv[i]);
+			continue;
+		}
+		if (std::strcmp(argv[i], "-stats") == 0)
+		{
+			gen.set_print_stats(true);
+			continue;
+		}
+		if (std::strcmp(argv[i], "-report") == 0)
+		{
+			gen.set_write_report(true);
+			continue;
+		}
+		if (std::strcmp(argv[i], "-seed") == 0)
+		{
+			next_argument(argc, argv, i);
+			seed = std::make_unique<unsigned int>(static_cast<unsigned int>(std::stoul(argv[i])));
+			continue;
+		}
+		if (std::strcmp(argv[i], "-cache") == 0)
+		{
+			next_argument(argc, argv, i);
+			cache_directory = argv[i];
+			continue;
+		}
+		if (std::strcmp(argv[i], "-cachesize") == 0)
+		{
+			next_argument(argc, argv, i);
+			cache_size = static_cast<std::uintmax_t>(std::stoull(argv[i])) * 1024 * 1024;
+			continue;
+		}
+	}
+
+	normalized_options = normalize_arguments(argc, argv, numeric_values);
+}
+
+void popfile_generator::set_mission_name(const std::string& in)
+{
+	gen.set_mission_name(in);
+}
+
+void popfile_generator::set_output_directory(const std::string& in)
+{
+	gen.set_output_directory(in);
+}
+
+void popfile_generator::set_measure_output(bool in)
+{
+	gen.set_measure_output(in);
+}
+
+std::string popfile_generator::get_popfile_name() const
+{
+	return gen.get_popfile_name();
+}
+
+int popfile_generator::get_reroll_wave() const
+{
+	return gen.get_reroll_wave();
+}
+
+std::string popfile_generator::generate(int argc, char** argv)
+{
+	if (seed == nullptr)
+	{
+		return generate_uncached(argc, argv);
+	}
+
+	rand_seed(*seed);
+
+	// A rerolled wave is spliced into whatever popfile is already there, so the result can't be cached.
+	// The report is gathered while generating, so a mission taken from the cache wouldn't have one.
+	if (cache_directory.empty() || gen.get_reroll_wave() != 0 || gen.get_write_report())
+	{
+		return generate_uncached(argc, argv);
+	}
+
+	// A seeded mission is the same every time, so it only needs to be generated once.
+	const mission_cache cache(cache_directory, cache_size);
+	const std::string key = mission_cache::make_key(normalized_options, *seed);
+	const std::string popfile_name = gen.get_popfile_name();
+	if (cache.fetch(key, popfile_name, argc, argv))
+	{
+		std::cout << "Took the mission from the cache." << std::endl;
+		return popfile_name;
+	}
+
+	generate_uncached(argc, argv);
+	cache.store(key, popfile_name);
+	return popfile_name;
+}
+
+std::vector<wave_generator::wave_summary> popfile_generator::simulate()
+{
+	return gen.simulate_mission();
+}
+
+std::string popfile_generator::generate_uncached(int argc, char** argv)
+{
+	// Each thread that generates candidate waves needs generators of its own, since generating changes their state.
+	std::vector<std::unique_ptr<popfile_generator>> helpers;
+	const unsigned int threads = std::min(gen.get_candidates(), std::max(1u, std::thread::hardware_concurrency()));
+	for (unsigned int i = 1; i < threads; ++i)
+	{
+		helpers.emplace_back(std::make_unique<popfile_generator>(data));
+		helpers.back()->apply_arguments(argc, argv);
+		gen.add_candidate_generator(helpers.back()->gen);
+	}
+
+	return gen.generate_mission(argc, argv);
+}
+
+std::string popfile_generator::normalize_arguments(int argc, char** argv, const std::map<std::string, std::string>& numeric_values)
+{
+	// These only decide where the popfile goes or how the program runs, not what's in the popfile.
+	// The seed is left out because it's part of the cache key by itself.
+	static const std::set<std::string> ignored{ "-name", "-seed", "-cache", "-cachesize", "-pack", "-serve", "-pool", "-workers", "-profile", "-trace", "-allocations", "-stats", "-report" };
+
+	// Negative numbers are values rather than options.
+	const auto is_option = [](const char* arg)
+	{
+		return arg[0] == '-' && std::isalpha(static_cast<unsigned char>(arg[1]));
+	};
+
+	std::map<std::string, std::string> options;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!is_option(argv[i]))
+		{
+			continue;
+		}
+		const std::string option = argv[i];
+
+		std::string value;
+		while (i + 1 < argc && !is_option(argv[i + 1]))
+		{
+			++i;
+			value += argv[i];
+			value += ' ';
+		}
+
+		// A number is described by the value it was read as, since the same value can be typed in several ways.
+		const auto numeric_value = numeric_values.find(option);
+		if (numeric_value != numeric_values.end())
+		{
+			value = numeric_value->second;
+		}
+
+		// The scoring weights change the popfile without their file name changing, so the file's contents are part of the option.
+		if (option == "-scoring" && !value.empty())
+		{
+			value += read_contents(argv[i]);
+		}
+
+		if (ignored.count(option) == 0)
+		{
+			options[option] = value;
+		}
+	}
+
+	std::string normalized;
+	for (const std::pair<const std::string, std::string>& option : options)
+	{
+		normalized += option.first + ' ' + option.second + '\n';
+	}
+	return normalized;
+}
+
+int popfile_generator::read_int(char** argv, int i)
+{
+	const int value = std::stoi(argv[i]);
+	numeric_values[argv[i - 1]] = std::to_string(value);
+	return value;
+}
+
+float popfile_generator::read_float(char** argv, int i)
+{
+	const float value = std::stof(argv[i]);
+	// 9 significant digits are enough to tell any two floats apart.
+	char formatted[32];
+	std::snprintf(formatted, sizeof(formatted), "%.9g", value);
+	numeric_values[argv[i - 1]] = formatted;
+	return value;
+}
+
+void popfile_generator::next_argument(int argc, char** argv, int& i)
+{
+	if (i + 1 >= argc)
+	{
+		const std::string exstr = "popfile_generator exception: The argument " + std::string(argv[i]) + " needs a value!";
+		throw std::exception(exstr.c_str());
+	}
+	++i;
+}
\ No newline at end of file
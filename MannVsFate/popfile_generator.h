@@ -0,0 +1,86 @@
+#ifndef POPFILE_GENERATOR_H
+#define POPFILE_GENERATOR_H
+
+#include "currency_manager.h"
+#include "pressure_manager.h"
+#include "generator_data.h"
+#include "bot_generator.h"
+#include "tank_generator.h"
+#include "wave_generator.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The wave generator together with all of its dependencies, configured through command line arguments.
+// Each instance generates one mission, since generating a mission changes the state of the generators.
+// The data that the generators only read is borrowed, so any number of instances can share it.
+class popfile_generator
+{
+public:
+	// Constructor. The data must outlive the popfile generator.
+	explicit popfile_generator(generator_data& data);
+
+	// Apply command line arguments to the generators. argv[0] is skipped, since it's the program name.
+	// Unknown arguments are ignored. Throws if an argument is missing its value.
+	void apply_arguments(int argc, char** argv);
+
+	// Override the name of the mission.
+	void set_mission_name(const std::string& in);
+	// Set the directory to write the popfile to.
+	void set_output_directory(const std::string& in);
+	// Have simulate() still format the popfile, only counting its bytes instead of writing them.
+	void set_measure_output(bool in);
+	// Get the file name that the popfile will be written to with the current settings.
+	std::string get_popfile_name() const;
+	// Get the wave that is being rerolled. 0 if the whole mission is generated.
+	int get_reroll_wave() const;
+
+	// Generate the mission. argc and argv are taken only to be printed in the mission file as debug info.
+	// If the mission is seeded and a cache directory is set, the popfile is taken from the cache when possible.
+	// Returns the file name of the popfile.
+	std::string generate(int argc, char** argv);
+
+	// Generate the mission without writing anything, and measure each of its waves.
+	std::vector<wave_generator::wave_summary> simulate();
+
+private:
+	// Move on to the value of the argument at i, throwing if there isn't one.
+	static void next_argument(int argc, char** argv, int& i);
+
+	// Read the value at i as a number, and record it as the value of the option before it.
+	int read_int(char** argv, int i);
+	float read_float(char** argv, int i);
+
+	// Turn arguments into a canonical description of the options that affect a mission's contents.
+	// Options are sorted, later values of an option replace earlier ones, and options that were read as numbers are described by the numbers they were read as.
+	// Options that name a file of settings, like -scoring, include the file's contents.
+	static std::string normalize_arguments(int argc, char** argv, const std::map<std::string, std::string>& numeric_values);
+
+	// Generate the mission without looking in the mission cache.
+	// If several candidates are generated for each wave, a helper set of generators borrowing the same data is made for each extra thread that generates them.
+	std::string generate_uncached(int argc, char** argv);
+
+	// The data shared by the generators, which helpers are constructed with.
+	generator_data& data;
+
+	// If the pointed value exists, the random number generator is seeded with it before generating.
+	std::unique_ptr<unsigned int> seed;
+	// The directory of the mission cache. Empty if missions aren't cached.
+	std::string cache_directory;
+	// The most bytes the mission cache can take up.
+	std::uintmax_t cache_size;
+	// The value of each option that was read as a number, written the way that it was read.
+	std::map<std::string, std::string> numeric_values;
+	// The normalized options, which are part of the mission cache key.
+	std::string normalized_options;
+
+	currency_manager cm;
+	pressure_manager pm;
+	bot_generator botgen;
+	tank_generator tankgen;
+	wave_generator gen;
+};
+
+#endif
\ No newline at end of file
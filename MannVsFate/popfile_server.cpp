@@ -0,0 +1,313 @@
+#include "popfile_server.h"
+#include "popfile_generator.h"
+#include "mission_report.h"
+#include "time_util.h"
+#include "json.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+popfile_server::popfile_server(const std::string& socket_path, generator_data& data, unsigned int worker_count)
+	: socket_path(socket_path), data(data), listener(-1), stopping(false), request_count(0)
+{
+	throw std::exception("popfile_server exception: -serve needs Unix domain sockets, which aren't supported on Windows.");
+}
+
+popfile_server::~popfile_server() {}
+
+void popfile_server::run() {}
+
+void popfile_server::work() {}
+
+void popfile_server::serve_connection(int connection) {}
+
+#else
+
+popfile_server::popfile_server(const std::string& socket_path, generator_data& data, unsigned int worker_count)
+	: socket_path(socket_path), data(data), listener(-1), stopping(false), request_count(0)
+{
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if (socket_path.size() >= sizeof(address.sun_path))
+	{
+		const std::string exstr = "popfile_server exception: The socket path \"" + socket_path + "\" is too long.";
+		throw std::exception(exstr.c_str());
+	}
+	std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+	listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener == -1)
+	{
+		throw std::exception("popfile_server exception: Couldn't create a socket.");
+	}
+
+	// A socket file left behind by a server that didn't shut down cleanly would make bind fail.
+	unlink(socket_path.c_str());
+	if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1 || listen(listener, SOMAXCONN) == -1)
+	{
+		close(listener);
+		const std::string exstr = "popfile_server exception: Couldn't listen on \"" + socket_path + "\".";
+		throw std::exception(exstr.c_str());
+	}
+
+	// A client that hangs up before reading its reply shouldn't take the server down with it.
+	std::signal(SIGPIPE, SIG_IGN);
+
+	// The process ID keeps servers in the same working directory out of each other's staging folders.
+	staging_directory = ".serve_staging_" + std::to_string(getpid());
+	std::filesystem::remove_all(staging_directory);
+	std::filesystem::create_directories(staging_directory);
+
+	if (worker_count == 0)
+	{
+		worker_count = 1;
+	}
+	for (unsigned int i = 0; i < worker_count; ++i)
+	{
+		workers.emplace_back(&popfile_server::work, this);
+	}
+}
+
+popfile_server::~popfile_server()
+{
+	{
+		std::lock_guard<std::mutex> lock(connections_mutex);
+		stopping = true;
+	}
+	connections_ready.notify_all();
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+	for (const int connection : connections)
+	{
+		close(connection);
+	}
+	close(listener);
+	unlink(socket_path.c_str());
+	std::error_code error;
+	std::filesystem::remove_all(staging_directory, error);
+}
+
+void popfile_server::run()
+{
+	std::cout << "Serving popfiles on " << socket_path << " with " << workers.size() << " workers." << std::endl;
+
+	while (true)
+	{
+		const int connection = accept(listener, nullptr, nullptr);
+		if (connection == -1)
+		{
+			if (errno == EINTR || errno == ECONNABORTED)
+			{
+				continue;
+			}
+			throw std::exception("popfile_server exception: Couldn't accept a connection.");
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(connections_mutex);
+			connections.emplace_back(connection);
+		}
+		connections_ready.notify_one();
+	}
+}
+
+void popfile_server::work()
+{
+	while (true)
+	{
+		int connection;
+		{
+			std::unique_lock<std::mutex> lock(connections_mutex);
+			connections_ready.wait(lock, [this]() { return stopping || !connections.empty(); });
+			if (stopping)
+			{
+				return;
+			}
+			connection = connections.front();
+			connections.pop_front();
+		}
+		serve_connection(connection);
+		close(connection);
+	}
+}
+
+void popfile_server::serve_connection(int connection)
+{
+	std::string pending;
+	char buffer[4096];
+
+	while (true)
+	{
+		const ssize_t received = recv(connection, buffer, sizeof(buffer), 0);
+		if (received <= 0)
+		{
+			return;
+		}
+		pending.append(buffer, received);
+
+		// Answer every complete line that has arrived so far.
+		std::size_t line_start = 0;
+		for (std::size_t newline = pending.find('\n'); newline != std::string::npos; newline = pending.find('\n', line_start))
+		{
+			const std::string line = pending.substr(line_start, newline - line_start);
+			line_start = newline + 1;
+			if (line.find_first_not_of(" \t\r") == std::string::npos)
+			{
+				continue;
+			}
+
+			const std::string reply = handle_request(line) + '\n';
+			for (std::size_t sent = 0; sent < reply.size();)
+			{
+				const ssize_t result = send(connection, reply.data() + sent, reply.size() - sent, 0);
+				if (result <= 0)
+				{
+					return;
+				}
+				sent += result;
+			}
+		}
+		pending.erase(0, line_start);
+	}
+}
+
+#endif
+
+std::string popfile_server::handle_request(const std::string& line)
+{
+	nlohmann::json reply;
+
+	try
+	{
+		nlohmann::json request;
+		try
+		{
+			request = nlohmann::json::parse(line);
+		}
+		catch (const std::exception&)
+		{
+			throw std::exception("popfile_server exception: The request isn't valid JSON.");
+		}
+
+		if (request.is_object() && request.count("id") != 0)
+		{
+			reply["id"] = request.at("id");
+		}
+
+		// Build an argument list just like the one the program gets from the command line.
+		std::vector<std::string> args{ "MannVsFate" };
+		std::string reply_mode = "path";
+		try
+		{
+			if (request.count("args") != 0)
+			{
+				const std::vector<std::string> request_args = request.at("args").get<std::vector<std::string>>();
+				args.insert(args.end(), request_args.begin(), request_args.end());
+			}
+			if (request.count("reply") != 0)
+			{
+				reply_mode = request.at("reply").get<std::string>();
+			}
+		}
+		catch (const std::exception&)
+		{
+			throw std::exception("popfile_server exception: \"args\" must be a list of strings and \"reply\" must be a string.");
+		}
+		if (reply_mode != "path" && reply_mode != "bytes")
+		{
+			throw std::exception("popfile_server exception: \"reply\" must be either \"path\" or \"bytes\".");
+		}
+
+		std::vector<char*> argv;
+		for (std::string& arg : args)
+		{
+			argv.emplace_back(&arg[0]);
+		}
+		argv.emplace_back(nullptr);
+		const int argc = static_cast<int>(args.size());
+
+		const auto start = std::chrono::steady_clock::now();
+
+		popfile_generator popgen(data);
+		popgen.apply_arguments(argc, argv.data());
+		const std::filesystem::path popfile_name = popgen.get_popfile_name();
+		const std::filesystem::path report_name = mission_report::get_report_filename(popfile_name.string());
+
+		// Requests with the same arguments generate the same popfile and the same temporary pieces,
+		// so each request is generated in a staging folder of its own and renamed into place when it's complete.
+		const std::filesystem::path staging = std::filesystem::path(staging_directory) / std::to_string(request_count++);
+		std::filesystem::create_directories(staging);
+		try
+		{
+			// A rerolled wave is spliced into the existing popfile and report, so those start out in the staging folder.
+			if (popgen.get_reroll_wave() != 0)
+			{
+				for (const std::filesystem::path& existing : { popfile_name, report_name })
+				{
+					if (std::filesystem::exists(existing))
+					{
+						std::filesystem::copy_file(existing, staging / existing.filename());
+					}
+				}
+			}
+			popgen.set_output_directory(staging.string());
+			const std::string staged_name = popgen.generate(argc, argv.data());
+
+			if (reply_mode == "bytes")
+			{
+				std::ifstream popfile(staged_name, std::ios::binary);
+				std::stringstream contents;
+				contents << popfile.rdbuf();
+				reply["popfile"] = contents.str();
+			}
+			else
+			{
+				// Renaming is atomic, so a popfile is never seen half written. The report is moved along with it.
+				for (const std::filesystem::directory_entry& staged : std::filesystem::directory_iterator(staging))
+				{
+					std::filesystem::rename(staged.path(), popfile_name.parent_path() / staged.path().filename());
+				}
+				reply["path"] = std::filesystem::absolute(popfile_name).string();
+			}
+		}
+		catch (...)
+		{
+			std::error_code error;
+			std::filesystem::remove_all(staging, error);
+			throw;
+		}
+		std::filesystem::remove_all(staging);
+
+		reply["ok"] = true;
+		reply["ms"] = milliseconds_between(start, std::chrono::steady_clock::now());
+	}
+	catch (const std::exception& e)
+	{
+		reply["ok"] = false;
+		reply["error"] = e.what();
+	}
+	catch (const char* e)
+	{
+		// Some of the JSON readers throw plain strings.
+		reply["ok"] = false;
+		reply["error"] = e;
+	}
+
+	return reply.dump();
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+// Serves popfiles over a local Unix domain socket, so that missions can be generated without paying for process startup each time.
+// Each request is one line of JSON:
+//   { "id" : <anything>, "args" : ["-map", "mvm_bigrock", "-players", "4"], "reply" : "path" or "bytes" }
+// The arguments are the same as the command line arguments. Each reply is one line of JSON, echoing the id:
+//   { "id" : <anything>, "ok" : true, "path" : "<popfile path>", "ms" : <generation time> }
+//   { "id" : <anything>, "ok" : true, "popfile" : "<popfile contents>", "ms" : <generation time> }
+//   { "id" : <anything>, "ok" : false, "error" : "<what went wrong>" }
+// Replying with the bytes removes the popfile after reading it.
+// Each request is generated in a staging folder of its own and then renamed into place, so requests for the same popfile don't write over each other.
+
+#ifndef POPFILE_SERVER_H
+#define POPFILE_SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class generator_data;
+
+class popfile_server
+{
+public:
+	// Constructor. Binds the socket, replacing any stale socket file at the same path.
+	// The data must outlive the server.
+	popfile_server(const std::string& socket_path, generator_data& data, unsigned int worker_count);
+	// Destructor.
+	~popfile_server();
+
+	// Accept connections until the process is stopped.
+	// Connections are handed to the worker threads, and each connection can send any number of requests.
+	void run();
+
+private:
+	// Take connections off the queue and serve them.
+	void work();
+	// Serve every request sent over a connection until it closes.
+	void serve_connection(int connection);
+	// Generate the mission a request line asks for and return the reply line.
+	std::string handle_request(const std::string& line);
+
+	// The path of the socket file.
+	std::string socket_path;
+	// The folder that requests are generated in before they're renamed into the working directory.
+	std::string staging_directory;
+	// The data that the generators only read, shared by every request.
+	generator_data& data;
+	// The listening socket.
+	int listener;
+
+	// Connections waiting for a worker.
+	std::deque<int> connections;
+	std::mutex connections_mutex;
+	std::condition_variable connections_ready;
+	// Set when the server shuts down, so that the workers stop waiting for connections.
+	bool stopping;
+	// The worker threads.
+	std::vector<std::thread> workers;
+	// Counts requests, so that each one gets a staging folder of its own.
+	std::atomic<unsigned int> request_count;
+};
+
+#endif
\ No newline at end of file
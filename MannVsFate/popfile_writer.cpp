@@ -2,9 +2,42 @@
 #include "tfbot.h"
 #include "tank.h"
 #include "spawnable.h"
+#include "allocation_tracker.h"
+#include "event_counters.h"
+
+popfile_writer::counting_buffer::counting_buffer()
+	: count(0)
+{
+	setp(scratch, scratch + sizeof(scratch));
+}
+
+std::uint64_t popfile_writer::counting_buffer::get_count() const
+{
+	return count + (pptr() - pbase());
+}
+
+popfile_writer::counting_buffer::int_type popfile_writer::counting_buffer::overflow(int_type c)
+{
+	count += pptr() - pbase();
+	setp(scratch, scratch + sizeof(scratch));
+	if (!traits_type::eq_int_type(c, traits_type::eof()))
+	{
+		++count;
+	}
+	return traits_type::not_eof(c);
+}
+
+std::streamsize popfile_writer::counting_buffer::xsputn(const char*, std::streamsize n)
+{
+	count += n;
+	return n;
+}
 
 void popfile_writer::popfile_open(const std::string& filename)
 {
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::writer_strings);
+	// Write through the file's own buffer again, in case the popfile was being measured.
+	popfile.std::ios::rdbuf(popfile.rdbuf());
 	popfile.open(filename);
 	if (!popfile)
 	{
@@ -15,7 +48,41 @@ void popfile_writer::popfile_open(const std::string& filename)
 
 void popfile_writer::popfile_close()
 {
+	// Count what was written, whether it went to the file or was only measured. A discarded popfile has no position.
+	if (popfile.std::ios::rdbuf() == popfile.rdbuf())
+	{
+		const std::streamoff written = popfile.tellp();
+		if (written > 0)
+		{
+			event_counters::add(event_counters::counter::bytes_written, static_cast<std::uint64_t>(written));
+		}
+	}
+	else
+	{
+		event_counters::add(event_counters::counter::bytes_written, measured.get_count() - measure_start);
+	}
+	popfile.close();
+}
+
+void popfile_writer::popfile_discard()
+{
+	// Writing to a stream in a bad state does nothing, not even formatting.
+	popfile.std::ios::rdbuf(popfile.rdbuf());
 	popfile.close();
+	popfile.setstate(std::ios::badbit);
+}
+
+void popfile_writer::popfile_measure()
+{
+	popfile.close();
+	// Pointing the stream at another buffer also clears its state.
+	popfile.std::ios::rdbuf(&measured);
+	measure_start = measured.get_count();
+}
+
+std::uint64_t popfile_writer::get_measured_bytes() const
+{
+	return measured.get_count();
 }
 
 void popfile_writer::popfile_copy_write(const std::string& filename)
@@ -24,6 +91,12 @@ void popfile_writer::popfile_copy_write(const std::string& filename)
 	popfile << in.rdbuf();
 }
 
+void popfile_writer::popfile_copy_write(std::istream& in)
+{
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::writer_strings);
+	popfile << in.rdbuf();
+}
+
 void popfile_writer::write_indents()
 {
 	for (int i = 0; i < indent; ++i)
@@ -34,24 +107,28 @@ void popfile_writer::write_indents()
 
 void popfile_writer::write(const std::string& str)
 {
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::writer_strings);
 	write_indents();
 	popfile << str << '\n';
 }
 
 void popfile_writer::write(const std::string& str, int number)
 {
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::writer_strings);
 	write_indents();
 	popfile << str << ' ' << number << '\n';
 }
 
 void popfile_writer::write(const std::string& str, float number)
 {
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::writer_strings);
 	write_indents();
 	popfile << str << ' ' << number << '\n';
 }
 
 void popfile_writer::write(const std::string& str1, const std::string& str2)
 {
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::writer_strings);
 	write_indents();
 	popfile << str1 << ' ' << str2 << '\n';
 }
@@ -74,8 +151,14 @@ void popfile_writer::block_end()
 	write("}");
 }
 
+void popfile_writer::set_indent(int in)
+{
+	indent = in;
+}
+
 void popfile_writer::write_popfile_header(const std::string& generator_version, int argc, char** argv)
 {
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::writer_strings);
 	// Write a bit of nice info at the top of the mission file.
 	write("// This mission file was randomly generated by Mann Vs Fate version " + generator_version + '.');
 	if (argc > 1)
@@ -95,6 +178,7 @@ void popfile_writer::write_popfile_header(const std::string& generator_version,
 
 void popfile_writer::write_wave_divider(int wave_number)
 {
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::writer_strings);
 	write_indents();
 	popfile << "// WAVE " << wave_number <<
 		" ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////\n";
@@ -115,6 +199,7 @@ void popfile_writer::write_wave_header(const std::string& wave_start_relay, cons
 
 void popfile_writer::write_tfbot(const tfbot& bot, const std::vector<std::string>& spawnbots)
 {
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::writer_strings);
 	block_start("TFBot");
 
 	write("Class", player_class_to_string(bot.cl));
@@ -144,7 +229,6 @@ void popfile_writer::write_tfbot(const tfbot& bot, const std::vector<std::string
 	}
 
 	// Write all Attributes.
-	int attributes_count = bot.attributes.size();
 	for (auto itr = bot.attributes.begin(); itr != bot.attributes.end(); ++itr)
 	{
 		write("Attributes", *itr);
@@ -173,7 +257,7 @@ void popfile_writer::write_tfbot(const tfbot& bot, const std::vector<std::string
 		write('\"' + bot.character_attributes.at(i).first + '\"', bot.character_attributes.at(i).second);
 	}
 	*/
-	for (const std::pair<std::string, float>& p : bot.character_attributes)
+	for (const std::pair<const std::string, float>& p : bot.character_attributes)
 	{
 		write('\"' + p.first + '\"', p.second);
 	}
@@ -200,6 +284,7 @@ void popfile_writer::write_tfbot(const tfbot& bot, const std::vector<std::string
 
 void popfile_writer::write_tank(const tank& tnk, const std::string& starting_node)
 {
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::writer_strings);
 	block_start("FirstSpawnOutput");
 	write("Target", "boss_spawn_relay");
 	write("Action", "Trigger");
@@ -227,6 +312,7 @@ void popfile_writer::write_tank(const tank& tnk, const std::string& starting_nod
 
 void popfile_writer::write_wavespawn(const wavespawn& ws, const std::vector<std::string>& spawnbots)
 {
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::writer_strings);
 	block_start("WaveSpawn");
 
 	write("Name", ws.name);
@@ -267,6 +353,7 @@ void popfile_writer::write_wavespawn(const wavespawn& ws, const std::vector<std:
 
 void popfile_writer::write_mission(const mission& mis, const std::vector<std::string>& spawnbots)
 {
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::writer_strings);
 	block_start("Mission");
 	write("Objective", mis.objective);
 	write("InitialCooldown", mis.initial_cooldown);
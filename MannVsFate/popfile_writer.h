@@ -3,7 +3,9 @@
 
 #include "wavespawn.h"
 #include "mission.h"
+#include <cstdint>
 #include <fstream>
+#include <streambuf>
 
 class tank;
 
@@ -17,8 +19,17 @@ public:
 	void popfile_open(const std::string& filename);
 	// Close the current popfile.
 	void popfile_close();
+	// Discard everything written until the next file is opened, for when a popfile is only simulated.
+	void popfile_discard();
+	// Format everything written until the next file is opened, but only count its bytes instead of storing it.
+	// This is for benchmarking the writer without touching the disk.
+	void popfile_measure();
+	// Get how many bytes have been measured in total.
+	std::uint64_t get_measured_bytes() const;
 	// Copy the contents of another file into the current file.
 	void popfile_copy_write(const std::string& filename);
+	// Copy the contents of a stream into the current file.
+	void popfile_copy_write(std::istream& in);
 
 	// -=- Elemental writing functions -=-
 
@@ -38,6 +49,8 @@ public:
 	void block_start(const std::string& str);
 	// Ends a block with } and unindents.
 	void block_end();
+	// Set the indentation level, for when a piece of a popfile is written to a file of its own.
+	void set_indent(int in);
 
 	// -=- Writing functions for mundane things -=-
 
@@ -60,8 +73,32 @@ public:
 	void write_mission(const mission& mis, const std::vector<std::string>& spawnbots);
 
 private:
+	// A stream buffer that throws away everything written to it, but counts how many bytes that was.
+	class counting_buffer : public std::streambuf
+	{
+	public:
+		// Constructor.
+		counting_buffer();
+		// Get how many bytes have been written.
+		std::uint64_t get_count() const;
+
+	protected:
+		int_type overflow(int_type c) override;
+		std::streamsize xsputn(const char* s, std::streamsize n) override;
+
+	private:
+		// Characters are put here in between overflows, so that writing a character doesn't need a virtual call.
+		char scratch[256];
+		// How many bytes were written before the scratch area was last reset.
+		std::uint64_t count;
+	};
+
 	// The popfile being written to.
 	std::ofstream popfile;
+	// Counts what's written while the popfile is measured.
+	counting_buffer measured;
+	// How many bytes had been measured when the popfile started being measured.
+	std::uint64_t measure_start = 0;
 	// The current indentation level.
 	int indent = 0;
 };
@@ -1,5 +1,8 @@
 #include "pressure_manager.h"
 #include "currency_manager.h"
+#include "profiler.h"
+#include "event_counters.h"
+#include <algorithm>
 
 pressure_manager::pressure_manager(currency_manager& cm)
 	: mission_currency(cm),
@@ -11,7 +14,33 @@ pressure_manager::pressure_manager(currency_manager& cm)
 	bot_path_length(1.0f),
 	pps_factor_tfbot(1.0f),
 	pps_factor_tank(0.05f),
-	player_exponent(1.0f) // 1.175f;
+	player_exponent(1.0f), // 1.175f;
+	pressure_trace(nullptr),
+	peak_live_spawns(0),
+	peak_pressure(0.0f),
+	pressure_sum(0.0),
+	seconds_stepped(0)
+{}
+
+pressure_manager::pressure_manager(const pressure_manager& other, currency_manager& cm)
+	: mission_currency(cm),
+	spawns(other.spawns),
+	wavespawns(other.wavespawns),
+	pressure(other.pressure),
+	pressure_decay_rate(other.pressure_decay_rate),
+	players(other.players),
+	base_pressure_decay_rate(other.base_pressure_decay_rate),
+	pressure_decay_rate_multiplier(other.pressure_decay_rate_multiplier),
+	pressure_decay_rate_multiplier_in_time(other.pressure_decay_rate_multiplier_in_time),
+	bot_path_length(other.bot_path_length),
+	pps_factor_tfbot(other.pps_factor_tfbot),
+	pps_factor_tank(other.pps_factor_tank),
+	player_exponent(other.player_exponent),
+	pressure_trace(nullptr),
+	peak_live_spawns(other.peak_live_spawns),
+	peak_pressure(other.peak_pressure),
+	pressure_sum(other.pressure_sum),
+	seconds_stepped(other.seconds_stepped)
 {}
 
 float pressure_manager::get_pressure() const
@@ -24,6 +53,30 @@ float pressure_manager::get_pressure_decay_rate() const
 	return pressure_decay_rate;
 }
 
+std::size_t pressure_manager::get_live_spawns() const
+{
+	return spawns.size();
+}
+
+std::size_t pressure_manager::get_peak_live_spawns() const
+{
+	return peak_live_spawns;
+}
+
+float pressure_manager::get_peak_pressure() const
+{
+	return peak_pressure;
+}
+
+float pressure_manager::get_mean_pressure() const
+{
+	if (seconds_stepped == 0)
+	{
+		return 0.0f;
+	}
+	return static_cast<float>(pressure_sum / seconds_stepped);
+}
+
 void pressure_manager::set_players(int in)
 {
 	players = in;
@@ -54,17 +107,32 @@ void pressure_manager::reset_pressure()
 	pressure = 0.0f;
 }
 
+void pressure_manager::clear_spawns()
+{
+	spawns.clear();
+	wavespawns.clear();
+	peak_live_spawns = 0;
+	peak_pressure = 0.0f;
+	pressure_sum = 0.0;
+	seconds_stepped = 0;
+}
+
+void pressure_manager::set_pressure_trace(std::vector<float>* trace)
+{
+	pressure_trace = trace;
+}
+
 void pressure_manager::step_through_time(int& t)
 {
+	profiler::scoped_timer timer(profiler::phase::step_through_time);
+
 	// This loop will increment time until there's no pressure left.
 	// When there's no pressure left, we can either generate more WaveSpawns or end the wave.
 	while (pressure > 0.0f)
 	{
 		// Increment time.
 		++t;
-
-		// How much the pressure will be increased based on the active WaveSpawns.
-		float pressure_increase = 0.0f;
+		event_counters::add(event_counters::counter::simulation_ticks);
 
 		// Iterate through the wavespawns to instantiate any new pressure bubbles.
 		for (virtual_wavespawn& ws : wavespawns)
@@ -97,6 +165,7 @@ void pressure_manager::step_through_time(int& t)
 
 				// Since the virtual spawn is dead, remove it from the spawns list.
 				spawns.erase(spawns.begin() + i);
+				event_counters::add(event_counters::counter::virtual_spawns_retired);
 				// Move i backwards so we don't end up skipping an element of the vector.
 				// This is necessary because we just deleted an element.
 				--i;
@@ -114,7 +183,19 @@ void pressure_manager::step_through_time(int& t)
 
 		unsigned int active_spawns = spawns.size();
 		pressure -= pressure_decay_rate * pressure_decay_rate_multiplier_in_time / (active_spawns * 0.2f + 1);
+
+		// The last second of a wave can decay the pressure below 0, which the loop stops at, so that second is recorded as no pressure.
+		const float seconds_of_pressure = std::max(0.0f, pressure / pressure_decay_rate);
+		peak_pressure = std::max(peak_pressure, seconds_of_pressure);
+		pressure_sum += seconds_of_pressure;
+		++seconds_stepped;
+		if (pressure_trace != nullptr)
+		{
+			pressure_trace->emplace_back(seconds_of_pressure);
+		}
 	}
+
+	timer.set_state({ t, pressure, pressure_decay_rate, spawns.size() });
 }
 
 void pressure_manager::add_virtual_wavespawn(const virtual_wavespawn& ws)
@@ -149,6 +230,8 @@ void pressure_manager::add_virtual_spawn(const virtual_wavespawn& ws)
 
 	// Add the spawn to the spawns collection.
 	spawns.emplace_back(spawn);
+	event_counters::add(event_counters::counter::virtual_spawns_created);
+	peak_live_spawns = std::max(peak_live_spawns, spawns.size());
 
 	// Add the initial pressure of the spawn.
 	pressure += spawn.get_pressure_per_second();
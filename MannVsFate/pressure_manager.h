@@ -13,9 +13,17 @@ class pressure_manager
 public:
 	// Constructor.
 	pressure_manager(currency_manager& cm);
+	// Copy the state of another pressure manager, but depend on a different currency manager.
+	// This lets what-ifs be simulated without touching the real state. The copy doesn't record a pressure trace.
+	pressure_manager(const pressure_manager& other, currency_manager& cm);
 	// Accessors.
 	float get_pressure() const;
 	float get_pressure_decay_rate() const;
+	std::size_t get_live_spawns() const;
+	std::size_t get_peak_live_spawns() const;
+	float get_peak_pressure() const;
+	// Get the mean of the pressure after each second stepped through since the spawns were last cleared.
+	float get_mean_pressure() const;
 	void set_players(int in);
 	int get_players() const;
 	void multiply_pressure_decay_rate_multiplier(float multiplier);
@@ -23,6 +31,12 @@ public:
 	void set_bot_path_length(float in);
 	// Set the pressure to 0.
 	void reset_pressure();
+	// Forget every virtual WaveSpawn and spawn, so that nothing from a previous wave carries over into the next one.
+	// This also starts counting the peak number of live spawns and the pressure statistics over.
+	void clear_spawns();
+	// Record the pressure after every simulated second into a vector, measured in seconds of pressure decay.
+	// Recording stops when the vector is null.
+	void set_pressure_trace(std::vector<float>* trace);
 
 	// Step through time starting at time t. This increments the variable t if time is passed.
 	// This function contains the loop that actually modifies the pressure.
@@ -96,6 +110,19 @@ private:
 
 	// The exponent by which the number of players is raised to when calculating the effective players.
 	float player_exponent;
+
+	// If not null, the pressure is recorded here after every simulated second.
+	std::vector<float>* pressure_trace;
+
+	// The most virtual spawns that have been alive at once since the spawns were last cleared.
+	std::size_t peak_live_spawns;
+
+	// The highest pressure after a second since the spawns were last cleared, measured in seconds of pressure decay like the trace.
+	float peak_pressure;
+	// The sum of the pressure after each second since the spawns were last cleared, measured the same way.
+	double pressure_sum;
+	// How many seconds were stepped through since the spawns were last cleared.
+	int seconds_stepped;
 };
 
-#endif PRESSURE_MANAGER_H
\ No newline at end of file
+#endif // PRESSURE_MANAGER_H
\ No newline at end of file
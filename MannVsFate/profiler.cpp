@@ -0,0 +1,279 @@
+#include "profiler.h"
+#include "time_util.h"
+#include "json.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace
+{
+	// The profiler that timers record with.
+	profiler* active = nullptr;
+	// The wave that this thread is generating.
+	thread_local int current_wave = 0;
+
+	// Find a percentile of sorted samples by the nearest rank method.
+	double percentile(const std::vector<double>& sorted, double p)
+	{
+		const std::size_t rank = static_cast<std::size_t>(std::ceil(p * sorted.size()));
+		return sorted.at(std::max<std::size_t>(rank, 1) - 1);
+	}
+}
+
+profiler::scoped_timer::scoped_timer(phase p)
+	: prof(active), timed_phase(p), wave(0), has_state(false), state()
+{
+	if (prof != nullptr)
+	{
+		wave = current_wave;
+		start = std::chrono::steady_clock::now();
+	}
+}
+
+profiler::scoped_timer::~scoped_timer()
+{
+	stop();
+}
+
+void profiler::scoped_timer::stop()
+{
+	if (prof != nullptr)
+	{
+		prof->record(timed_phase, wave, start, milliseconds_between(start, std::chrono::steady_clock::now()), has_state ? &state : nullptr);
+		prof = nullptr;
+	}
+}
+
+void profiler::scoped_timer::set_state(const simulation_state& in)
+{
+	if (prof != nullptr)
+	{
+		state = in;
+		has_state = true;
+	}
+}
+
+profiler::profiler()
+	: start(std::chrono::steady_clock::now()), wave_totals(), wave_counts(), wave_event_counts(), tracing(false)
+{}
+
+void profiler::set_tracing(bool in)
+{
+	tracing = in;
+}
+
+void profiler::record(phase p, int wave, std::chrono::steady_clock::time_point sample_start, double milliseconds, const simulation_state* state)
+{
+	const std::size_t index = static_cast<std::size_t>(p);
+	std::lock_guard<std::mutex> lock(samples_mutex);
+	samples.at(index).durations.emplace_back(milliseconds);
+	if (wave != 0)
+	{
+		// New entries of the maps are value initialized to zero.
+		wave_totals[wave].at(index) += milliseconds;
+		++wave_counts[wave].at(index);
+	}
+
+	if (tracing)
+	{
+		// Threads are numbered as they're seen, since their IDs can't be written as JSON numbers.
+		const unsigned int thread = thread_numbers.emplace(std::this_thread::get_id(), static_cast<unsigned int>(thread_numbers.size())).first->second;
+
+		trace_event e;
+		e.event_phase = p;
+		e.wave = wave;
+		e.thread = thread;
+		e.start_us = milliseconds_between(start, sample_start) * 1000.0;
+		e.duration_us = milliseconds * 1000.0;
+		e.has_state = state != nullptr;
+		e.state = state != nullptr ? *state : simulation_state();
+		trace_events.emplace_back(e);
+	}
+}
+
+void profiler::record_counters(int wave, const event_counters::values& counters)
+{
+	std::lock_guard<std::mutex> lock(samples_mutex);
+	// New entries of the map are value initialized to zero.
+	event_counters::accumulate(wave_event_counts[wave], counters);
+}
+
+void profiler::write_report(const std::string& filename) const
+{
+	nlohmann::json report;
+	report["total_ms"] = milliseconds_between(start, std::chrono::steady_clock::now());
+
+	std::lock_guard<std::mutex> lock(samples_mutex);
+
+	nlohmann::json phases = nlohmann::json::object();
+	for (std::size_t i = 0; i < phase_count; ++i)
+	{
+		std::vector<double> sorted = samples.at(i).durations;
+		if (sorted.empty())
+		{
+			continue;
+		}
+		std::sort(sorted.begin(), sorted.end());
+
+		double total = 0.0;
+		for (const double duration : sorted)
+		{
+			total += duration;
+		}
+
+		nlohmann::json node;
+		node["calls"] = sorted.size();
+		node["total_ms"] = total;
+		node["mean_ms"] = total / sorted.size();
+		node["p50_ms"] = percentile(sorted, 0.5);
+		node["p99_ms"] = percentile(sorted, 0.99);
+		node["max_ms"] = sorted.back();
+		phases[get_phase_name(static_cast<phase>(i))] = node;
+	}
+	report["phases"] = phases;
+
+	// The counters are keyed by their names.
+	const auto counters_node = [](const event_counters::values& counters)
+	{
+		nlohmann::json node = nlohmann::json::object();
+		for (std::size_t i = 0; i < event_counters::counter_count; ++i)
+		{
+			node[event_counters::get_counter_name(static_cast<event_counters::counter>(i))] = counters.at(i);
+		}
+		return node;
+	};
+	// The mission's counters are the total over every wave.
+	event_counters::values total_counters = {};
+	for (const auto& wave : wave_event_counts)
+	{
+		event_counters::accumulate(total_counters, wave.second);
+	}
+	report["counters"] = counters_node(total_counters);
+
+	nlohmann::json waves = nlohmann::json::array();
+	for (const auto& wave : wave_totals)
+	{
+		const std::array<unsigned int, phase_count>& counts = wave_counts.at(wave.first);
+		nlohmann::json node;
+		node["number"] = wave.first;
+		for (std::size_t i = 0; i < phase_count; ++i)
+		{
+			if (counts.at(i) != 0)
+			{
+				nlohmann::json phase_node;
+				phase_node["calls"] = counts.at(i);
+				phase_node["total_ms"] = wave.second.at(i);
+				node[get_phase_name(static_cast<phase>(i))] = phase_node;
+			}
+		}
+		const auto counters = wave_event_counts.find(wave.first);
+		if (counters != wave_event_counts.end())
+		{
+			node["counters"] = counters_node(counters->second);
+		}
+		waves.push_back(node);
+	}
+	report["waves"] = waves;
+
+	std::ofstream file(filename);
+	if (!file)
+	{
+		const std::string exstr = "profiler::write_report exception: Couldn't write the profile \"" + filename + "\".";
+		throw std::exception(exstr.c_str());
+	}
+	file << report.dump(1) << std::endl;
+}
+
+void profiler::write_trace(const std::string& filename) const
+{
+	std::lock_guard<std::mutex> lock(samples_mutex);
+
+	nlohmann::json events = nlohmann::json::array();
+	for (const trace_event& e : trace_events)
+	{
+		nlohmann::json node;
+		node["name"] = get_phase_name(e.event_phase);
+		node["cat"] = "generation";
+		// Complete events have both a start and a duration.
+		node["ph"] = "X";
+		node["ts"] = e.start_us;
+		node["dur"] = e.duration_us;
+		node["pid"] = 1;
+		node["tid"] = e.thread;
+
+		nlohmann::json args = nlohmann::json::object();
+		if (e.wave != 0)
+		{
+			args["wave"] = e.wave;
+		}
+		if (e.has_state)
+		{
+			args["t"] = e.state.t;
+			args["pressure"] = e.state.pressure;
+			args["pressure_decay_rate"] = e.state.pressure_decay_rate;
+			args["live_spawns"] = e.state.live_spawns;
+		}
+		node["args"] = args;
+		events.push_back(node);
+	}
+
+	nlohmann::json trace;
+	trace["traceEvents"] = events;
+	trace["displayTimeUnit"] = "ms";
+
+	std::ofstream file(filename);
+	if (!file)
+	{
+		const std::string exstr = "profiler::write_trace exception: Couldn't write the trace \"" + filename + "\".";
+		throw std::exception(exstr.c_str());
+	}
+	file << trace.dump() << std::endl;
+}
+
+void profiler::set_current_wave(int wave)
+{
+	current_wave = wave;
+}
+
+profiler* profiler::get_active()
+{
+	return active;
+}
+
+void profiler::set_active(profiler* prof)
+{
+	active = prof;
+}
+
+const char* profiler::get_phase_name(phase p)
+{
+	switch (p)
+	{
+	case phase::data_load:
+		return "data_load";
+	case phase::weapon_data:
+		return "weapon_data";
+	case phase::map_data:
+		return "map_data";
+	case phase::list_data:
+		return "list_data";
+	case phase::wave:
+		return "wave";
+	case phase::sentry_buster:
+		return "sentry_buster";
+	case phase::wavespawn:
+		return "wavespawn";
+	case phase::bot_generation:
+		return "bot_generation";
+	case phase::health_fitting:
+		return "health_fitting";
+	case phase::step_through_time:
+		return "step_through_time";
+	case phase::writing:
+		return "writing";
+	case phase::concatenation:
+		return "concatenation";
+	default:
+		return "unknown";
+	}
+}
\ No newline at end of file
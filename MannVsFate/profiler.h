@@ -0,0 +1,176 @@
+// A profiler that times the phases of loading the data and generating a mission.
+// Timers check for an active profiler before reading the clock, so they cost next to nothing when profiling is off.
+// The profiler can also keep every timed span as a trace event, to be viewed as a timeline in chrome://tracing or Perfetto.
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "event_counters.h"
+#include <array>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class profiler
+{
+public:
+	// The phases that are timed. Phases can be nested, so their times overlap.
+	enum class phase
+	{
+		// Loading the data before the generators are set up, which includes reading the data pack or the cosmetic categories.
+		data_load,
+		// Reading weapons.json, or the weapons in the data pack.
+		weapon_data,
+		// Reading maps.json, or the map profile in the data pack.
+		map_data,
+		// Reading lists with list_reader.
+		list_data,
+		// Generating one wave, including writing it.
+		wave,
+		// Generating the Sentry Buster Mission of a wave.
+		sentry_buster,
+		// Generating one WaveSpawn, including its bot.
+		wavespawn,
+		// Generating one bot with the bot generator.
+		bot_generation,
+		// Fitting a bot's health and count to the time that its WaveSpawn has left.
+		health_fitting,
+		// Simulating the pressure through time.
+		step_through_time,
+		// Writing a wave and its Mission to their temporary files.
+		writing,
+		// Concatenating the temporary files into the popfile, or splicing a rerolled wave in.
+		concatenation,
+		// The number of phases.
+		count
+	};
+
+	// The state of the pressure simulation that a trace event is tagged with.
+	struct simulation_state
+	{
+		// The current time in the wave.
+		int t;
+		// The current pressure.
+		float pressure;
+		// The current pressure decay rate.
+		float pressure_decay_rate;
+		// The number of virtual spawns that are alive.
+		std::size_t live_spawns;
+	};
+
+	// Times a phase from construction to destruction, if a profiler is active.
+	class scoped_timer
+	{
+	public:
+		// Constructor.
+		explicit scoped_timer(phase p);
+		// Destructor. Records the time with the active profiler, unless the timer has been stopped.
+		~scoped_timer();
+
+		// Record the time now instead of on destruction.
+		void stop();
+
+		// Tag the timer's trace event with the state of the pressure simulation. A later call replaces an earlier one.
+		void set_state(const simulation_state& in);
+
+		scoped_timer(const scoped_timer&) = delete;
+		scoped_timer& operator=(const scoped_timer&) = delete;
+
+	private:
+		// The profiler that was active when the timer started. nullptr if there was none.
+		profiler* prof;
+		// The phase being timed.
+		phase timed_phase;
+		// The wave that the thread was generating when the timer started.
+		int wave;
+		// When the timer started.
+		std::chrono::steady_clock::time_point start;
+		// Whether the trace event has been tagged with a state.
+		bool has_state;
+		// The state that the trace event is tagged with.
+		simulation_state state;
+	};
+
+	// Constructor. The time of the whole run is measured from here.
+	profiler();
+
+	// Keep every sample as a trace event too.
+	void set_tracing(bool in);
+
+	// Add a sample to a phase. The sample is counted towards a wave unless the wave is 0.
+	// The state is only kept for tracing, and can be null.
+	void record(phase p, int wave, std::chrono::steady_clock::time_point sample_start, double milliseconds, const simulation_state* state);
+
+	// Add the work done generating a wave to the wave's counters. Every candidate of a wave is added.
+	// The work done before the first wave is added as wave 0, which only counts towards the totals.
+	void record_counters(int wave, const event_counters::values& counters);
+
+	// Write the report as JSON. Throws if the file can't be written.
+	void write_report(const std::string& filename) const;
+
+	// Write the trace events in the Chrome trace event format. Throws if the file can't be written.
+	void write_trace(const std::string& filename) const;
+
+	// Set the wave that the calling thread is generating, so that its samples are broken down by wave. 0 for none.
+	static void set_current_wave(int wave);
+
+	// The profiler that timers record with. nullptr if profiling is off.
+	static profiler* get_active();
+	static void set_active(profiler* prof);
+
+	// Get the name of a phase as it appears in the report.
+	static const char* get_phase_name(phase p);
+
+private:
+	// Every sample of one phase.
+	struct phase_samples
+	{
+		// The length of each sample in milliseconds.
+		std::vector<double> durations;
+	};
+
+	// A timed span, as it appears on the timeline.
+	struct trace_event
+	{
+		// The phase that was timed.
+		phase event_phase;
+		// The wave that the span was part of. 0 for none.
+		int wave;
+		// The thread that the span ran on, numbered in the order that threads were first seen.
+		unsigned int thread;
+		// When the span started, in microseconds since the profiler was constructed.
+		double start_us;
+		// How long the span took, in microseconds.
+		double duration_us;
+		// Whether the span was tagged with the state of the pressure simulation, and the state if it was.
+		bool has_state;
+		simulation_state state;
+	};
+
+	// The number of phases.
+	static constexpr std::size_t phase_count = static_cast<std::size_t>(phase::count);
+
+	// When the profiler was constructed.
+	std::chrono::steady_clock::time_point start;
+	// Guards the samples, since candidate waves are generated on several threads.
+	mutable std::mutex samples_mutex;
+	// The samples of each phase.
+	std::array<phase_samples, phase_count> samples;
+	// The total time of each phase, broken down by wave.
+	std::map<int, std::array<double, phase_count>> wave_totals;
+	// The number of samples of each phase, broken down by wave.
+	std::map<int, std::array<unsigned int, phase_count>> wave_counts;
+	// The event counters of each wave.
+	std::map<int, event_counters::values> wave_event_counts;
+	// Whether trace events are kept.
+	bool tracing;
+	// Every trace event, in the order that the spans ended.
+	std::vector<trace_event> trace_events;
+	// The number that each thread has in the trace.
+	std::map<std::thread::id, unsigned int> thread_numbers;
+};
+
+#endif
\ No newline at end of file
@@ -1,6 +1,47 @@
 #include "rand_util.h"
+#include "event_counters.h"
+#include <cmath>
 #include <random>
 
+namespace
+{
+	// Seeding a Mersenne Twister is far more expensive than drawing from one, so each thread seeds its engine once and keeps it.
+	// Keeping one engine per thread also lets missions be generated on several threads at once.
+	std::mt19937& get_engine()
+	{
+		thread_local std::mt19937 engine(std::random_device{}());
+		return engine;
+	}
+
+	// Returns a random double between bottom (inclusive) and top (exclusive).
+	// Each standard library implements std::uniform_real_distribution its own way, so the same seed would give different missions with each.
+	// This is written out the way that libstdc++ implements it for a 32 bit engine, so that every build draws the same numbers.
+	double rand_double(const double bottom, const double top)
+	{
+		std::mt19937& engine = get_engine();
+		// 64 random bits, low half first, scaled to [0, 1). Rounding the sum to a double can reach 1, which is left out.
+		const double low = static_cast<double>(engine());
+		const double high = static_cast<double>(engine());
+		double fraction = (low + high * 4294967296.0) / 18446744073709551616.0;
+		if (fraction >= 1.0)
+		{
+			fraction = std::nextafter(1.0, 0.0);
+		}
+		return fraction * (top - bottom) + bottom;
+	}
+}
+
+void rand_seed(const unsigned int seed)
+{
+	get_engine().seed(seed);
+}
+
+unsigned int rand_new_seed()
+{
+	event_counters::add(event_counters::counter::rand_draws);
+	return static_cast<unsigned int>(get_engine()());
+}
+
 int rand_int(const int bottom, const int top)
 {
 	if (top <= bottom)
@@ -9,10 +50,8 @@ int rand_int(const int bottom, const int top)
 	}
 	else
 	{
-		std::random_device rd;
-		std::mt19937 e2(rd());
-		std::uniform_real_distribution<> dist(bottom, top);
-		return static_cast<int>(std::floor(dist(e2)));
+		event_counters::add(event_counters::counter::rand_draws);
+		return static_cast<int>(std::floor(rand_double(bottom, top)));
 	}
 }
 
@@ -29,14 +68,40 @@ float rand_float(const float bottom, const float top)
 	}
 	else
 	{
-		std::random_device rd;
-		std::mt19937 e2(rd());
-		std::uniform_real_distribution<> dist(bottom, top);
-		return static_cast<float>(dist(e2));
+		event_counters::add(event_counters::counter::rand_draws);
+		return static_cast<float>(rand_double(bottom, top));
 	}
 }
 
 bool rand_chance(const float chance)
 {
 	return (rand_float(0.0f, 1.0f) < chance);
+}
+
+int rand_set_bit(const unsigned int mask)
+{
+	int count = 0;
+	for (unsigned int m = mask; m != 0; m &= m - 1)
+	{
+		++count;
+	}
+	if (count == 0)
+	{
+		throw std::exception("rand_util::rand_set_bit exception: Empty mask.");
+	}
+
+	// Find the chosen set bit by skipping over the lower ones.
+	int chosen = rand_int(0, count);
+	unsigned int m = mask;
+	for (; chosen > 0; --chosen)
+	{
+		m &= m - 1;
+	}
+	int index = 0;
+	while ((m & 1u) == 0)
+	{
+		m >>= 1;
+		++index;
+	}
+	return index;
 }
\ No newline at end of file
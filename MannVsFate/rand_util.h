@@ -5,6 +5,11 @@
 
 #include <vector>
 
+// Seeds the calling thread's random number generator, so that everything it draws afterwards can be repeated.
+void rand_seed(const unsigned int seed);
+// Draws a seed for a new random number stream from the calling thread's random number generator.
+unsigned int rand_new_seed();
+
 // Returns a random integer between bottom (inclusive) and top (exclusive).
 int rand_int(const int bottom, const int top);
 // Returns a random integer between 0 (inclusive) and top (exclusive).
@@ -16,8 +21,12 @@ float rand_float(const float bottom, const float top);
 // Randomly returns true (chance*100)% of the time.
 bool rand_chance(const float chance);
 
+// Returns the index of a random set bit in a bitmask, with each set bit being equally likely.
+// The mask must not be 0.
+int rand_set_bit(const unsigned int mask);
+
 template <class T>
-T rand_element_from_many_collections(const std::vector<std::vector<T>*>& collections)
+T rand_element_from_many_collections(const std::vector<const std::vector<T>*>& collections)
 {
 	unsigned int total_size = 0;
 	for (unsigned int i = 0; i < collections.size(); ++i)
@@ -1,5 +1,6 @@
 #include "random_name_generator.h"
 #include "rand_util.h"
+#include <algorithm>
 
 // If 1, debug info of get_random_name will be printed to std::cout.
 #define RANDOM_NAME_DEBUG 0
@@ -7,68 +8,98 @@
 #if RANDOM_NAME_DEBUG == 1
 
 #include <iostream>
-#include <string>
 
 #endif
 
 random_name_generator::random_name_generator(const std::string& verbs, const std::string& titles,
 	const std::string& adjectives, const std::string& nouns)
-	: verbs(verbs), titles(titles), adjectives(adjectives), nouns(nouns)
+	: verbs(lr.get_list(verbs)),
+	titles(lr.get_list(titles)),
+	adjectives(lr.get_list(adjectives)),
+	nouns(lr.get_list(nouns))
 {
-	/*
-	lr.load(verbs);
-	lr.load(titles);
-	lr.load(adjectives);
-	lr.load(nouns);
-	*/
+	for (const std::string* filename : { &verbs, &titles, &adjectives, &nouns })
+	{
+		if (lr.get_list(*filename).empty())
+		{
+			const std::string exstr = "random_name_generator exception: Word list \"" + *filename + "\" is empty!";
+			throw std::exception(exstr.c_str());
+		}
+	}
+}
+
+std::string_view random_name_generator::get_random(const std::vector<std::string_view>& words)
+{
+	return words.at(rand_int(0, words.size()));
+}
+
+void random_name_generator::name_buffer::append(std::string_view str)
+{
+	const std::size_t count = std::min(str.size(), capacity - length);
+	std::copy_n(str.data(), count, data + length);
+	length += count;
 }
 
-std::string random_name_generator::get_random_name()
+std::string_view random_name_generator::name_buffer::view() const
 {
-	std::string verb, title, adjective, noun1, noun2;
+	return std::string_view(data, length);
+}
+
+std::string random_name_generator::get_random_name() const
+{
+	std::string_view verb, title, adjective, noun1, noun2;
 	if (rand_int(0, 2) == 0)
 	{
-		verb = lr.get_random(verbs) + ' ';
-		title = "The ";
+		verb = get_random(verbs);
+		title = "The";
 	}
 	if (rand_int(0, 2) == 0)
 	{
-		title = lr.get_random(titles) + ' ';
+		title = get_random(titles);
 	}
 	if (rand_int(0, 2) == 0)
 	{
-		adjective = lr.get_random(adjectives) + ' ';
+		adjective = get_random(adjectives);
 	}
 	if (rand_int(0, 2) == 0)
 	{
-		noun1 = lr.get_random(nouns) + ' ';
+		noun1 = get_random(nouns);
 	}
 	// Always have at least a noun no matter what.
-	noun2 = lr.get_random(nouns);
+	noun2 = get_random(nouns);
 
 #if RANDOM_NAME_DEBUG == 1
-	if (verb != "")
+	if (!verb.empty())
 	{
 		std::cout << "Verb: " << verb << std::endl;
 	}
-	if (title != "")
+	if (!title.empty())
 	{
 		std::cout << "Title: " << title << std::endl;
 	}
-	if (adjective != "")
+	if (!adjective.empty())
 	{
 		std::cout << "Adjective: " << adjective << std::endl;
 	}
-	if (noun1 != "")
+	if (!noun1.empty())
 	{
 		std::cout << "Noun 1: " << noun1 << std::endl;
 	}
-	if (noun2 != "")
-	{
-		std::cout << "Noun 2: " << noun2 << std::endl;
-	}
+	std::cout << "Noun 2: " << noun2 << std::endl;
 	std::cout << std::endl;
 #endif
 
-	return verb + title + adjective + noun1 + noun2;
+	// Every word that was chosen is followed by a space, except for the last noun.
+	name_buffer name;
+	for (const std::string_view word : { verb, title, adjective, noun1 })
+	{
+		if (!word.empty())
+		{
+			name.append(word);
+			name.append(" ");
+		}
+	}
+	name.append(noun2);
+
+	return std::string(name.view());
 }
\ No newline at end of file
@@ -2,20 +2,52 @@
 #define RANDOM_NAME_GENERATOR_H
 
 #include "list_reader.h"
+#include <string>
+#include <string_view>
+#include <vector>
 
 class random_name_generator
 {
 public:
-	// Constructor. Defers to list reader for loading word lists by passing these filename arguments.
+	// Constructor. Loads the word lists with these filenames using a list reader.
+	// Throws if any of the lists are empty.
 	random_name_generator(const std::string& verbs, const std::string& titles,
 		const std::string& adjectives, const std::string& nouns);
 
+	// The word lists refer into this generator's own list reader, so a copy would refer into the original's.
+	random_name_generator(const random_name_generator&) = delete;
+	random_name_generator& operator=(const random_name_generator&) = delete;
+
 	// Get a random name.
-	std::string get_random_name();
+	std::string get_random_name() const;
 
 private:
+	// A fixed-capacity buffer that a name is assembled in without any heap allocations.
+	class name_buffer
+	{
+	public:
+		// Append a string to the name. Anything past the capacity is cut off.
+		void append(std::string_view str);
+		// Get the name assembled so far.
+		std::string_view view() const;
+
+	private:
+		// The longest name that can be assembled. The longest possible name from the stock lists is well under this.
+		static constexpr std::size_t capacity = 128;
+
+		char data[capacity];
+		std::size_t length = 0;
+	};
+
+	// Get a random word from a word list.
+	static std::string_view get_random(const std::vector<std::string_view>& words);
+
+	// The list reader owns the mapped word list files that the word lists point into.
 	list_reader lr;
-	const std::string verbs, titles, adjectives, nouns;
+	const std::vector<std::string_view>& verbs;
+	const std::vector<std::string_view>& titles;
+	const std::vector<std::string_view>& adjectives;
+	const std::vector<std::string_view>& nouns;
 };
 
 #endif
\ No newline at end of file
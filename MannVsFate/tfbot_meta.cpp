@@ -1,5 +1,5 @@
 #include "tfbot_meta.h"
-#include "json_reader_weapon.h"
+#include "allocation_tracker.h"
 
 tfbot_meta::tfbot_meta()
 	: pressure(1.0f),
@@ -9,18 +9,14 @@ tfbot_meta::tfbot_meta()
 	is_giant(false),
 	is_boss(false),
 	is_doom(false),
+	shall_be_giant(false),
+	shall_be_boss(false),
 	perma_small(false),
 	is_always_crit(false),
 	is_always_fire_weapon(false),
-	base_class_icon(""),
 	projectile_override_crash_risk(false),
-	shall_be_giant(false),
-	shall_be_boss(false)
-{
-	// Since we're keeping references to elements in the vector, we don't want the vector to move around.
-	// Let's reserve as much space as we need so that the vector doesn't get displaced by memory reallocation.
-	weapons.reserve(10);
-}
+	base_class_icon("")
+{}
 
 tfbot& tfbot_meta::get_bot()
 {
@@ -118,29 +114,21 @@ float tfbot_meta::calculate_muted_time_to_kill(float recip_pressure_decay_rate)
 	return calculate_muted_effective_pressure() * recip_pressure_decay_rate;
 }
 
-weapon& tfbot_meta::add_weapon(const std::string& weapon_name, const json_reader_weapon& weapon_reader)
+const weapon& tfbot_meta::add_weapon(const weapon& wep)
 {
-	// Read the weapon from JSON data.
-	weapon wep = weapon_reader.read_weapon(weapon_name, bot.cl);
-
+	const allocation_tracker::scoped_tag tag(allocation_tracker::subsystem::weapons);
 	// Add the weapon to the weapons collection.
-	weapons.emplace_back(wep);
-	//std::cout << "tfbot_meta::add_weapon: Weapon names count: " << wep.names.size() << std::endl;
+	weapons.emplace_back(&wep);
 
 	// Give the bot the actual name of the item.
 	bot.items.emplace(wep.names.at(0));
 
-	// Return the most recent weapon (i.e. the one that was just added).
-	weapon& ref = weapons.at(weapons.size() - 1);
-	//std::cout << "tfbot_meta::add_weapon: added weapon: " << ref.first_name() << std::endl;
-	//std::cout << "tfbot_meta::add_weapon: ref names count: " << ref.names.size() << std::endl;
-	return ref;
-	//slot = &weapons.at(weapons.size() - 1);
+	return wep;
 }
 
 float tfbot_meta::calculate_absolute_move_speed()
 {
-	float base_move_speed;
+	float base_move_speed = 1.0f;
 	switch (bot.cl)
 	{
 	case player_class::scout:
@@ -6,8 +6,6 @@
 #include "tfbot.h"
 #include "weapon.h"
 
-class json_reader_weapon;
-
 class tfbot_meta
 {
 public:
@@ -47,7 +45,8 @@ public:
 	float calculate_muted_time_to_kill(float recip_pressure_decay_rate) const;
 
 	// Add a weapon to the bot and return the weapon.
-	weapon& add_weapon(const std::string& weapon_name, const json_reader_weapon& weapon_reader);
+	// The weapon is kept by reference, so it must outlive the bot (e.g. a weapon owned by a loadout_table).
+	const weapon& add_weapon(const weapon& wep);
 
 	// Calculates the absolute move speed of the bot, factoring in the move speed bonus.
 	// Takes into account the base speed of the class.
@@ -87,8 +86,8 @@ private:
 	tfbot bot;
 	// The base class icon of the bot, not including the giant or crits components.
 	std::string base_class_icon;
-	// A vector of the bot's weapons.
-	std::vector<weapon> weapons;
+	// A vector of handles to the bot's weapons.
+	std::vector<const weapon*> weapons;
 };
 
 #endif // TFBOT_META_H
\ No newline at end of file
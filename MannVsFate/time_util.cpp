@@ -0,0 +1,6 @@
+#include "time_util.h"
+
+double milliseconds_between(const std::chrono::steady_clock::time_point start, const std::chrono::steady_clock::time_point end)
+{
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+// Utility functions for timing parts of the program.
+
+#ifndef TIME_UTIL_H
+#define TIME_UTIL_H
+
+#include <chrono>
+
+// Returns the number of milliseconds between two points in time.
+double milliseconds_between(const std::chrono::steady_clock::time_point start, const std::chrono::steady_clock::time_point end);
+
+#endif
\ No newline at end of file
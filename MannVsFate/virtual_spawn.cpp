@@ -8,8 +8,8 @@
 #endif
 
 virtual_spawn::virtual_spawn(int time_to_kill, float pressure_per_second, int currency, float pressure_per_second_per_second)
-	: seconds_remaining(time_to_kill), pressure_per_second(pressure_per_second), currency(currency),
-	pressure_per_second_per_second(pressure_per_second_per_second)
+	: seconds_remaining(time_to_kill), pressure_per_second(pressure_per_second),
+	pressure_per_second_per_second(pressure_per_second_per_second), currency(currency)
 {}
 
 virtual_spawn::virtual_spawn(int time_to_kill, float initial_pressure_per_second, float total_pressure, int currency)
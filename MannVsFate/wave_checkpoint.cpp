@@ -0,0 +1,39 @@
+#include "wave_checkpoint.h"
+#include <sstream>
+
+namespace
+{
+	const std::string comment_start = "// Checkpoint:";
+}
+
+std::string wave_checkpoint::to_comment() const
+{
+	// 9 significant digits are enough for every float to be read back exactly.
+	std::ostringstream comment;
+	comment.precision(9);
+	comment << comment_start << " currency " << currency << " giantchance " << giant_chance
+		<< " bosschance " << boss_chance << " seed " << seed;
+	return comment.str();
+}
+
+bool wave_checkpoint::from_comment(const std::string& line, wave_checkpoint& out)
+{
+	const std::size_t start = line.find_first_not_of(" \t");
+	if (start == std::string::npos || line.compare(start, comment_start.size(), comment_start) != 0)
+	{
+		return false;
+	}
+
+	std::istringstream fields(line.substr(start + comment_start.size()));
+	std::string currency_key, giant_chance_key, boss_chance_key, seed_key;
+	wave_checkpoint checkpoint;
+	fields >> currency_key >> checkpoint.currency >> giant_chance_key >> checkpoint.giant_chance
+		>> boss_chance_key >> checkpoint.boss_chance >> seed_key >> checkpoint.seed;
+	if (!fields || currency_key != "currency" || giant_chance_key != "giantchance" || boss_chance_key != "bosschance" || seed_key != "seed")
+	{
+		return false;
+	}
+
+	out = checkpoint;
+	return true;
+}
\ No newline at end of file
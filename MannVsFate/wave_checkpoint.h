@@ -0,0 +1,26 @@
+#ifndef WAVE_CHECKPOINT_H
+#define WAVE_CHECKPOINT_H
+
+#include <string>
+
+// The state of a mission at the start of one of its waves.
+// This is everything that a wave takes from the waves before it, so any wave can be generated again from its checkpoint alone.
+// Each wave's checkpoint is written into the popfile as a comment just below the wave's divider.
+struct wave_checkpoint
+{
+	// How much currency the players have when the wave starts.
+	int currency = 0;
+	// The chance that a standard robot will end up being a giant.
+	float giant_chance = 0.0f;
+	// The chance that a giant will end up being a boss.
+	float boss_chance = 0.0f;
+	// The seed of the random number stream that the wave is generated from.
+	unsigned int seed = 0;
+
+	// Write the checkpoint as a popfile comment.
+	std::string to_comment() const;
+	// Read a checkpoint back from a popfile line, ignoring indentation. Returns false if the line isn't a checkpoint.
+	static bool from_comment(const std::string& line, wave_checkpoint& out);
+};
+
+#endif
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "wave_generator.h"
 #include "rand_util.h"
+#include "time_util.h"
 #include "random_name_generator.h"
 #include "mission.h"
 #include "tank.h"
@@ -7,16 +8,138 @@
 #include "pressure_manager.h"
 #include "bot_generator.h"
 #include "tank_generator.h"
-#include "json.hpp"
+#include "generator_data.h"
+#include "wave_checkpoint.h"
+#include "json_reader_wave_scoring.h"
+#include "profiler.h"
+#include "allocation_tracker.h"
 #include <unordered_set>
 #include <sstream>
+#include <fstream>
 #include <algorithm>
+#include <atomic>
+#include <exception>
 #include <iostream>
+#include <thread>
 
-const std::string wave_generator::version = "0.4.15 (UNOFFICIAL)";
+namespace
+{
+	// The lists of randomized sounds.
+	const std::string file_sounds_standard = "data/sounds.txt";
+	const std::string file_sounds_vo = "data/sounds_vo.txt";
+
+	// Get a random sound from a sound list.
+	std::string_view get_random_sound(const std::vector<std::string_view>& sounds)
+	{
+		return sounds.at(rand_int(0, sounds.size()));
+	}
+
+	// Where each wave's pieces are in a generated popfile.
+	struct popfile_layout
+	{
+		// Every line of the popfile.
+		std::vector<std::string> lines;
+		// The first line of each wave's Sentry Buster Mission, in wave order.
+		std::vector<std::size_t> mission_starts;
+		// The first line of each wave, which is its divider, in wave order.
+		std::vector<std::size_t> wave_starts;
+		// The line that closes the WaveSchedule.
+		std::size_t end = 0;
+	};
+
+	// Split a popfile written by the wave generator into its pieces.
+	popfile_layout read_popfile_layout(const std::string& popfile_name)
+	{
+		std::ifstream popfile(popfile_name);
+		if (!popfile)
+		{
+			const std::string exstr = "wave_generator::read_popfile_layout exception: Couldn't read the popfile \"" + popfile_name + "\" to reroll a wave of.";
+			throw std::exception(exstr.c_str());
+		}
+
+		popfile_layout layout;
+		std::string line;
+		while (std::getline(popfile, line))
+		{
+			if (line == "\tMission")
+			{
+				layout.mission_starts.emplace_back(layout.lines.size());
+			}
+			else if (line.compare(0, 9, "\t// WAVE ") == 0)
+			{
+				layout.wave_starts.emplace_back(layout.lines.size());
+			}
+			else if (line == "}")
+			{
+				layout.end = layout.lines.size();
+			}
+			layout.lines.emplace_back(line);
+		}
+
+		if (layout.wave_starts.empty() || layout.mission_starts.size() != layout.wave_starts.size() ||
+			layout.mission_starts.back() > layout.wave_starts.front() || layout.end < layout.wave_starts.back())
+		{
+			const std::string exstr = "wave_generator::read_popfile_layout exception: The popfile \"" + popfile_name + "\" wasn't generated by Mann Vs Fate or has been edited.";
+			throw std::exception(exstr.c_str());
+		}
+		return layout;
+	}
+
+	// Read the checkpoint of a wave of a popfile.
+	wave_checkpoint read_checkpoint(const popfile_layout& layout, const std::string& popfile_name, int wave)
+	{
+		wave_checkpoint checkpoint;
+		if (wave < 1 || wave > static_cast<int>(layout.wave_starts.size()))
+		{
+			const std::string exstr = "wave_generator::read_checkpoint exception: The popfile \"" + popfile_name + "\" has no wave " + std::to_string(wave) + '.';
+			throw std::exception(exstr.c_str());
+		}
+		const std::size_t line = layout.wave_starts.at(wave - 1) + 1;
+		if (line >= layout.lines.size() || !wave_checkpoint::from_comment(layout.lines.at(line), checkpoint))
+		{
+			const std::string exstr = "wave_generator::read_checkpoint exception: Wave " + std::to_string(wave) + " of the popfile \"" + popfile_name + "\" has no checkpoint. It may have been generated by an older version.";
+			throw std::exception(exstr.c_str());
+		}
+		return checkpoint;
+	}
+
+	// Append lines [first, last) of a popfile to a stream.
+	void copy_lines(const popfile_layout& layout, std::size_t first, std::size_t last, std::ostream& out)
+	{
+		for (std::size_t i = first; i < last; ++i)
+		{
+			out << layout.lines.at(i) << '\n';
+		}
+	}
 
-wave_generator::wave_generator(currency_manager& cm, pressure_manager& pm, bot_generator& botgen, tank_generator& tankgen)
-	: mission_currency(cm), wave_pressure(pm), botgen(botgen), tankgen(tankgen),
+	// Append the contents of a file to a stream.
+	void copy_file(const std::string& filename, std::ostream& out)
+	{
+		std::ifstream in(filename);
+		out << in.rdbuf();
+	}
+
+	// Get the seed of a rerolled wave's new stream.
+	// The number drawn after the header is the same one that wave 1 got when the mission was generated with the same -seed,
+	// so the seed being replaced and the wave number are mixed into it. The result is never the seed being replaced.
+	unsigned int reroll_seed(unsigned int drawn, unsigned int replaced, int wave)
+	{
+		// The finalizer of SplitMix64, which spreads every input bit over the whole result.
+		std::uint64_t x = (static_cast<std::uint64_t>(replaced) << 32 | drawn) ^ (static_cast<std::uint64_t>(wave) * 0x9E3779B97F4A7C15ull);
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+		x ^= x >> 31;
+		const unsigned int seed = static_cast<unsigned int>(x ^ (x >> 32));
+		return seed != replaced ? seed : seed + 1;
+	}
+}
+
+const std::string wave_generator::version = "0.4.16 (UNOFFICIAL)";
+
+wave_generator::wave_generator(currency_manager& cm, pressure_manager& pm, bot_generator& botgen, tank_generator& tankgen, generator_data& data)
+	: mission_currency(cm), wave_pressure(pm), botgen(botgen), tankgen(tankgen), data(data),
+	sounds_standard(nullptr),
+	sounds_vo(nullptr),
 	current_wave(0),
 	respawn_wave_time(2),
 	event_popfile(0),
@@ -37,7 +160,14 @@ wave_generator::wave_generator(currency_manager& cm, pressure_manager& pm, bot_g
 	use_wacky_sounds(0),
 	wacky_sound_vo_ratio(0.1f),
 	doombot_enabled(false),
-	force_tfbot_hp(nullptr)
+	force_tfbot_hp(nullptr),
+	reroll_wave(0),
+	candidates(1),
+	scoring_filename("data/wave_scoring.json"),
+	wavespawn_candidates(1),
+	measure_output(false),
+	print_stats(false),
+	write_report(false)
 {}
 
 void wave_generator::set_map_name(const std::string& in)
@@ -50,6 +180,15 @@ void wave_generator::set_mission_name(const std::string& in)
 	mission_name = in;
 }
 
+void wave_generator::set_output_directory(const std::string& in)
+{
+	output_directory = in;
+	if (!output_directory.empty() && output_directory.back() != '/' && output_directory.back() != '\\')
+	{
+		output_directory += '/';
+	}
+}
+
 void wave_generator::set_waves(int in)
 {
 	waves = in;
@@ -171,745 +310,1165 @@ void wave_generator::set_force_tank_speed(float in)
 	}
 }
 
-void wave_generator::generate_mission(int argc, char** argv)
+void wave_generator::set_reroll_wave(int in)
 {
-	// Important MVM properties differ for each map.
+	reroll_wave = in;
+}
 
-	// This is the name of the wave_start_relay entity.
-	std::string wave_start_relay = "wave_start_relay";
-	std::string wave_finished_relay = "wave_finished_relay";
-	// This is the collection of possible starting points for each generic robot spawn.
-	std::vector<std::string> spawnbots;
-	// This is the collection of possible starting points for each large robot spawn.
-	std::vector<std::string> spawnbots_giant;
-	// This is the collection of possible starting points for each boss/mega robot spawn.
-	std::vector<std::string> spawnbots_mega;
-	// This is the collection of possible starting points for each doom robot spawn.
-	std::vector<std::string> spawnbots_doom;
-	// This is the collection of starting points for each tank path.
-	std::vector<std::string> tank_path_starting_points;
+int wave_generator::get_reroll_wave() const
+{
+	return reroll_wave;
+}
 
-	std::ifstream maps_file("data/maps.json");
-	if (!maps_file)
+void wave_generator::set_candidates(unsigned int in)
+{
+	candidates = in;
+}
+
+unsigned int wave_generator::get_candidates() const
+{
+	return candidates;
+}
+
+void wave_generator::set_scoring_filename(const std::string& in)
+{
+	scoring_filename = in;
+}
+
+void wave_generator::set_wavespawn_candidates(unsigned int in)
+{
+	wavespawn_candidates = in;
+}
+
+void wave_generator::set_measure_output(bool in)
+{
+	measure_output = in;
+}
+
+void wave_generator::set_print_stats(bool in)
+{
+	print_stats = in;
+}
+
+void wave_generator::set_write_report(bool in)
+{
+	write_report = in;
+}
+
+bool wave_generator::get_write_report() const
+{
+	return write_report;
+}
+
+void wave_generator::add_candidate_generator(wave_generator& candidate_generator)
+{
+	candidate_generators.emplace_back(&candidate_generator);
+}
+
+std::string wave_generator::get_popfile_name() const
+{
+	std::stringstream filename;
+	filename << output_directory << map_name << '_' << wave_pressure.get_players() << "p_" << mission_name << ".pop";
+	return filename.str();
+}
+
+const std::string& wave_generator::get_version()
+{
+	return version;
+}
+
+void wave_generator::prepare_mission()
+{
+	const event_counters::values counters_before = event_counters::get_thread_values();
+
+	// Important MVM properties differ for each map.
 	{
-		const std::string exstr = "wave_generator::generate_mission exception: Couldn't find maps file \"data/maps.json\".";
-		throw std::exception(exstr.c_str());
+		const profiler::scoped_timer timer(profiler::phase::map_data);
+		profile = data.get_map_profile(map_name);
 	}
 
-	// Deserialize the JSON data.
-	nlohmann::json maps_json;
-
-	try
+	wave_pressure.set_bot_path_length(profile.bot_path_length);
+	botgen.set_scale_mega(profile.scale_mega);
+	botgen.set_scale_doom(profile.scale_doom);
+	botgen.set_engies_enabled(profile.engies);
+	if (profile.max_tank_speed >= 0.0f)
 	{
-		maps_file >> maps_json;
+		tankgen.set_max_tank_speed(profile.max_tank_speed);
 	}
-	catch (const std::exception&)
+
+	// Load every list that this mission can use before generating anything,
+	// so that generation never waits on a file and a missing file is reported before any work is done.
+	// Lists that an earlier mission loaded are already in the generator data.
+	if (use_wacky_sounds != 0)
 	{
-		throw "maps.json exception: JSON parse error.";
+		const std::vector<const std::vector<std::string_view>*> sounds = data.get_lists({ file_sounds_standard, file_sounds_vo });
+		sounds_standard = sounds.at(0);
+		sounds_vo = sounds.at(1);
 	}
+	botgen.compile_tables();
 
-	maps_file.close();
+	if (doombot_enabled)
+	{
+		// Provide some leeway since the Doombot will be running around.
+		wave_pressure.multiply_pressure_decay_rate_multiplier(0.8f);
+	}
 
-	// Retrieve the map data node from the maps JSON.
-	try
+	// The work done before the first wave is counted as wave 0.
+	const event_counters::values counters = event_counters::difference(event_counters::get_thread_values(), counters_before);
+	if (profiler* prof = profiler::get_active())
 	{
-		maps_json = maps_json.at(map_name);
+		prof->record_counters(0, counters);
 	}
-	catch (const std::exception&)
+	if (print_stats)
 	{
-		const std::string exstr = "maps.json exception: Couldn't find an entry for " + map_name + '!';
-		throw std::exception(exstr.c_str());
+		print_counters("Work done preparing the mission:", counters);
 	}
+}
 
-	// Read the actual map data.
+void wave_generator::print_counters(const std::string& heading, const event_counters::values& counters)
+{
+	std::cout << heading << std::endl;
+	for (std::size_t i = 0; i < event_counters::counter_count; ++i)
+	{
+		std::cout << "  " << event_counters::get_counter_name(static_cast<event_counters::counter>(i)) << ": " << counters.at(i) << std::endl;
+	}
+}
 
-	try
+std::string wave_generator::generate_mission(int argc, char** argv)
+{
+	const auto load_start = std::chrono::steady_clock::now();
+	prepare_mission();
+	for (wave_generator* candidate_generator : candidate_generators)
 	{
-		wave_pressure.set_bot_path_length(maps_json.at("bot_path_length").get<float>());
+		candidate_generator->prepare_mission();
 	}
-	catch (const std::exception&)
+	if (candidates > 1)
 	{
-		wave_pressure.set_bot_path_length(1.0f);
+		scoring = json_reader_wave_scoring(scoring_filename).read();
 	}
+	const auto generation_start = std::chrono::steady_clock::now();
 
-	try
+	const std::string popfile_name = get_popfile_name();
+
+	// Rerolling a wave starts from the wave's checkpoint in the existing popfile instead of generating the waves before it.
+	popfile_layout reroll_layout;
+	wave_checkpoint reroll_checkpoint;
+	if (reroll_wave != 0)
 	{
-		botgen.set_scale_mega(maps_json.at("scale_mega").get<float>());
+		reroll_layout = read_popfile_layout(popfile_name);
+		reroll_checkpoint = read_checkpoint(reroll_layout, popfile_name, reroll_wave);
 	}
-	catch (const std::exception&)
+
+	// A rerolled wave replaces its wave in the existing report, if there is one.
+	const std::string report_name = mission_report::get_report_filename(popfile_name);
+	mission_report report;
+	if (write_report && reroll_wave != 0 && std::ifstream(report_name))
 	{
-		botgen.set_scale_mega(1.75f);
+		report.read(report_name);
 	}
 
-	try
+	// The temporary files are named after the popfile so that missions generated side by side don't overwrite each other's pieces.
+	const std::string tempdir = popfile_name + ".temp_";
+	const std::string tempext = ".popt";
+	profiler::scoped_timer header_timer(profiler::phase::writing);
+	allocation_tracker::scoped_phase header_allocations(allocation_tracker::phase::writing);
+	writer.popfile_open(tempdir + 'h' + tempext);
+
+	// Write the popfile header.
+	writer.write_popfile_header(version, argc, argv);
+
+	writer.block_start("WaveSchedule");
+
+	// Write the WaveSchedule universal options.
+	writer.write("StartingCurrency", mission_currency.get_currency());
+	writer.write("RespawnWaveTime", respawn_wave_time);
+	if (event_popfile != 0)
 	{
-		botgen.set_scale_doom(maps_json.at("scale_doom").get<float>());
+		writer.write("EventPopfile", event_popfile);
 	}
-	catch (const std::exception&)
+	if (fixed_respawn_wave_time)
 	{
-		botgen.set_scale_doom(botgen.get_scale_mega());
+		writer.write("FixedRespawnWaveTime", 1);
 	}
-
-	try
+	writer.write("AddSentryBusterWhenDamageDealtExceeds", add_sentry_buster_when_damage_dealt_exceeds);
+	writer.write("AddSentryBusterWhenKillCountExceeds", add_sentry_buster_when_kill_count_exceeds);
+	if (can_bots_attack_while_in_spawn_room)
 	{
-		botgen.set_engies_enabled(maps_json.at("engies").get<bool>());
+		writer.write("CanBotsAttackWhileInSpawnRoom", "yes");
 	}
-	catch (const std::exception&)
+	else
 	{
-		botgen.set_engies_enabled(true);
+		writer.write("CanBotsAttackWhileInSpawnRoom", "no");
 	}
+	writer.write_blank();
 
-	try
+	writer.popfile_close();
+	header_timer.stop();
+	header_allocations.stop();
+
+	// The state that the next wave starts from.
+	wave_checkpoint checkpoint;
+	checkpoint.currency = mission_currency.get_currency();
+	checkpoint.giant_chance = botgen.get_giant_chance();
+	checkpoint.boss_chance = botgen.get_boss_chance();
+
+	int first_wave = 1;
+	int last_wave = waves;
+	if (reroll_wave != 0)
 	{
-		wave_start_relay = maps_json.at("wave_start_relay").get<std::string>();
+		checkpoint = reroll_checkpoint;
+		first_wave = reroll_wave;
+		last_wave = reroll_wave;
 	}
-	catch (const std::exception&)
+
+	// Generate the actual waves!
+	for (int wave = first_wave; wave <= last_wave; ++wave)
 	{
-		wave_start_relay = "wave_start_relay";
+		std::cout << "Generating wave " << wave << '/' << waves << '.' << std::endl;
+
+		std::stringstream filename_wave;
+		filename_wave << tempdir << 'w' << wave << tempext;
+		std::stringstream filename_mission;
+		filename_mission << tempdir << 'm' << wave << tempext;
+
+		// Each wave draws from its own random number stream, so that its checkpoint only has to hold the stream's seed.
+		// A rerolled wave gets a new stream, which is the point of rerolling it.
+		checkpoint.seed = rand_new_seed();
+		if (reroll_wave != 0)
+		{
+			checkpoint.seed = reroll_seed(checkpoint.seed, reroll_checkpoint.seed, wave);
+		}
+		const wave_result result = generate_best_wave(wave, checkpoint, filename_mission.str(), filename_wave.str());
+		checkpoint = result.end;
+		report.record_wave(result.report);
+
+		if (print_stats)
+		{
+			print_counters("Work done generating wave " + std::to_string(wave) + ':', result.counters);
+		}
 	}
 
-	try
+	const std::string hfile = tempdir + 'h' + tempext;
+
+	profiler::scoped_timer concatenation_timer(profiler::phase::concatenation);
+	allocation_tracker::scoped_phase concatenation_allocations(allocation_tracker::phase::writing);
+	if (reroll_wave != 0)
 	{
-		wave_finished_relay = maps_json.at("wave_finished_relay").get<std::string>();
+		std::cout << "Write complete. Splicing wave " << reroll_wave << " into the popfile..." << std::endl;
+
+		std::stringstream filename_mission;
+		filename_mission << tempdir << 'm' << reroll_wave << tempext;
+		std::stringstream filename_wave;
+		filename_wave << tempdir << 'w' << reroll_wave << tempext;
+
+		// Everything but the rerolled wave's Mission and wave is kept as it is.
+		const std::size_t wave_count = reroll_layout.wave_starts.size();
+		const std::size_t index = reroll_wave - 1;
+		const std::size_t mission_end = index + 1 < wave_count ? reroll_layout.mission_starts.at(index + 1) : reroll_layout.wave_starts.front();
+		const std::size_t wave_end = index + 1 < wave_count ? reroll_layout.wave_starts.at(index + 1) : reroll_layout.end;
+
+		std::stringstream spliced;
+		copy_lines(reroll_layout, 0, reroll_layout.mission_starts.at(index), spliced);
+		copy_file(filename_mission.str(), spliced);
+		copy_lines(reroll_layout, mission_end, reroll_layout.wave_starts.at(index), spliced);
+		copy_file(filename_wave.str(), spliced);
+		copy_lines(reroll_layout, wave_end, reroll_layout.lines.size(), spliced);
+
+		std::remove(hfile.c_str());
+		std::remove(filename_mission.str().c_str());
+		std::remove(filename_wave.str().c_str());
+
+		writer.popfile_open(popfile_name);
+		writer.popfile_copy_write(spliced);
+		writer.popfile_close();
+
+		std::cout << "Splicing complete." << std::endl;
 	}
-	catch (const std::exception&)
+	else
 	{
-		wave_finished_relay = "wave_finished_relay";
+		std::cout << "Write complete. Concatenating pieces..." << std::endl;
+
+		// Concatenate all of the pieces into a single file!
+		writer.popfile_open(popfile_name);
+
+		writer.popfile_copy_write(hfile);
+		std::remove(hfile.c_str());
+
+		for (int i = 1; i <= waves; ++i)
+		{
+			std::stringstream filename_mission;
+			filename_mission << tempdir << 'm' << i << tempext;
+			writer.popfile_copy_write(filename_mission.str());
+			std::remove(filename_mission.str().c_str());
+		}
+		for (int i = 1; i <= waves; ++i)
+		{
+			std::stringstream filename_wave;
+			filename_wave << tempdir << 'w' << i << tempext;
+			writer.popfile_copy_write(filename_wave.str());
+			std::remove(filename_wave.str().c_str());
+		}
+
+		writer.block_end(); // WaveSchedule
+		writer.popfile_close();
+
+		std::cout << "Concatenation complete." << std::endl;
 	}
+	concatenation_timer.stop();
+	concatenation_allocations.stop();
 
-	try
+	const auto generation_end = std::chrono::steady_clock::now();
+	std::cout << "Loaded the mission's lists in " << milliseconds_between(load_start, generation_start)
+		<< " ms and generated the mission in " << milliseconds_between(generation_start, generation_end) << " ms." << std::endl;
+
+	if (write_report)
 	{
-		spawnbots = maps_json.at("spawnbots").get<std::vector<std::string>>();
+		report.write(report_name);
+		std::cout << "Wrote the report to " << report_name << '.' << std::endl;
 	}
-	catch (const std::exception&)
+
+	std::cout << "Popfile is ready for play." << std::endl;
+
+	return popfile_name;
+}
+
+std::vector<wave_generator::wave_summary> wave_generator::simulate_mission()
+{
+	prepare_mission();
+
+	wave_checkpoint checkpoint;
+	checkpoint.currency = mission_currency.get_currency();
+	checkpoint.giant_chance = botgen.get_giant_chance();
+	checkpoint.boss_chance = botgen.get_boss_chance();
+
+	std::vector<wave_summary> summaries;
+	for (int wave = 1; wave <= waves; ++wave)
 	{
-		spawnbots.emplace_back("spawnbot");
+		checkpoint.seed = rand_new_seed();
+		const wave_result result = generate_wave(wave, checkpoint, "", "", false);
+		summaries.push_back({ result.duration, result.health, result.wavespawns, result.bots, result.output_bytes,
+			event_counters::get(result.counters, event_counters::counter::health_fitting_iterations), result.peak_live_spawns });
+		checkpoint = result.end;
 	}
+	return summaries;
+}
 
-	try
+wave_generator::wave_result wave_generator::generate_best_wave(int wave, const wave_checkpoint& checkpoint, const std::string& mission_filename, const std::string& wave_filename)
+{
+	if (candidates <= 1)
 	{
-		spawnbots_giant = maps_json.at("spawngiants").get<std::vector<std::string>>();
+		return generate_wave(wave, checkpoint, mission_filename, wave_filename, true);
 	}
-	catch (const std::exception&)
+
+	// Every candidate starts from the same checkpoint, each with a random number stream of its own.
+	// The seeds are drawn up front so that the candidates don't depend on which thread generates them.
+	std::vector<wave_checkpoint> starts(candidates, checkpoint);
+	for (unsigned int i = 1; i < candidates; ++i)
 	{
-		spawnbots_giant = spawnbots;
+		starts.at(i).seed = rand_new_seed();
 	}
 
-	try
+	const auto candidate_filename = [](const std::string& filename, unsigned int candidate)
+	{
+		return filename + '_' + std::to_string(candidate);
+	};
+
+	std::vector<wave_result> results(candidates);
+	std::vector<std::exception_ptr> errors(candidates);
+	std::atomic<unsigned int> next_candidate(1);
+	const auto generate_candidates = [&](wave_generator& gen)
 	{
-		spawnbots_mega = maps_json.at("spawnmegas").get<std::vector<std::string>>();
+		for (unsigned int i = next_candidate++; i < candidates; i = next_candidate++)
+		{
+			try
+			{
+				results.at(i) = gen.generate_wave(wave, starts.at(i), candidate_filename(mission_filename, i), candidate_filename(wave_filename, i), false);
+			}
+			catch (...)
+			{
+				errors.at(i) = std::current_exception();
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (wave_generator* candidate_generator : candidate_generators)
+	{
+		threads.emplace_back(generate_candidates, std::ref(*candidate_generator));
 	}
-	catch (const std::exception&)
+	if (candidate_generators.empty())
 	{
-		spawnbots_mega = spawnbots_giant;
+		generate_candidates(*this);
 	}
-
+	// The first candidate is generated on this thread, and last, so that this thread's random number stream
+	// ends up in the same place however the other candidates were scheduled. The next wave's seed is drawn from it.
 	try
 	{
-		spawnbots_doom = maps_json.at("spawndooms").get<std::vector<std::string>>();
+		results.at(0) = generate_wave(wave, starts.at(0), candidate_filename(mission_filename, 0), candidate_filename(wave_filename, 0), true);
+	}
+	catch (...)
+	{
+		errors.at(0) = std::current_exception();
 	}
-	catch (const std::exception&)
+	for (std::thread& thread : threads)
 	{
-		spawnbots_doom = spawnbots_mega;
+		thread.join();
 	}
 
-	try
+	for (const std::exception_ptr& error : errors)
 	{
-		tank_path_starting_points = maps_json.at("spawntanks").get<std::vector<std::string>>();
+		if (error != nullptr)
+		{
+			for (unsigned int i = 0; i < candidates; ++i)
+			{
+				std::remove(candidate_filename(mission_filename, i).c_str());
+				std::remove(candidate_filename(wave_filename, i).c_str());
+			}
+			std::rethrow_exception(error);
+		}
 	}
-	catch (const std::exception&)
+
+	// Keep the best candidate. Ties go to the earliest candidate.
+	std::vector<float> scores(candidates);
+	unsigned int best = 0;
+	for (unsigned int i = 0; i < candidates; ++i)
 	{
-		// If there are no tank spawn points provided, just assume this map has no tanks.
+		scores.at(i) = scoring.score(results.at(i).duration, results.at(i).pressure_trace, max_time);
+		if (scores.at(i) < scores.at(best))
+		{
+			best = i;
+		}
 	}
 
-	try
+	for (unsigned int i = 0; i < candidates; ++i)
 	{
-		tankgen.set_max_tank_speed(maps_json.at("max_tank_speed").get<float>());
+		if (i == best)
+		{
+			std::remove(mission_filename.c_str());
+			std::remove(wave_filename.c_str());
+			std::rename(candidate_filename(mission_filename, i).c_str(), mission_filename.c_str());
+			std::rename(candidate_filename(wave_filename, i).c_str(), wave_filename.c_str());
+		}
+		else
+		{
+			std::remove(candidate_filename(mission_filename, i).c_str());
+			std::remove(candidate_filename(wave_filename, i).c_str());
+		}
 	}
-	catch (const std::exception&) {}
 
-	list_reader random_sound_reader;
-	const std::string file_sounds_standard = "data/sounds.txt";
-	const std::string file_sounds_vo = "data/sounds_vo.txt";
-	/*
-	// Preload the wacky sounds lists.
-	if (use_wacky_sounds != 0)
+	std::cout << "Kept candidate " << best + 1 << '/' << candidates << " with a score of " << scores.at(best)
+		<< " (the first candidate scored " << scores.front() << ")." << std::endl;
+
+	// The work done on the candidates that were thrown away was still done for this wave.
+	wave_result kept = results.at(best);
+	kept.counters = {};
+	for (const wave_result& result : results)
 	{
-		random_sound_reader.load(file_sounds_standard);
-		random_sound_reader.load(file_sounds_vo);
+		event_counters::accumulate(kept.counters, result.counters);
 	}
-	*/
+	return kept;
+}
 
-	std::stringstream filename;
-	filename << map_name << '_' << wave_pressure.get_players() << "p_" << mission_name << ".pop";
-	const std::string popfile_name = filename.str();
+wave_generator::wave_result wave_generator::generate_wave(int wave, const wave_checkpoint& checkpoint, const std::string& mission_filename, const std::string& wave_filename, bool report_progress)
+{
+	profiler::set_current_wave(wave);
+	profiler::scoped_timer wave_timer(profiler::phase::wave);
+	allocation_tracker::scoped_phase wave_allocations(allocation_tracker::phase::wave, wave);
+
+	// A wave depends on nothing but its checkpoint, so any wave generator can generate any wave.
+	current_wave = wave;
+	mission_currency.set_currency(checkpoint.currency);
+	botgen.set_giant_chance(checkpoint.giant_chance);
+	botgen.set_boss_chance(checkpoint.boss_chance);
+	rand_seed(checkpoint.seed);
+
+	wave_result result;
+	const unsigned int bots_generated_before = botgen.get_bots_generated();
+	const std::uint64_t measured_bytes_before = writer.get_measured_bytes();
+	const event_counters::values counters_before = event_counters::get_thread_values();
+	if (candidates > 1)
+	{
+		wave_pressure.set_pressure_trace(&result.pressure_trace);
+	}
 
-	const std::string tempdir = "temp_";
-	const std::string tempext = ".popt";
-	writer.popfile_open(tempdir + 'h' + tempext);
+	// The pieces are written to files of their own, but they go inside the WaveSchedule block.
+	writer.set_indent(1);
 
-	// Write the popfile header.
-	writer.write_popfile_header(version, argc, argv);
+	// This is the name of the wave_start_relay entity.
+	const std::string& wave_start_relay = profile.wave_start_relay;
+	const std::string& wave_finished_relay = profile.wave_finished_relay;
+	// This is the collection of possible starting points for each generic robot spawn.
+	const std::vector<std::string>& spawnbots = profile.spawnbots;
+	// This is the collection of possible starting points for each boss/mega robot spawn.
+	const std::vector<std::string>& spawnbots_mega = profile.spawnbots_mega;
+	// This is the collection of possible starting points for each doom robot spawn.
+	const std::vector<std::string>& spawnbots_doom = profile.spawnbots_doom;
 
-	writer.block_start("WaveSchedule");
+	wave_pressure.reset_pressure();
+	wave_pressure.clear_spawns();
+	wave_pressure.calculate_pressure_decay_rate();
 
-	// Write the WaveSchedule universal options.
-	writer.write("StartingCurrency", mission_currency.get_currency());
-	writer.write("RespawnWaveTime", respawn_wave_time);
-	if (event_popfile != 0)
+	if (report_progress)
 	{
-		writer.write("EventPopfile", event_popfile);
+		std::cout << "The pressure decay rate is " << wave_pressure.get_pressure_decay_rate() << '.' << std::endl;
 	}
-	if (fixed_respawn_wave_time)
+	//std::getchar();
+
+	// Cache the recipricol of the pressure decay rate for use in various calculations.
+	float recip_pressure_decay_rate = 1 / wave_pressure.get_pressure_decay_rate();
+
+	//std::cout << "recip_pressure_decay_rate: " << recip_pressure_decay_rate << '.' << std::endl;
+
+	// Let's generate the Sentry Buster Mission that coincides with this wave.
+
+	profiler::scoped_timer sentry_buster_timer(profiler::phase::sentry_buster);
+
+	tfbot_meta bot_meta = botgen.generate_bot();
+	tfbot& bot = bot_meta.get_bot();
+
+	if (rand_chance(0.95f) && !bot_meta.is_giant)
 	{
-		writer.write("FixedRespawnWaveTime", 1);
+		botgen.make_bot_into_giant(bot_meta);
 	}
-	writer.write("AddSentryBusterWhenDamageDealtExceeds", add_sentry_buster_when_damage_dealt_exceeds);
-	writer.write("AddSentryBusterWhenKillCountExceeds", add_sentry_buster_when_kill_count_exceeds);
-	if (can_bots_attack_while_in_spawn_room)
+
+	bot.class_icon = "sentry_buster";
+
+	int spawnbot_index = rand_int(0, spawnbots_mega.size());
+	std::string location = spawnbots_mega.at(spawnbot_index);
+
+	const float cooldown_time = std::min(120.0f, bot.health * recip_pressure_decay_rate * 3.5f * sentry_buster_cooldown);
+
+	mission mis;
+	mis.objective = "DestroySentries";
+	mis.initial_cooldown = 5;
+	mis.location = location;
+	mis.begin_at_wave = current_wave;
+	mis.run_for_this_many_waves = 1;
+	mis.cooldown_time = cooldown_time;
+	mis.bot = bot;
+
+	profiler::scoped_timer writing_timer(profiler::phase::writing);
+	allocation_tracker::scoped_phase writing_allocations(allocation_tracker::phase::writing);
+
+	// Without file names, the wave is only simulated.
+	if (mission_filename.empty())
 	{
-		writer.write("CanBotsAttackWhileInSpawnRoom", "yes");
+		if (measure_output)
+		{
+			writer.popfile_measure();
+		}
+		else
+		{
+			writer.popfile_discard();
+		}
 	}
 	else
 	{
-		writer.write("CanBotsAttackWhileInSpawnRoom", "no");
+		writer.popfile_open(mission_filename);
 	}
-	writer.write_blank();
 
-	writer.popfile_close();
+	writer.write_mission(mis, spawnbots);
 
-	if (doombot_enabled)
-	{
-		// Provide some leeway since the Doombot will be running around.
-		wave_pressure.multiply_pressure_decay_rate_multiplier(0.8f);
-	}
+	writer.popfile_close();
 
-	// Generate the actual waves!
-	while (current_wave < waves)
-	{
-		++current_wave;
+	writing_timer.stop();
+	writing_allocations.stop();
+	sentry_buster_timer.stop();
 
-		std::cout << "Generating wave " << current_wave << '/' << waves << '.' << std::endl;
+	// It's time to start generating the current wave.
 
-		std::stringstream filename_wave;
-		filename_wave << tempdir << 'w' << current_wave << tempext;
-		std::stringstream filename_mission;
-		filename_mission << tempdir << 'm' << current_wave << tempext;
+	// Our current position in time in the wave as we walk through the wave.
+	// We will use this to determine each WaveSpawn's WaitBeforeStarting value.
+	int t = 0;
+	// A vector of all wavespawns that have been instantiated so far.
+	std::vector<wavespawn> wavespawns;
+	// An unordered set of all of the icons that are part of the wave so far.
+	std::unordered_set<std::string> class_icons;
 
-		std::cout << "Wrote wave header." << std::endl;
+	// The last second that the Wavespawns ran for.
+	int last_t = 0;
 
-		wave_pressure.reset_pressure();
-		wave_pressure.calculate_pressure_decay_rate();
+	mission_currency.prepare_for_new_wave();
 
-		std::cout << "The pressure decay rate is " << wave_pressure.get_pressure_decay_rate() << '.' << std::endl;
-		//std::getchar();
+	if (report_progress)
+	{
+		std::cout << "Starting actual WaveSpawn generation..." << std::endl;
+	}
 
-		// Cache the recipricol of the pressure decay rate for use in various calculations.
-		float recip_pressure_decay_rate = 1 / wave_pressure.get_pressure_decay_rate();
+	// This loop generates all of the WaveSpawns.
+	while ((t < max_time || max_time == 0) &&
+		(wavespawns.size() < max_wavespawns || max_wavespawns == 0) && 
+		(class_icons.size() < max_icons || max_icons == 0) &&
+		!mission_currency.has_currency_per_wavespawn_hit_limit())
+	{
+		if (mission_currency.get_currency_per_wavespawn() != 0)
+		{
+			// Since the amount of total currency can be determined on the fly in this mode,
+			// we can make waves more difficult as they progress!
 
-		//std::cout << "recip_pressure_decay_rate: " << recip_pressure_decay_rate << '.' << std::endl;
+			wave_pressure.calculate_pressure_decay_rate();
 
-		// Let's generate the Sentry Buster Mission that coincides with this wave.
+			recip_pressure_decay_rate = 1 / wave_pressure.get_pressure_decay_rate();
+		}
 
-		tfbot_meta bot_meta = botgen.generate_bot();
-		tfbot& bot = bot_meta.get_bot();
+		//std::cout << "Generating new wavespawn at t = " << t << '.' << std::endl;
 
-		if (rand_chance(0.95f) && !bot_meta.is_giant)
+		// Generate the WaveSpawn. With several WaveSpawn candidates, keep the one that best fits the rest of the wave.
+		std::unique_ptr<wavespawn_candidate> best = generate_wavespawn(t, recip_pressure_decay_rate);
+		if (wavespawn_candidates > 1)
 		{
-			botgen.make_bot_into_giant(bot_meta);
+			float best_score = score_wavespawn(*best, t, class_icons);
+			for (unsigned int i = 1; i < wavespawn_candidates; ++i)
+			{
+				std::unique_ptr<wavespawn_candidate> candidate = generate_wavespawn(t, recip_pressure_decay_rate);
+				const float score = score_wavespawn(*candidate, t, class_icons);
+				if (score < best_score)
+				{
+					best = std::move(candidate);
+					best_score = score;
+				}
+			}
+		}
+		wavespawn& ws = best->ws;
+		virtual_wavespawn& vws = best->vws;
+		class_icons.emplace(best->class_icon);
+		result.health += best->health * ws.total_count;
+		if (vws.is_tank)
+		{
+			result.report.add_tanks(ws.total_count, best->health);
+		}
+		else
+		{
+			result.report.add_robots(best->cl, ws.total_count, best->health, best->is_giant, best->is_boss);
 		}
 
-		bot.class_icon = "sentry_buster";
+		//std::cout << "Wait between spawns: " << ws.wait_between_spawns;
+		//std::getchar();
 
-		int spawnbot_index = rand_int(0, spawnbots_mega.size());
-		std::string location = spawnbots_mega.at(spawnbot_index);
+		// Give the WaveSpawn a unique name.
+		std::stringstream wsname;
+		wsname << "\"wave" << current_wave << '_' << wavespawns.size() + 1 << '\"';
+		ws.name = wsname.str();
 
-		const float cooldown_time = std::min(120.0f, bot.health * recip_pressure_decay_rate * 3.5f * sentry_buster_cooldown);
+		if (mission_currency.get_currency_per_wavespawn() != 0)
+		{
+			int additional_currency = mission_currency.calculate_additional_currency_from_wavespawn();
+			ws.total_currency += additional_currency;
+			vws.currency_per_spawn = additional_currency / ws.total_count;
+			//std::cout << "wave_generator: Calculated additional currency from WaveSpawn: " << additional_currency << std::endl;
+			//std::getchar();
+		}
 
-		mission mis;
-		mis.objective = "DestroySentries";
-		mis.initial_cooldown = 5;
-		mis.location = location;
-		mis.begin_at_wave = current_wave;
-		mis.run_for_this_many_waves = 1;
-		mis.cooldown_time = cooldown_time;
-		mis.bot = bot;
+		if (doombot_enabled)
+		{
+			ws.support = wavespawn::support_type::limited;
+		}
 
-		writer.popfile_open(filename_mission.str());
+		// Add the virtual WaveSpawn to the pressure manager.
+		wave_pressure.add_virtual_wavespawn(vws);
+		// Add the actual WaveSpawn to the wavespawns vector.
+		wavespawns.emplace_back(ws);
 
-		writer.write_mission(mis, spawnbots);
+		// Time to do any final work before the next loop iteration (if there is one).
 
-		writer.popfile_close();
+		//std::cout << "wave_generator pressure (prior to pressure loop): " << wave_pressure.get_pressure() << std::endl;
 
-		// It's time to start generating the current wave.
+		// Step through time if necessary.
+		wave_pressure.step_through_time(t);
 
-		// Our current position in time in the wave as we walk through the wave.
-		// We will use this to determine each WaveSpawn's WaitBeforeStarting value.
-		int t = 0;
-		// A vector of all wavespawns that have been instantiated so far.
-		std::vector<wavespawn> wavespawns;
-		// An unordered set of all of the icons that are part of the wave so far.
-		std::unordered_set<std::string> class_icons;
+		//std::cout << "t = " << t << " (wave " << current_wave << '/' << waves << ')' << std::endl;
+	}
 
-		// The last second that the Wavespawns ran for.
-		int last_t = 0;
+	last_t = t;
 
-		mission_currency.prepare_for_new_wave();
+	if (report_progress)
+	{
+		std::cout << "Finished generating wave " << current_wave << ". Writing to temporary file..." << std::endl;
+	}
 
-		std::cout << "Starting actual WaveSpawn generation..." << std::endl;
+	// Finalize the currency total so far now that the wave is over.
+	mission_currency.add_currency_from_wave(wavespawns);
+
+	// Allow the bot generator to perform some preparations for the next wave.
+	botgen.wave_ended();
 
-		// This loop generates all of the WaveSpawns.
-		while ((t < max_time || max_time == 0) &&
-			(wavespawns.size() < max_wavespawns || max_wavespawns == 0) && 
-			(class_icons.size() < max_icons || max_icons == 0) &&
-			!mission_currency.has_currency_per_wavespawn_hit_limit())
+	// Time to write the wave to the disk.
+	profiler::scoped_timer wave_writing_timer(profiler::phase::writing);
+	allocation_tracker::scoped_phase wave_writing_allocations(allocation_tracker::phase::writing);
+	if (wave_filename.empty())
+	{
+		if (measure_output)
 		{
-			if (mission_currency.get_currency_per_wavespawn() != 0)
-			{
-				// Since the amount of total currency can be determined on the fly in this mode,
-				// we can make waves more difficult as they progress!
+			writer.popfile_measure();
+		}
+		else
+		{
+			writer.popfile_discard();
+		}
+	}
+	else
+	{
+		writer.popfile_open(wave_filename);
+	}
 
-				wave_pressure.calculate_pressure_decay_rate();
+	writer.write_wave_divider(current_wave);
+	writer.write(checkpoint.to_comment());
+	writer.write_wave_header(wave_start_relay, wave_finished_relay);
 
-				recip_pressure_decay_rate = 1 / wave_pressure.get_pressure_decay_rate();
-			}
+	// It's time to write the WaveSpawns.
 
-			//std::cout << "Generating new wavespawn at t = " << t << '.' << std::endl;
+	if (doombot_enabled)
+	{
+		// Generate the doombot!
+		botgen.set_generating_doombot(true);
+		tfbot_meta bot_meta = botgen.generate_bot();
+		tfbot& bot = bot_meta.get_bot();
+		botgen.set_generating_doombot(false);
 
-			// The WaveSpawn to generate.
-			wavespawn ws;
-			// Virtual representation of the WaveSpawn, to be used in pressure calculations.
-			virtual_wavespawn vws;
+		bot_meta.set_base_class_icon("boss");
+		//bot.attributes.emplace_back("IgnoreFlag");
 
-			// Randomly choose whether the WaveSpawn will be a Tank WaveSpawn or not.
-			const bool shall_be_tank = rand_chance(tank_chance) && tank_path_starting_points.size() != 0;
-			vws.is_tank = shall_be_tank;
+		bot.health = static_cast<int>(last_t * wave_pressure.get_pressure_decay_rate() * 0.01f);
+		result.health += bot.health;
+		result.report.add_robots(bot.cl, 1, bot.health, bot_meta.is_giant, true);
 
-			// The amount of time the WaveSpawn can fill.
-			int time_left;
+		/*
+		if (!bot_meta.is_always_fire_weapon)
+		{
+			bot.attributes.emplace_back("AlwaysFireWeapon");
+			bot_meta.is_always_fire_weapon = true;
+		}
+		*/
+
+		wavespawn ws;
+
+		std::stringstream wsname;
+		wsname << "\"wave" << current_wave << "_doombot\"";
+		ws.name = wsname.str();
+		ws.total_count = 1;
+		ws.wait_before_starting = 1.0f;
+		ws.wait_between_spawns = 1.0f;
+		//ws.time_to_kill_expires = ws.time_to_kill;
+		int spawnbot_index = rand_int(0, spawnbots_doom.size());
+		ws.location = spawnbots_doom.at(spawnbot_index);
+		ws.enemy = std::make_unique<tfbot>(bot);
+
+		writer.write_wavespawn(ws, spawnbots);
+	}
 
-			int effective_max_time;
-			if (shall_be_tank)
-			{
-				effective_max_time = max_tank_wavespawn_time;
-			}
-			else
-			{
-				effective_max_time = max_tfbot_wavespawn_time;
-			}
+	// Write all of the standard WaveSpawns.
+	for (const wavespawn& ws : wavespawns)
+	{
+		writer.write_wavespawn(ws, spawnbots);
+		result.report.currency_dropped += ws.total_currency;
+	}
 
-			if (max_time - t > 0)
+	// Write randomized sound WaveSpawns each second, if applicable.
+	if (use_wacky_sounds & 2)
+	{
+		int t = 0;
+		while (t < last_t)
+		{
+			writer.block_start("WaveSpawn");
+			std::string sound;
+			if (rand_chance(wacky_sound_vo_ratio))
 			{
-				time_left = std::min(max_time - t, effective_max_time);
+				sound = get_random_sound(*sounds_vo);
 			}
 			else
 			{
-				time_left = effective_max_time;
+				sound = get_random_sound(*sounds_standard);
 			}
+			writer.write("FirstSpawnWarningSound", '\"' + sound + '\"');
+			writer.write("WaitBeforeStarting", t);
+			writer.write("WaitBetweenSpawns", 1);
+			writer.block_end(); // WaveSpawn
+			++t;
+		}
+	}
 
-			if (shall_be_tank)
-			{
-				// Generate a new tank WaveSpawn.
+	writer.block_end(); // Wave
 
-				class_icons.emplace("tank");
-				
-				// Pass work to the tank generator.
-				// The resulting tank will have its HP and health set appropriately.
-				std::unique_ptr<tank> tnk = tankgen.generate_tank(max_time - t);
+	// Close the current wave file.
+	writer.popfile_close();
 
-				// If the user used certain command line inputs, overwrite the tank's HP and/or speed.
-				if (force_tank_hp != nullptr)
-				{
-					tnk->health = *force_tank_hp;
-				}
-				if (force_tank_speed != nullptr)
-				{
-					tnk->speed = *force_tank_speed;
-				}
+	wave_writing_timer.stop();
+	wave_writing_allocations.stop();
+
+	wave_pressure.set_pressure_trace(nullptr);
+
+	result.end.currency = mission_currency.get_currency();
+	result.end.giant_chance = botgen.get_giant_chance();
+	result.end.boss_chance = botgen.get_boss_chance();
+	result.duration = last_t;
+	result.wavespawns = static_cast<int>(wavespawns.size()) + (doombot_enabled ? 1 : 0);
+	result.bots = static_cast<int>(botgen.get_bots_generated() - bots_generated_before);
+	result.output_bytes = writer.get_measured_bytes() - measured_bytes_before;
+	result.peak_live_spawns = wave_pressure.get_peak_live_spawns();
+	result.report.number = current_wave;
+	result.report.duration = last_t;
+	result.report.wavespawns = result.wavespawns;
+	result.report.icons = static_cast<int>(class_icons.size());
+	result.report.peak_pressure = wave_pressure.get_peak_pressure();
+	result.report.mean_pressure = wave_pressure.get_mean_pressure();
+	result.report.currency_in = checkpoint.currency;
+	result.report.currency_out = result.end.currency;
+	result.counters = event_counters::difference(event_counters::get_thread_values(), counters_before);
+	if (profiler* prof = profiler::get_active())
+	{
+		prof->record_counters(current_wave, result.counters);
+	}
 
-				float effective_pressure = static_cast<float>(tnk->health);
-				// How long it should take to kill the theoretical tank.
-				float time_to_kill = effective_pressure * recip_pressure_decay_rate;
+	wave_timer.set_state({ last_t, wave_pressure.get_pressure(), wave_pressure.get_pressure_decay_rate(), wave_pressure.get_live_spawns() });
+	wave_timer.stop();
+	wave_allocations.stop();
+	profiler::set_current_wave(0);
 
-				float wait_between_spawns = time_to_kill * rand_float(1.0f, 5.0f);
-				int max_count = static_cast<int>(floor((time_left) / (wait_between_spawns)));
+	return result;
+}
 
-				/*
-				std::cout << "Tank speed / health: " << tnk.speed << " / " << tnk.health << std::endl;
-				std::cout << "Tank effective pressure: " << effective_pressure << std::endl;
-				std::cout << "Tank time to kill: " << time_to_kill << std::endl;
-				*/
+std::unique_ptr<wave_generator::wavespawn_candidate> wave_generator::generate_wavespawn(int t, float recip_pressure_decay_rate)
+{
+	// This is the collection of possible starting points for each generic robot spawn.
+	const std::vector<std::string>& spawnbots = profile.spawnbots;
+	// This is the collection of possible starting points for each large robot spawn.
+	const std::vector<std::string>& spawnbots_giant = profile.spawnbots_giant;
+	// This is the collection of possible starting points for each boss/mega robot spawn.
+	const std::vector<std::string>& spawnbots_mega = profile.spawnbots_mega;
+	// This is the collection of possible starting points for each doom robot spawn.
+	const std::vector<std::string>& spawnbots_doom = profile.spawnbots_doom;
+	// This is the collection of starting points for each tank path.
+	const std::vector<std::string>& tank_path_starting_points = profile.tank_path_starting_points;
 
-				ws.total_count = rand_int(1, max_count + 1);
-				ws.wait_before_starting = static_cast<float>(t);
-				ws.wait_between_spawns = wait_between_spawns;
-				ws.enemy = std::move(tnk);
-				// Choose a random path to start on.
-				int path_index = rand_int(0, tank_path_starting_points.size());
-				ws.location = '\"' + tank_path_starting_points.at(path_index) + '\"';
+	profiler::scoped_timer timer(profiler::phase::wavespawn);
+	timer.set_state({ t, wave_pressure.get_pressure(), wave_pressure.get_pressure_decay_rate(), wave_pressure.get_live_spawns() });
 
-				vws.effective_pressure = effective_pressure;
-				vws.time_to_kill = time_to_kill;
+	std::unique_ptr<wavespawn_candidate> candidate = std::make_unique<wavespawn_candidate>();
+	// The WaveSpawn to generate.
+	wavespawn& ws = candidate->ws;
+	// Virtual representation of the WaveSpawn, to be used in pressure calculations.
+	virtual_wavespawn& vws = candidate->vws;
 
-				//std::cout << "Generated Tank." << std::endl;
-			}
-			else
-			{
-				// Generate a new TFBot WaveSpawn.
+	// Randomly choose whether the WaveSpawn will be a Tank WaveSpawn or not.
+	const bool shall_be_tank = rand_chance(tank_chance) && tank_path_starting_points.size() != 0;
+	vws.is_tank = shall_be_tank;
 
-				tfbot_meta bot_meta = botgen.generate_bot();
-				tfbot& bot = bot_meta.get_bot();
+	// The amount of time the WaveSpawn can fill.
+	int time_left;
 
-				// How long it should take to kill the theoretical bot.
-				float time_to_kill;
+	int effective_max_time;
+	if (shall_be_tank)
+	{
+		effective_max_time = max_tank_wavespawn_time;
+	}
+	else
+	{
+		effective_max_time = max_tfbot_wavespawn_time;
+	}
 
-				float effective_pressure;
-				float wait_between_spawns;
-				int max_count = 0;
-				bool has_problem = false;
+	if (max_time - t > 0)
+	{
+		time_left = std::min(max_time - t, effective_max_time);
+	}
+	else
+	{
+		time_left = effective_max_time;
+	}
 
-				// Calculate WaveSpawn data for the TFBot.
-				// The following loop makes sure the TFBot doesn't have too much health to handle.
+	if (shall_be_tank)
+	{
+		// Generate a new tank WaveSpawn.
 
-				//std::cout << "Pre-TotalCount loop bot health: " << bot.health << std::endl;
-				//std::cout << "Pre-TotalCount loop bot pressure (without health): " << bot_meta.pressure << std::endl;
-				//std::cout << "Entering TFBot TotalCount calculation loop..." << std::endl;
+		candidate->class_icon = "tank";
+		
+		// Pass work to the tank generator.
+		// The resulting tank will have its HP and health set appropriately.
+		std::unique_ptr<tank> tnk = tankgen.generate_tank(max_time - t);
 
-				while (max_count == 0 || has_problem)
-				{
-					has_problem = false;
+		// If the user used certain command line inputs, overwrite the tank's HP and/or speed.
+		if (force_tank_hp != nullptr)
+		{
+			tnk->health = *force_tank_hp;
+		}
+		if (force_tank_speed != nullptr)
+		{
+			tnk->speed = *force_tank_speed;
+		}
 
-					effective_pressure = bot_meta.calculate_effective_pressure();
-					time_to_kill = effective_pressure * recip_pressure_decay_rate;
-					wait_between_spawns = time_to_kill;
-					max_count = static_cast<int>(floor(time_left / wait_between_spawns));
+		float effective_pressure = static_cast<float>(tnk->health);
+		// How long it should take to kill the theoretical tank.
+		float time_to_kill = effective_pressure * recip_pressure_decay_rate;
 
-					// If the max count is too low, it means the bot may be too strong.
-					if (max_count == 0 && bot.health > 25)
-					{
-						has_problem = true;
-						//max_count = 0;
-						// If the wave isn't almost over, keep dwindling the bot's health down.
-						if (max_time - t > 20)
-						{
-							bot.health = static_cast<int>(bot.health * 0.9f);
-						}
-						// If the wave is almost over...
-						else
-						{
-							// Just let the bot live at its full strength if it's strong, but not TOO strong.
-							max_count = static_cast<int>(floor(max_time / wait_between_spawns));
-							if (max_count != 0)
-							{
-								has_problem = false;
-								max_count = 1;
-							}
-							else
-							{
-								bot.health = static_cast<int>(bot.health * 0.9f);
-							}
-						}
-					}
-					else if (time_to_kill < 1.0f)
-					{
-						has_problem = true;
-						if (bot_meta.is_giant)
-						{
-							bot.health *= 2;
-						}
-						else if (!bot_meta.perma_small)
-						{
-							botgen.make_bot_into_giant(bot_meta);
-						}
-						else
-						{
-							bot.health *= 2;
-						}
-					}
-					else if (bot_meta.is_boss || bot.health <= 25)
-					{
-						max_count = 1;
-					}
-				}
+		float wait_between_spawns = time_to_kill * rand_float(1.0f, 5.0f);
+		int max_count = static_cast<int>(floor((time_left) / (wait_between_spawns)));
 
-				if (force_tfbot_hp != nullptr)
-				{
-					bot.health = *force_tfbot_hp;
-					effective_pressure = bot_meta.calculate_effective_pressure();
-				}
+		/*
+		std::cout << "Tank speed / health: " << tnk.speed << " / " << tnk.health << std::endl;
+		std::cout << "Tank effective pressure: " << effective_pressure << std::endl;
+		std::cout << "Tank time to kill: " << time_to_kill << std::endl;
+		*/
 
-				float wbs_multiplier;
-				wbs_multiplier = bot_meta.wait_between_spawns_multiplier;
-				// Add some variation to the wait between spawns.
-				wbs_multiplier *= rand_float(1.0f, 5.0f);
-				wait_between_spawns *= wbs_multiplier;
-				// Change the max count too.
-				max_count = ceil(static_cast<float>(max_count) / wbs_multiplier);
+		ws.total_count = rand_int(1, max_count + 1);
+		ws.wait_before_starting = static_cast<float>(t);
+		ws.wait_between_spawns = wait_between_spawns;
+		candidate->health = tnk->health;
+		ws.enemy = std::move(tnk);
+		// Choose a random path to start on.
+		int path_index = rand_int(0, tank_path_starting_points.size());
+		ws.location = '\"' + tank_path_starting_points.at(path_index) + '\"';
 
-				// Have the actual pressure be based on the bot's quantity of health.
-				effective_pressure = bot.health;
+		vws.effective_pressure = effective_pressure;
+		vws.time_to_kill = time_to_kill;
 
-				// Add a little bit of influence from the pressure itself.
-				//effective_pressure *= ((bot_meta.pressure - 1.0f) * 0.2f) + 1.0f;
+		//std::cout << "Generated Tank." << std::endl;
+	}
+	else
+	{
+		// Generate a new TFBot WaveSpawn.
 
-				// Formerly small bots with high health should potentially be made into giants without the additional bonuses.
-				if (!bot_meta.is_giant && !bot_meta.perma_small && bot.health >= 1000 && rand_chance(0.7f))
-				{
-					botgen.make_bot_into_giant_pure(bot_meta);
-					botgen.check_bot_scale(bot_meta);
-				}
-				// If Spies are too large, they'll get stuck in the walls and die when they spawn.
-				float constexpr max_spy_scale = 1.2f;
-				if (bot.cl == player_class::spy && (bot_meta.is_giant || bot.scale > max_spy_scale))
-				{
-					bot.scale = max_spy_scale;
-				}
+		tfbot_meta bot_meta = botgen.generate_bot();
+		tfbot& bot = bot_meta.get_bot();
 
-				/*
-				std::cout << "TotalCount calculation complete." << std::endl;
-				std::cout << "Post-TotalCount loop bot health: " << bot.health << std::endl;
-				std::cout << "The bot's raw pressure (without health): " << bot_meta.pressure << std::endl;
-				std::cout << "TotalCount (pre-write): " << max_count << std::endl;
-				std::cout << "WaitBetweenSpawns: " << wait_between_spawns << std::endl;
-				std::cout << "TFBot time to kill: " << time_to_kill << std::endl;
-				*/
+		// How long it should take to kill the theoretical bot.
+		float time_to_kill;
 
-				class_icons.emplace(bot.class_icon);
+		float effective_pressure;
+		float wait_between_spawns;
+		int max_count = 0;
+		bool has_problem = false;
 
-				//std::cout << "Total class icons so far: " << class_icons.size() << '.' << std::endl;
+		// Calculate WaveSpawn data for the TFBot.
+		// The following loop makes sure the TFBot doesn't have too much health to handle.
 
-				// It's time to pass all of this information to the actual WaveSpawn.
+		//std::cout << "Pre-TotalCount loop bot health: " << bot.health << std::endl;
+		//std::cout << "Pre-TotalCount loop bot pressure (without health): " << bot_meta.pressure << std::endl;
+		//std::cout << "Entering TFBot TotalCount calculation loop..." << std::endl;
 
-				if (bot.cl == player_class::engineer || bot.cl == player_class::medic)
-				{
-					// Reduce the total count of engies and medics.
-					max_count = static_cast<int>(std::ceil(static_cast<float>(max_count) * 0.2f));
-					ws.total_count = rand_int(1, max_count + 1);
-					int at_once_count;
-					switch (bot.cl)
-					{
-					case player_class::engineer:
-						at_once_count = 2;
-						break;
+		profiler::scoped_timer fitting_timer(profiler::phase::health_fitting);
+		while (max_count == 0 || has_problem)
+		{
+			event_counters::add(event_counters::counter::health_fitting_iterations);
+			has_problem = false;
 
-					case player_class::medic:
-						at_once_count = 3;
-						break;
-					}
-					ws.max_active = std::min(at_once_count, ws.total_count);
-				}
-				else
-				{
-					ws.total_count = rand_int(1, max_count + 1);
-					ws.max_active = std::min(22, ws.total_count);
-				}
-				ws.wait_before_starting = static_cast<float>(t);
-				ws.wait_between_spawns = wait_between_spawns;
-				ws.enemy = std::make_unique<tfbot>(bot);
-
-				// Decide on the possible locations at which to spawn based on the size of the robot.
-				// Larger robots get stuck in some wavespawns, so those wavespawns must be omitted.
-				std::vector<std::string>* possible_locations;
-				if (bot_meta.is_doom)
-				{
-					possible_locations = &spawnbots_doom;
-				}
-				else if (bot_meta.is_boss)
-				{
-					possible_locations = &spawnbots_mega;
-				}
-				else if (bot_meta.is_giant || bot.scale > 1.0f)
+			effective_pressure = bot_meta.calculate_effective_pressure();
+			time_to_kill = effective_pressure * recip_pressure_decay_rate;
+			wait_between_spawns = time_to_kill;
+			max_count = static_cast<int>(floor(time_left / wait_between_spawns));
+
+			// If the max count is too low, it means the bot may be too strong.
+			if (max_count == 0 && bot.health > 25)
+			{
+				has_problem = true;
+				//max_count = 0;
+				// If the wave isn't almost over, keep dwindling the bot's health down.
+				if (max_time - t > 20)
 				{
-					possible_locations = &spawnbots_giant;
+					bot.health = static_cast<int>(bot.health * 0.9f);
 				}
+				// If the wave is almost over...
 				else
 				{
-					possible_locations = &spawnbots;
-				}
-				int spawnbot_index = rand_int(0, possible_locations->size());
-				ws.location = possible_locations->at(spawnbot_index);
-
-				// If applicable, give the WaveSpawn a wacky FirstSpawnWarningSound.
-				if (use_wacky_sounds & 1)
-				{
-					std::string sound;
-					if (rand_chance(wacky_sound_vo_ratio))
+					// Just let the bot live at its full strength if it's strong, but not TOO strong.
+					max_count = static_cast<int>(floor(max_time / wait_between_spawns));
+					if (max_count != 0)
 					{
-						sound = random_sound_reader.get_random(file_sounds_vo);
+						has_problem = false;
+						max_count = 1;
 					}
 					else
 					{
-						sound = random_sound_reader.get_random(file_sounds_standard);
+						bot.health = static_cast<int>(bot.health * 0.9f);
 					}
-					ws.first_spawn_warning_sound = sound;
 				}
-
-				vws.effective_pressure = effective_pressure;
-				vws.time_to_kill = time_to_kill;
-
-				//std::cout << "Generated TFBot." << std::endl;
 			}
-
-			//std::cout << "Wait between spawns: " << ws.wait_between_spawns;
-			//std::getchar();
-
-			// Give the WaveSpawn a unique name.
-			std::stringstream wsname;
-			wsname << "\"wave" << current_wave << '_' << wavespawns.size() + 1 << '\"';
-			ws.name = wsname.str();
-
-			// Populate some common properties of virtual WaveSpawns.
-			vws.spawns_remaining = ws.total_count - 1;
-			vws.wait_between_spawns = ws.wait_between_spawns;
-			vws.time_until_next_spawn = ws.wait_between_spawns;
-
-			if (mission_currency.get_currency_per_wavespawn() != 0)
+			else if (time_to_kill < 1.0f)
 			{
-				int additional_currency = mission_currency.calculate_additional_currency_from_wavespawn();
-				ws.total_currency += additional_currency;
-				vws.currency_per_spawn = additional_currency / ws.total_count;
-				//std::cout << "wave_generator: Calculated additional currency from WaveSpawn: " << additional_currency << std::endl;
-				//std::getchar();
+				has_problem = true;
+				if (bot_meta.is_giant)
+				{
+					bot.health *= 2;
+				}
+				else if (!bot_meta.perma_small)
+				{
+					botgen.make_bot_into_giant(bot_meta);
+				}
+				else
+				{
+					bot.health *= 2;
+				}
 			}
-
-			if (doombot_enabled)
+			else if (bot_meta.is_boss || bot.health <= 25)
 			{
-				ws.support = wavespawn::support_type::limited;
+				max_count = 1;
 			}
+		}
+		fitting_timer.stop();
 
-			// Add the virtual WaveSpawn to the pressure manager.
-			wave_pressure.add_virtual_wavespawn(vws);
-			// Add the actual WaveSpawn to the wavespawns vector.
-			wavespawns.emplace_back(ws);
+		if (force_tfbot_hp != nullptr)
+		{
+			bot.health = *force_tfbot_hp;
+			effective_pressure = bot_meta.calculate_effective_pressure();
+		}
 
-			// Time to do any final work before the next loop iteration (if there is one).
+		float wbs_multiplier;
+		wbs_multiplier = bot_meta.wait_between_spawns_multiplier;
+		// Add some variation to the wait between spawns.
+		wbs_multiplier *= rand_float(1.0f, 5.0f);
+		wait_between_spawns *= wbs_multiplier;
+		// Change the max count too.
+		max_count = ceil(static_cast<float>(max_count) / wbs_multiplier);
 
-			//std::cout << "wave_generator pressure (prior to pressure loop): " << wave_pressure.get_pressure() << std::endl;
+		// Have the actual pressure be based on the bot's quantity of health.
+		effective_pressure = bot.health;
 
-			// Step through time if necessary.
-			wave_pressure.step_through_time(t);
+		// Add a little bit of influence from the pressure itself.
+		//effective_pressure *= ((bot_meta.pressure - 1.0f) * 0.2f) + 1.0f;
 
-			//std::cout << "t = " << t << " (wave " << current_wave << '/' << waves << ')' << std::endl;
+		// Formerly small bots with high health should potentially be made into giants without the additional bonuses.
+		if (!bot_meta.is_giant && !bot_meta.perma_small && bot.health >= 1000 && rand_chance(0.7f))
+		{
+			botgen.make_bot_into_giant_pure(bot_meta);
+			botgen.check_bot_scale(bot_meta);
+		}
+		// If Spies are too large, they'll get stuck in the walls and die when they spawn.
+		float constexpr max_spy_scale = 1.2f;
+		if (bot.cl == player_class::spy && (bot_meta.is_giant || bot.scale > max_spy_scale))
+		{
+			bot.scale = max_spy_scale;
 		}
 
-		last_t = t;
-
-		std::cout << "Finished generating wave " << current_wave << ". Writing to temporary file..." << std::endl;
-
-		// Finalize the currency total so far now that the wave is over.
-		mission_currency.add_currency_from_wave(wavespawns);
-
-		// Allow the bot generator to perform some preparations for the next wave.
-		botgen.wave_ended();
+		/*
+		std::cout << "TotalCount calculation complete." << std::endl;
+		std::cout << "Post-TotalCount loop bot health: " << bot.health << std::endl;
+		std::cout << "The bot's raw pressure (without health): " << bot_meta.pressure << std::endl;
+		std::cout << "TotalCount (pre-write): " << max_count << std::endl;
+		std::cout << "WaitBetweenSpawns: " << wait_between_spawns << std::endl;
+		std::cout << "TFBot time to kill: " << time_to_kill << std::endl;
+		*/
 
-		// Time to write the wave to the disk.
-		writer.popfile_open(filename_wave.str());
+		candidate->class_icon = bot.class_icon;
+		candidate->cl = bot.cl;
+		candidate->is_giant = bot_meta.is_giant;
+		candidate->is_boss = bot_meta.is_boss;
 
-		writer.write_wave_divider(current_wave);
-		writer.write_wave_header(wave_start_relay, wave_finished_relay);
+		//std::cout << "Total class icons so far: " << class_icons.size() << '.' << std::endl;
 
-		// It's time to write the WaveSpawns.
+		// It's time to pass all of this information to the actual WaveSpawn.
 
-		if (doombot_enabled)
+		if (bot.cl == player_class::engineer || bot.cl == player_class::medic)
 		{
-			// Generate the doombot!
-			botgen.set_generating_doombot(true);
-			tfbot_meta bot_meta = botgen.generate_bot();
-			tfbot& bot = bot_meta.get_bot();
-			botgen.set_generating_doombot(false);
-
-			bot_meta.set_base_class_icon("boss");
-			//bot.attributes.emplace_back("IgnoreFlag");
-
-			bot.health = static_cast<int>(last_t * wave_pressure.get_pressure_decay_rate() * 0.01f);
-
-			/*
-			if (!bot_meta.is_always_fire_weapon)
+			// Reduce the total count of engies and medics.
+			max_count = static_cast<int>(std::ceil(static_cast<float>(max_count) * 0.2f));
+			ws.total_count = rand_int(1, max_count + 1);
+			int at_once_count = 1;
+			switch (bot.cl)
 			{
-				bot.attributes.emplace_back("AlwaysFireWeapon");
-				bot_meta.is_always_fire_weapon = true;
-			}
-			*/
-
-			wavespawn ws;
+			case player_class::engineer:
+				at_once_count = 2;
+				break;
 
-			std::stringstream wsname;
-			wsname << "\"wave" << current_wave << "_doombot\"";
-			ws.name = wsname.str();
-			ws.total_count = 1;
-			ws.wait_before_starting = 1.0f;
-			ws.wait_between_spawns = 1.0f;
-			//ws.time_to_kill_expires = ws.time_to_kill;
-			int spawnbot_index = rand_int(0, spawnbots_doom.size());
-			ws.location = spawnbots_doom.at(spawnbot_index);
-			ws.enemy = std::make_unique<tfbot>(bot);
+			case player_class::medic:
+				at_once_count = 3;
+				break;
 
-			writer.write_wavespawn(ws, spawnbots);
+			default:
+				break;
+			}
+			ws.max_active = std::min(at_once_count, ws.total_count);
 		}
-
-		// Write all of the standard WaveSpawns.
-		for (const wavespawn& ws : wavespawns)
+		else
 		{
-			writer.write_wavespawn(ws, spawnbots);
+			ws.total_count = rand_int(1, max_count + 1);
+			ws.max_active = std::min(22, ws.total_count);
 		}
+		ws.wait_before_starting = static_cast<float>(t);
+		ws.wait_between_spawns = wait_between_spawns;
+		candidate->health = bot.health;
+		ws.enemy = std::make_unique<tfbot>(bot);
+
+		// Decide on the possible locations at which to spawn based on the size of the robot.
+		// Larger robots get stuck in some wavespawns, so those wavespawns must be omitted.
+		const std::vector<std::string>* possible_locations;
+		if (bot_meta.is_doom)
+		{
+			possible_locations = &spawnbots_doom;
+		}
+		else if (bot_meta.is_boss)
+		{
+			possible_locations = &spawnbots_mega;
+		}
+		else if (bot_meta.is_giant || bot.scale > 1.0f)
+		{
+			possible_locations = &spawnbots_giant;
+		}
+		else
+		{
+			possible_locations = &spawnbots;
+		}
+		int spawnbot_index = rand_int(0, possible_locations->size());
+		ws.location = possible_locations->at(spawnbot_index);
 
-		// Write randomized sound WaveSpawns each second, if applicable.
-		if (use_wacky_sounds & 2)
+		// If applicable, give the WaveSpawn a wacky FirstSpawnWarningSound.
+		if (use_wacky_sounds & 1)
 		{
-			int t = 0;
-			while (t < last_t)
+			std::string sound;
+			if (rand_chance(wacky_sound_vo_ratio))
 			{
-				writer.block_start("WaveSpawn");
-				std::string sound;
-				if (rand_chance(wacky_sound_vo_ratio))
-				{
-					sound = random_sound_reader.get_random(file_sounds_vo);
-				}
-				else
-				{
-					sound = random_sound_reader.get_random(file_sounds_standard);
-				}
-				writer.write("FirstSpawnWarningSound", '\"' + sound + '\"');
-				writer.write("WaitBeforeStarting", t);
-				writer.write("WaitBetweenSpawns", 1);
-				writer.block_end(); // WaveSpawn
-				++t;
+				sound = get_random_sound(*sounds_vo);
 			}
+			else
+			{
+				sound = get_random_sound(*sounds_standard);
+			}
+			ws.first_spawn_warning_sound = sound;
 		}
 
-		writer.block_end(); // Wave
+		vws.effective_pressure = effective_pressure;
+		vws.time_to_kill = time_to_kill;
 
-		// Close the current wave file.
-		writer.popfile_close();
+		//std::cout << "Generated TFBot." << std::endl;
 	}
 
-	std::cout << "Write complete. Concatenating pieces..." << std::endl;
+	// Populate some common properties of virtual WaveSpawns.
+	vws.spawns_remaining = ws.total_count - 1;
+	vws.wait_between_spawns = ws.wait_between_spawns;
+	vws.time_until_next_spawn = ws.wait_between_spawns;
 
-	// Concatenate all of the pieces into a single file!
-	writer.popfile_open(popfile_name);
+	return candidate;
+}
 
-	const std::string hfile = tempdir + 'h' + tempext;
-	writer.popfile_copy_write(hfile);
-	std::remove(hfile.c_str());
+float wave_generator::score_wavespawn(const wavespawn_candidate& candidate, int t, const std::unordered_set<std::string>& class_icons) const
+{
+	float score = 0.0f;
 
-	for (int i = 1; i <= waves; ++i)
+	// Simulate the WaveSpawn on copies of the pressure and currency, to see when the wave would be ready for the next WaveSpawn.
+	// If that's past the maximum wave time, this WaveSpawn ends the wave, so it should finish as close to that time as possible.
+	// Otherwise it only shouldn't keep spawning past the end of the wave.
+	if (max_time != 0)
 	{
-		std::stringstream filename_mission;
-		filename_mission << tempdir << 'm' << i << tempext;
-		writer.popfile_copy_write(filename_mission.str());
-		std::remove(filename_mission.str().c_str());
+		currency_manager currency_copy(mission_currency);
+		pressure_manager pressure_copy(wave_pressure, currency_copy);
+		pressure_copy.add_virtual_wavespawn(candidate.vws);
+		int next_t = t;
+		pressure_copy.step_through_time(next_t);
+
+		const float last_spawn = t + (candidate.ws.total_count - 1) * candidate.ws.wait_between_spawns;
+		if (next_t >= max_time)
+		{
+			score += std::abs(std::max(static_cast<float>(next_t), last_spawn) - max_time) / max_time;
+		}
+		else
+		{
+			score += std::max(0.0f, last_spawn - max_time) / max_time;
+		}
 	}
-	for (int i = 1; i <= waves; ++i)
+
+	// A new icon costs more the fewer icons the wave has left.
+	if (max_icons != 0 && class_icons.count(candidate.class_icon) == 0)
 	{
-		std::stringstream filename_wave;
-		filename_wave << tempdir << 'w' << i << tempext;
-		writer.popfile_copy_write(filename_wave.str());
-		std::remove(filename_wave.str().c_str());
+		const unsigned int icons_left = max_icons > class_icons.size() ? max_icons - static_cast<unsigned int>(class_icons.size()) : 1;
+		score += 1.0f / icons_left;
 	}
 
-	writer.block_end(); // WaveSchedule
-	writer.popfile_close();
-
-	std::cout << "Concatenation complete." << std::endl;
-	std::cout << "Popfile is ready for play." << std::endl;
+	return score;
 }
\ No newline at end of file
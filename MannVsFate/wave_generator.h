@@ -3,22 +3,35 @@
 
 #include "tfbot.h"
 #include "wavespawn.h"
+#include "virtual_wavespawn.h"
 #include "popfile_writer.h"
+#include "map_profile.h"
+#include "wave_checkpoint.h"
+#include "wave_scoring.h"
+#include "event_counters.h"
+#include "mission_report.h"
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
 
 class currency_manager;
 class pressure_manager;
 class bot_generator;
 class tank_generator;
+class generator_data;
 
 class wave_generator
 {
 public:
-	// Constructor.
-	wave_generator(currency_manager& cm, pressure_manager& pm, bot_generator& botgen, tank_generator& tankgen);
+	// Constructor. The map profiles and lists are borrowed from the generator data.
+	wave_generator(currency_manager& cm, pressure_manager& pm, bot_generator& botgen, tank_generator& tankgen, generator_data& data);
 	// Accessors.
 	void set_map_name(const std::string& in);
 	void set_mission_name(const std::string& in);
+	void set_output_directory(const std::string& in);
 	void set_waves(int in);
 	void set_respawn_wave_time(int in);
 	void set_event_popfile(int in);
@@ -39,11 +52,113 @@ public:
 	void set_force_tfbot_hp(int in);
 	void set_force_tank_hp(int in);
 	void set_force_tank_speed(float in);
+	void set_reroll_wave(int in);
+	int get_reroll_wave() const;
+	void set_candidates(unsigned int in);
+	unsigned int get_candidates() const;
+	void set_scoring_filename(const std::string& in);
+	void set_wavespawn_candidates(unsigned int in);
+	void set_measure_output(bool in);
+	void set_print_stats(bool in);
+	void set_write_report(bool in);
+	bool get_write_report() const;
+
+	// Add a wave generator to generate candidate waves on, in parallel with this one.
+	// It must be configured the same way as this one, and it has to outlive the call to generate_mission.
+	void add_candidate_generator(wave_generator& candidate_generator);
+
+	// Get the file name that the popfile will be written to with the current settings.
+	std::string get_popfile_name() const;
+	// Get the version of the wave generator.
+	static const std::string& get_version();
+
+	// The measurements of a simulated wave.
+	struct wave_summary
+	{
+		// How many seconds the wave lasts.
+		int duration;
+		// The total health of every robot and tank in the wave, including the Doombot.
+		int health;
+		// How many WaveSpawns the wave has, including the Doombot but not the sounds.
+		int wavespawns;
+		// How many TFBots were generated for the wave, including the Sentry Buster and any discarded WaveSpawn candidates.
+		int bots;
+		// How many bytes the wave and its Mission take up in the popfile. Only measured if the output is measured.
+		std::uint64_t output_bytes;
+		// How many times a TFBot's health and count were refitted to the time left in its WaveSpawn.
+		std::uint64_t health_fitting_iterations;
+		// The most virtual spawns that were alive at once in the pressure simulation.
+		std::uint64_t peak_live_spawns;
+	};
+
+	// Generate the mission without writing anything, and measure each of its waves.
+	std::vector<wave_summary> simulate_mission();
 
 	// Generate the mission. argc and argv are taken only to be printed in the mission file as debug info.
-	void generate_mission(int argc = 1, char** argv = nullptr);
+	// If a wave is being rerolled, only that wave is generated, starting from its checkpoint in the existing popfile, and spliced into it.
+	// Returns the file name of the popfile.
+	std::string generate_mission(int argc = 1, char** argv = nullptr);
 
 private:
+	// What generating one wave produced, apart from the popfile pieces.
+	struct wave_result
+	{
+		// The state that the next wave starts from. The seed is left for the next wave to draw.
+		wave_checkpoint end;
+		// How many seconds the wave lasts.
+		int duration = 0;
+		// The total health of every robot and tank in the wave, including the Doombot.
+		int health = 0;
+		// How many WaveSpawns the wave has, including the Doombot but not the sounds.
+		int wavespawns = 0;
+		// How many TFBots were generated for the wave.
+		int bots = 0;
+		// How many bytes the wave and its Mission take up in the popfile, if the output is measured.
+		std::uint64_t output_bytes = 0;
+		// The most virtual spawns that were alive at once in the pressure simulation.
+		std::uint64_t peak_live_spawns = 0;
+		// The pressure after each second of the wave. Only recorded when several candidates are generated for each wave.
+		std::vector<float> pressure_trace;
+		// The work done generating the wave. For the kept candidate of a wave, the work done generating every candidate.
+		event_counters::values counters = {};
+		// The statistics of the wave for the mission report.
+		mission_report::wave report;
+	};
+
+	// A WaveSpawn that has been generated but not added to the wave yet.
+	struct wavespawn_candidate
+	{
+		// The WaveSpawn, without its name or WaveSpawn currency, since those depend on it being added to the wave.
+		wavespawn ws;
+		// The simulated version of the WaveSpawn.
+		virtual_wavespawn vws = {};
+		// The icon that the WaveSpawn adds to the wave.
+		std::string class_icon;
+		// The health of each of the WaveSpawn's robots or tanks.
+		int health = 0;
+		// The class of the WaveSpawn's robots, and whether they're giants or bosses. Not used for tanks.
+		player_class cl = player_class::scout;
+		bool is_giant = false;
+		bool is_boss = false;
+	};
+
+	// Read the map's profile and every list that the mission can use, and configure the generators for the map.
+	void prepare_mission();
+	// Print event counters under a heading.
+	static void print_counters(const std::string& heading, const event_counters::values& counters);
+	// Generate a wave starting from its checkpoint, writing its Sentry Buster Mission and the wave itself to separate files.
+	// If the file names are empty, nothing is written.
+	// Progress messages are left out when reporting progress is off, since candidates are generated on several threads at once.
+	wave_result generate_wave(int wave, const wave_checkpoint& checkpoint, const std::string& mission_filename, const std::string& wave_filename, bool report_progress);
+	// Generate the candidates for a wave and keep the best scoring one in the given files.
+	// Returns the state that the next wave starts from.
+	wave_result generate_best_wave(int wave, const wave_checkpoint& checkpoint, const std::string& mission_filename, const std::string& wave_filename);
+	// Generate a WaveSpawn starting at second t of the current wave.
+	std::unique_ptr<wavespawn_candidate> generate_wavespawn(int t, float recip_pressure_decay_rate);
+	// Score how well a WaveSpawn starting at second t fits the rest of the wave. Lower scores are better.
+	// WaveSpawns are penalized for running past the end of the wave and for adding icons, more so the fewer icons the wave has left.
+	float score_wavespawn(const wavespawn_candidate& candidate, int t, const std::unordered_set<std::string>& class_icons) const;
+
 	// The version of the wave generator.
 	static const std::string version;
 
@@ -52,10 +167,19 @@ private:
 	pressure_manager& wave_pressure;
 	bot_generator& botgen;
 	tank_generator& tankgen;
+	generator_data& data;
 
 	// The popfile writer to use.
 	popfile_writer writer;
 
+	// The properties of the map being generated for.
+	map_profile profile;
+	// The randomized sound lists. nullptr unless the mission uses wacky sounds.
+	const std::vector<std::string_view>* sounds_standard;
+	const std::vector<std::string_view>* sounds_vo;
+	// Wave generators to generate candidate waves on in parallel. Not owned.
+	std::vector<wave_generator*> candidate_generators;
+
 	// The current wave being generated.
 	int current_wave;
 
@@ -78,6 +202,8 @@ private:
 	std::string map_name;
 	// The name of the mission (excluding the map name).
 	std::string mission_name;
+	// The directory to write the popfile to. Empty for the working directory.
+	std::string output_directory;
 	// The total number of waves.
 	int waves;
 	// The maximum number of wavespawns per wave.
@@ -108,6 +234,22 @@ private:
 	std::unique_ptr<int> force_tank_hp;
 	// If the pointed value exists, all Tanks will have this amount of speed.
 	std::unique_ptr<float> force_tank_speed;
+	// The wave to generate again and splice into the existing popfile. 0 generates the whole mission.
+	int reroll_wave;
+	// How many candidates to generate for each wave. Only the best scoring one is kept.
+	unsigned int candidates;
+	// The file to read the candidate scoring settings from.
+	std::string scoring_filename;
+	// How candidate waves are scored.
+	wave_scoring scoring;
+	// How many candidates to generate for each WaveSpawn. Only the one that best fits the rest of the wave is kept.
+	unsigned int wavespawn_candidates;
+	// Whether a simulated mission still formats its popfile, only counting the bytes instead of writing them.
+	bool measure_output;
+	// Whether to print the work done generating each wave.
+	bool print_stats;
+	// Whether to write the statistics of each wave as a report next to the popfile.
+	bool write_report;
 };
 
 #endif
\ No newline at end of file
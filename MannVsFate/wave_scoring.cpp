@@ -0,0 +1,68 @@
+#include "wave_scoring.h"
+#include <algorithm>
+#include <cmath>
+
+float wave_scoring::score(int duration, const std::vector<float>& pressure_trace, int max_time) const
+{
+	float duration_error = 0.0f;
+	if (max_time != 0 && target_duration > 0.0f)
+	{
+		const float target = target_duration * max_time;
+		duration_error = std::abs(duration - target) / target;
+	}
+
+	// The pressure error is the root mean square distance from the curve, relative to the curve's peak.
+	float pressure_error = 0.0f;
+	if (!pressure_curve.empty() && !pressure_trace.empty())
+	{
+		float peak = 0.0f;
+		for (const std::pair<float, float>& point : pressure_curve)
+		{
+			peak = std::max(peak, point.second);
+		}
+		if (peak <= 0.0f)
+		{
+			peak = 1.0f;
+		}
+
+		float sum = 0.0f;
+		for (std::size_t i = 0; i < pressure_trace.size(); ++i)
+		{
+			const float progress = static_cast<float>(i + 1) / pressure_trace.size();
+			const float difference = (pressure_trace.at(i) - get_target_pressure(progress)) / peak;
+			sum += difference * difference;
+		}
+		pressure_error = std::sqrt(sum / pressure_trace.size());
+	}
+
+	return duration_weight * duration_error + pressure_weight * pressure_error;
+}
+
+float wave_scoring::get_target_pressure(float progress) const
+{
+	if (pressure_curve.empty())
+	{
+		return 0.0f;
+	}
+	if (progress <= pressure_curve.front().first)
+	{
+		return pressure_curve.front().second;
+	}
+
+	for (std::size_t i = 1; i < pressure_curve.size(); ++i)
+	{
+		const std::pair<float, float>& next = pressure_curve.at(i);
+		if (progress <= next.first)
+		{
+			const std::pair<float, float>& previous = pressure_curve.at(i - 1);
+			const float span = next.first - previous.first;
+			if (span <= 0.0f)
+			{
+				return next.second;
+			}
+			return previous.second + (next.second - previous.second) * (progress - previous.first) / span;
+		}
+	}
+
+	return pressure_curve.back().second;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef WAVE_SCORING_H
+#define WAVE_SCORING_H
+
+#include <utility>
+#include <vector>
+
+// How candidate waves are scored against each other when several are generated for each wave. Lower scores are better.
+// Pressure is measured in seconds of pressure decay, which is how long the players would need to clear the robots left alive if no more spawned.
+struct wave_scoring
+{
+	// The duration to aim for, as a fraction of the maximum wave time.
+	float target_duration = 1.0f;
+	// How much straying from the target duration counts against a wave.
+	float duration_weight = 1.0f;
+	// How much straying from the pressure curve counts against a wave.
+	float pressure_weight = 1.0f;
+	// The pressure to aim for over the course of a wave, as (fraction of the wave's duration, pressure) points sorted by time.
+	// Between the points, the target pressure is interpolated linearly.
+	std::vector<std::pair<float, float>> pressure_curve;
+
+	// Score a wave from how long it lasts and the pressure at each of its seconds.
+	// If the maximum wave time is 0, waves have no time limit, so their duration isn't scored.
+	float score(int duration, const std::vector<float>& pressure_trace, int max_time) const;
+
+	// Get the target pressure at a fraction of the way through a wave.
+	float get_target_pressure(float progress) const;
+};
+
+#endif
\ No newline at end of file
@@ -28,7 +28,7 @@ weapon::~weapon()
 #endif
 }
 
-bool weapon::is_a(const std::string& name)
+bool weapon::is_a(const std::string& name) const
 {
 	for (unsigned int i = 0; i < names.size(); ++i)
 	{
@@ -40,12 +40,24 @@ bool weapon::is_a(const std::string& name)
 	return false;
 }
 
-std::string weapon::first_name() const
+bool weapon::is_a(const char* name) const
+{
+	for (unsigned int i = 0; i < names.size(); ++i)
+	{
+		if (names.at(i) == name)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+const std::string& weapon::first_name() const
 {
 	return names.at(0);
 }
 
-bool weapon::matches_restriction(weapon_restrictions restriction)
+bool weapon::matches_restriction(weapon_restrictions restriction) const
 {
 	if (type == slot::primary && (restriction == weapon_restrictions::primary || restriction == weapon_restrictions::none))
 	{
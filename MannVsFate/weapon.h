@@ -56,13 +56,15 @@ struct weapon
 	bool projectile_override_crash_risk;
 
 	// Returns true if the weapon or one of its parents has this name.
-	bool is_a(const std::string& name);
+	bool is_a(const std::string& name) const;
+	// Overload for string literals so that checking a name doesn't build a temporary string.
+	bool is_a(const char* name) const;
 
 	// Gets the least ancestral name of the weapon.
-	std::string first_name() const;
+	const std::string& first_name() const;
 
 	// Returns true if the weapon's slot matches a weapon restriction.
-	bool matches_restriction(weapon_restrictions restriction);
+	bool matches_restriction(weapon_restrictions restriction) const;
 };
 
 #endif // WEAPON_H
\ No newline at end of file
@@ -15,4 +15,9 @@ std::string weapon_restriction_to_string(const weapon_restrictions wr)
 	default:
 		throw std::exception("weapon_restriction_to_string exception: Invalid weapon_restrictions.");
 	}
+}
+
+unsigned int weapon_restriction_flag(const weapon_restrictions wr)
+{
+	return 1u << static_cast<int>(wr);
 }
\ No newline at end of file
@@ -13,4 +13,7 @@ enum class weapon_restrictions
 
 std::string weapon_restriction_to_string(const weapon_restrictions wr);
 
+// Returns the bit representing a weapon restriction in a bitmask of weapon restrictions.
+unsigned int weapon_restriction_flag(const weapon_restrictions wr);
+
 #endif // WEAPON_RESTRICTIONS_H
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "benchmark_runner.h"
+#include "time_util.h"
+#include "wave_generator.h"
+#include "json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+	// Benchmarked values are written here, which the compiler has to assume is observed.
+	volatile std::size_t sink = 0;
+
+	// Find the median of sorted values.
+	double median(const std::vector<double>& sorted)
+	{
+		const std::size_t middle = sorted.size() / 2;
+		if (sorted.size() % 2 == 0)
+		{
+			return (sorted.at(middle - 1) + sorted.at(middle)) * 0.5;
+		}
+		return sorted.at(middle);
+	}
+
+	// Find the mean of values.
+	double mean(const std::vector<double>& values)
+	{
+		double total = 0.0;
+		for (const double value : values)
+		{
+			total += value;
+		}
+		return total / values.size();
+	}
+
+	// Divide a count over the units of work that a benchmark did.
+	double per_unit(double count, const benchmark_runner::result& r)
+	{
+		return r.units != 0 ? count / r.units : 0.0;
+	}
+
+	// Find the median time that a unit of work took, which is the median time of an iteration if the work is measured in iterations.
+	double median_ns_per_unit(const benchmark_runner::result& r)
+	{
+		return per_unit(median(r.ns_per_iteration) * r.iterations * r.ns_per_iteration.size(), r);
+	}
+
+	// Find the instructions per cycle that a benchmark ran at.
+	double instructions_per_cycle(const benchmark_runner::result& r)
+	{
+		return r.hardware.cycles != 0 ? static_cast<double>(r.hardware.instructions) / r.hardware.cycles : 0.0;
+	}
+}
+
+benchmark_runner::benchmark_runner()
+	: min_time(50.0), repetitions(5), counters(nullptr)
+{}
+
+void benchmark_runner::set_min_time(double in)
+{
+	min_time = in;
+}
+
+void benchmark_runner::set_repetitions(unsigned int in)
+{
+	repetitions = std::max(1u, in);
+}
+
+void benchmark_runner::set_filter(const std::string& in)
+{
+	filter = in;
+}
+
+void benchmark_runner::set_hardware_counters(hardware_counters* in)
+{
+	counters = in;
+}
+
+void benchmark_runner::run(const std::string& name, const std::function<void(std::size_t)>& body)
+{
+	measure(name, nullptr, body);
+}
+
+void benchmark_runner::run(const std::string& name, event_counters::counter unit, const std::function<void(std::size_t)>& body)
+{
+	measure(name, &unit, body);
+}
+
+void benchmark_runner::measure(const std::string& name, const event_counters::counter* unit, const std::function<void(std::size_t)>& body)
+{
+	if (!filter.empty() && name.find(filter) == std::string::npos)
+	{
+		return;
+	}
+
+	// Find how many iterations take long enough. This also warms up the caches.
+	std::size_t iterations = 1;
+	while (true)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		body(iterations);
+		const double elapsed = milliseconds_between(start, std::chrono::steady_clock::now());
+		if (elapsed >= min_time)
+		{
+			break;
+		}
+		// Jump most of the way there once the elapsed time is measurable, rather than doubling many more times.
+		if (elapsed > min_time * 0.01)
+		{
+			iterations = static_cast<std::size_t>(std::ceil(iterations * min_time * 1.2 / elapsed));
+		}
+		else
+		{
+			iterations *= 2;
+		}
+	}
+
+	result r;
+	r.name = name;
+	r.iterations = iterations;
+	r.unit = unit != nullptr ? event_counters::get_counter_name(*unit) : "iteration";
+	r.units = 0;
+	r.has_hardware_counters = counters != nullptr;
+	r.hardware = {};
+	for (unsigned int i = 0; i < repetitions; ++i)
+	{
+		const event_counters::values events_before = event_counters::get_thread_values();
+		// The hardware counters are read inside of the timed region, since starting and stopping them only takes a couple of system calls.
+		const auto start = std::chrono::steady_clock::now();
+		if (counters != nullptr)
+		{
+			counters->start();
+		}
+		body(iterations);
+		if (counters != nullptr)
+		{
+			const hardware_counters::reading reading = counters->stop();
+			r.hardware.cycles += reading.cycles;
+			r.hardware.instructions += reading.instructions;
+			r.hardware.cache_misses += reading.cache_misses;
+			r.hardware.branch_misses += reading.branch_misses;
+		}
+		const double elapsed = milliseconds_between(start, std::chrono::steady_clock::now());
+		r.ns_per_iteration.emplace_back(elapsed * 1000000.0 / iterations);
+		r.units += unit != nullptr ? event_counters::get(event_counters::difference(event_counters::get_thread_values(), events_before), *unit) : iterations;
+	}
+	std::sort(r.ns_per_iteration.begin(), r.ns_per_iteration.end());
+
+	std::cout << std::left << std::setw(48) << name << std::right << std::setw(14) << median(r.ns_per_iteration) << " ns";
+	if (r.has_hardware_counters && r.hardware.cycles != 0)
+	{
+		std::cout << std::setw(8) << instructions_per_cycle(r) << " IPC";
+	}
+	std::cout << std::endl;
+	results.emplace_back(r);
+}
+
+void benchmark_runner::keep(std::size_t value)
+{
+	sink = sink + value;
+}
+
+const std::vector<benchmark_runner::result>& benchmark_runner::get_results() const
+{
+	return results;
+}
+
+void benchmark_runner::write_table(std::ostream& out) const
+{
+	out << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(14) << "Median ns" << std::setw(14) << "Min ns" << std::setw(14) << "Max ns" << std::setw(14) << "Iterations" << '\n';
+	for (const result& r : results)
+	{
+		out << std::left << std::setw(48) << r.name << std::right << std::setw(14) << median(r.ns_per_iteration)
+			<< std::setw(14) << r.ns_per_iteration.front() << std::setw(14) << r.ns_per_iteration.back() << std::setw(14) << r.iterations << '\n';
+	}
+
+	if (std::none_of(results.begin(), results.end(), [](const result& r) { return r.has_hardware_counters; }))
+	{
+		return;
+	}
+	out << "\nPer unit of work:\n";
+	out << std::left << std::setw(48) << "Benchmark" << std::setw(28) << "Unit" << std::right << std::setw(14) << "Median ns" << std::setw(14) << "Cycles"
+		<< std::setw(14) << "Instructions" << std::setw(10) << "IPC" << std::setw(14) << "Cache misses" << std::setw(14) << "Branch misses" << '\n';
+	for (const result& r : results)
+	{
+		if (!r.has_hardware_counters)
+		{
+			continue;
+		}
+		out << std::left << std::setw(48) << r.name << std::setw(28) << r.unit << std::right << std::setw(14) << median_ns_per_unit(r)
+			<< std::setw(14) << per_unit(static_cast<double>(r.hardware.cycles), r) << std::setw(14) << per_unit(static_cast<double>(r.hardware.instructions), r)
+			<< std::setw(10) << instructions_per_cycle(r) << std::setw(14) << per_unit(static_cast<double>(r.hardware.cache_misses), r)
+			<< std::setw(14) << per_unit(static_cast<double>(r.hardware.branch_misses), r) << '\n';
+	}
+}
+
+void benchmark_runner::write_json(std::ostream& out) const
+{
+	nlohmann::json benchmarks = nlohmann::json::array();
+	for (const result& r : results)
+	{
+		const double average = mean(r.ns_per_iteration);
+		double variance = 0.0;
+		for (const double ns : r.ns_per_iteration)
+		{
+			variance += (ns - average) * (ns - average);
+		}
+		variance /= r.ns_per_iteration.size();
+
+		nlohmann::json node;
+		node["name"] = r.name;
+		node["iterations"] = r.iterations;
+		node["repetitions"] = r.ns_per_iteration.size();
+		node["median_ns"] = median(r.ns_per_iteration);
+		node["mean_ns"] = average;
+		node["min_ns"] = r.ns_per_iteration.front();
+		node["max_ns"] = r.ns_per_iteration.back();
+		node["stddev_ns"] = std::sqrt(variance);
+		node["unit"] = r.unit;
+		node["units"] = r.units;
+		node["median_ns_per_unit"] = median_ns_per_unit(r);
+		if (r.has_hardware_counters)
+		{
+			nlohmann::json hardware;
+			hardware["cycles"] = r.hardware.cycles;
+			hardware["instructions"] = r.hardware.instructions;
+			hardware["cache_misses"] = r.hardware.cache_misses;
+			hardware["branch_misses"] = r.hardware.branch_misses;
+			hardware["ipc"] = instructions_per_cycle(r);
+			hardware["cycles_per_unit"] = per_unit(static_cast<double>(r.hardware.cycles), r);
+			hardware["instructions_per_unit"] = per_unit(static_cast<double>(r.hardware.instructions), r);
+			hardware["cache_misses_per_unit"] = per_unit(static_cast<double>(r.hardware.cache_misses), r);
+			hardware["branch_misses_per_unit"] = per_unit(static_cast<double>(r.hardware.branch_misses), r);
+			node["hardware"] = hardware;
+		}
+		benchmarks.push_back(node);
+	}
+
+	nlohmann::json root;
+	root["version"] = wave_generator::get_version();
+	root["min_time_ms"] = min_time;
+	root["benchmarks"] = benchmarks;
+	out << root.dump(1) << std::endl;
+}
\ No newline at end of file
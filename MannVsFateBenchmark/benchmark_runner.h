@@ -0,0 +1,81 @@
+// Times small pieces of the generator and collects the results, so that runs can be written as JSON and compared across commits.
+
+#ifndef BENCHMARK_RUNNER_H
+#define BENCHMARK_RUNNER_H
+
+#include "hardware_counters.h"
+#include "event_counters.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class benchmark_runner
+{
+public:
+	// The timings of one benchmark.
+	struct result
+	{
+		// The name of the benchmark.
+		std::string name;
+		// How many times the benchmarked code ran in each repetition.
+		std::size_t iterations;
+		// The nanoseconds per iteration of each repetition, sorted.
+		std::vector<double> ns_per_iteration;
+		// What the benchmark's work is measured in, such as a simulated second. "iteration" unless an event counter was given.
+		std::string unit;
+		// How many units of work were done over every repetition.
+		std::uint64_t units;
+		// Whether the hardware counters were read, and what they counted over every repetition.
+		bool has_hardware_counters;
+		hardware_counters::reading hardware;
+	};
+
+	// Constructor.
+	benchmark_runner();
+
+	// Set how long each repetition should take at least, in milliseconds.
+	void set_min_time(double in);
+	// Set how many times each benchmark is repeated.
+	void set_repetitions(unsigned int in);
+	// Only run benchmarks whose names contain this. Empty to run every benchmark.
+	void set_filter(const std::string& in);
+	// Read hardware counters around each repetition. nullptr to not read any.
+	void set_hardware_counters(hardware_counters* in);
+
+	// Time a benchmark. The body is given a number of iterations and should run the benchmarked code that many times.
+	// The number of iterations is doubled until a repetition takes long enough, so that the clock's resolution doesn't matter.
+	void run(const std::string& name, const std::function<void(std::size_t)>& body);
+	// Time a benchmark whose work is measured by an event counter rather than by iterations, such as the seconds that a simulation steps through.
+	void run(const std::string& name, event_counters::counter unit, const std::function<void(std::size_t)>& body);
+
+	// Keep a value alive so that the compiler can't optimize away the code that computed it.
+	static void keep(std::size_t value);
+
+	// Get the results of every benchmark that has run so far.
+	const std::vector<result>& get_results() const;
+
+	// Write the results as a human readable table.
+	void write_table(std::ostream& out) const;
+	// Write the results as JSON.
+	void write_json(std::ostream& out) const;
+
+private:
+	// How long each repetition should take at least, in milliseconds.
+	double min_time;
+	// How many times each benchmark is repeated.
+	unsigned int repetitions;
+	// Only benchmarks whose names contain this are run.
+	std::string filter;
+	// The hardware counters to read around each repetition. nullptr if there are none.
+	hardware_counters* counters;
+	// The results of every benchmark that has run so far.
+	std::vector<result> results;
+
+	// Time a benchmark. Its work is measured by the event counter if there's one, or else by its iterations.
+	void measure(const std::string& name, const event_counters::counter* unit, const std::function<void(std::size_t)>& body);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,338 @@
+#include "golden_verifier.h"
+#include "macro_benchmark.h"
+#include "popfile_generator.h"
+#include "wave_generator.h"
+#include "rand_util.h"
+#include "json.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+	// One configuration of the matrix: a .bat file and arguments to add to it.
+	struct matrix_entry
+	{
+		std::string config;
+		std::vector<std::string> extra_arguments;
+	};
+
+	// The configurations cover the options that change how waves are generated, rather than every .bat file, so that verifying is quick.
+	const std::vector<matrix_entry> matrix =
+	{
+		{ "bigrock_3.bat", {} },
+		{ "bigrock_3.bat", { "-candidates", "3" } },
+		{ "bigrock_8tanks.bat", {} },
+		{ "coaltown_4_snd.bat", {} },
+		{ "decoy_4_doombot.bat", {} },
+		{ "mannhattan_5_scouts.bat", {} },
+		{ "rottenburg_3_tiny.bat", {} },
+		{ "example.bat", { "-cosmetics" } },
+		{ "swift.bat", {} }
+	};
+
+	// Each configuration is generated with each of these seeds.
+	const unsigned int seeds[] = { 1, 2 };
+
+	// Where the popfiles are written before they're hashed. It's removed afterwards.
+	const std::string scratch_directory = "golden_temp";
+
+	// Throws away everything written to it.
+	class null_buffer : public std::streambuf
+	{
+	protected:
+		int_type overflow(int_type c) override
+		{
+			return traits_type::not_eof(c);
+		}
+	};
+
+	// Silences std::cout while it's alive, since generating a mission prints the progress of every wave.
+	class quiet_scope
+	{
+	public:
+		quiet_scope()
+			: previous(std::cout.rdbuf(&discarded))
+		{}
+		~quiet_scope()
+		{
+			std::cout.rdbuf(previous);
+		}
+
+		quiet_scope(const quiet_scope&) = delete;
+		quiet_scope& operator=(const quiet_scope&) = delete;
+
+	private:
+		null_buffer discarded;
+		std::streambuf* previous;
+	};
+
+	// Describe a run the way it would be typed.
+	std::string describe(const golden_verifier::run& r)
+	{
+		std::string description = r.config;
+		for (const std::string& arg : r.extra_arguments)
+		{
+			description += ' ' + arg;
+		}
+		return description + " -seed " + std::to_string(r.seed);
+	}
+
+	// Whether two measurements are within a fraction of each other.
+	bool within(std::uint64_t golden, std::uint64_t actual, double tolerance)
+	{
+		const double difference = std::abs(static_cast<double>(golden) - static_cast<double>(actual));
+		return difference <= tolerance * std::max(golden, actual);
+	}
+
+	nlohmann::json to_json(const golden_verifier::run& r)
+	{
+		nlohmann::json waves = nlohmann::json::array();
+		for (const golden_verifier::wave_stats& w : r.waves)
+		{
+			nlohmann::json node;
+			node["duration"] = w.duration;
+			node["health"] = w.health;
+			node["wavespawns"] = w.wavespawns;
+			node["bots"] = w.bots;
+			node["output_bytes"] = w.output_bytes;
+			node["peak_live_spawns"] = w.peak_live_spawns;
+			waves.push_back(node);
+		}
+
+		nlohmann::json node;
+		node["config"] = r.config;
+		node["extra_arguments"] = r.extra_arguments;
+		node["seed"] = r.seed;
+		node["hash"] = r.hash;
+		node["waves"] = waves;
+		return node;
+	}
+
+	golden_verifier::run from_json(const nlohmann::json& node)
+	{
+		golden_verifier::run r;
+		r.config = node.at("config").get<std::string>();
+		r.extra_arguments = node.at("extra_arguments").get<std::vector<std::string>>();
+		r.seed = node.at("seed").get<unsigned int>();
+		r.hash = node.at("hash").get<std::string>();
+		for (const nlohmann::json& wave : node.at("waves"))
+		{
+			golden_verifier::wave_stats w;
+			w.duration = wave.at("duration").get<std::uint64_t>();
+			w.health = wave.at("health").get<std::uint64_t>();
+			w.wavespawns = wave.at("wavespawns").get<std::uint64_t>();
+			w.bots = wave.at("bots").get<std::uint64_t>();
+			w.output_bytes = wave.at("output_bytes").get<std::uint64_t>();
+			w.peak_live_spawns = wave.at("peak_live_spawns").get<std::uint64_t>();
+			r.waves.emplace_back(w);
+		}
+		return r;
+	}
+
+	// Read the golden runs.
+	nlohmann::json read_golden(const std::string& golden_filename)
+	{
+		std::ifstream file(golden_filename);
+		if (!file)
+		{
+			const std::string exstr = "golden_verifier exception: Couldn't read the golden file \"" + golden_filename + "\".";
+			throw std::exception(exstr.c_str());
+		}
+		return nlohmann::json::parse(file);
+	}
+}
+
+golden_verifier::golden_verifier(generator_data& data, const std::string& bat_directory)
+	: data(data), bat_directory(bat_directory), tolerance(0.0)
+{}
+
+void golden_verifier::set_tolerance(double in)
+{
+	tolerance = std::max(0.0, in);
+}
+
+void golden_verifier::bless(const std::string& golden_filename)
+{
+	nlohmann::json runs = nlohmann::json::array();
+	for (const matrix_entry& entry : matrix)
+	{
+		for (const unsigned int seed : seeds)
+		{
+			const run r = generate(entry.config, entry.extra_arguments, seed);
+			std::cout << describe(r) << ": " << r.hash << std::endl;
+			runs.push_back(to_json(r));
+		}
+	}
+
+	std::ofstream file(golden_filename);
+	if (!file)
+	{
+		const std::string exstr = "golden_verifier::bless exception: Couldn't write the golden file \"" + golden_filename + "\".";
+		throw std::exception(exstr.c_str());
+	}
+	file << runs.dump(1) << std::endl;
+	std::cout << "Blessed " << runs.size() << " runs as the golden runs in " << golden_filename << '.' << std::endl;
+}
+
+bool golden_verifier::verify(const std::string& golden_filename)
+{
+	const nlohmann::json golden = read_golden(golden_filename);
+	std::cout << "Verifying against the golden runs in " << golden_filename << '.' << std::endl << std::endl;
+
+	unsigned int matched = 0;
+	unsigned int tolerated = 0;
+	unsigned int mismatched = 0;
+	for (const nlohmann::json& node : golden)
+	{
+		const run expected = from_json(node);
+		const run actual = generate(expected.config, expected.extra_arguments, expected.seed);
+		switch (compare(expected, actual))
+		{
+		case outcome::match:
+			++matched;
+			std::cout << describe(actual) << ": match" << std::endl;
+			break;
+		case outcome::within_tolerance:
+			++tolerated;
+			std::cout << describe(actual) << ": within tolerance (hash " << actual.hash << ", golden " << expected.hash << ')' << std::endl;
+			break;
+		case outcome::mismatch:
+			++mismatched;
+			std::cout << describe(actual) << ": MISMATCH (hash " << actual.hash << ", golden " << expected.hash << ')' << std::endl;
+			break;
+		}
+	}
+
+	std::cout << std::endl << matched << " matched, " << tolerated << " within tolerance, " << mismatched << " mismatched." << std::endl;
+	return mismatched == 0;
+}
+
+golden_verifier::run golden_verifier::generate(const std::string& config, const std::vector<std::string>& extra_arguments, unsigned int seed) const
+{
+	// The arguments are passed on the way that main would get them.
+	std::vector<std::string> args = macro_benchmark::read_bat((std::filesystem::path(bat_directory) / config).string());
+	args.insert(args.begin(), "MannVsFate.exe");
+	args.insert(args.end(), extra_arguments.begin(), extra_arguments.end());
+	args.emplace_back("-seed");
+	args.emplace_back(std::to_string(seed));
+	std::vector<char*> argv;
+	for (std::string& arg : args)
+	{
+		argv.emplace_back(&arg.front());
+	}
+	const int argc = static_cast<int>(argv.size());
+
+	run r;
+	r.config = config;
+	r.extra_arguments = extra_arguments;
+	r.seed = seed;
+
+	const quiet_scope quiet;
+
+	// The popfile is generated the way that the generator would, seeding included.
+	std::filesystem::create_directories(scratch_directory);
+	{
+		popfile_generator popgen(data);
+		popgen.apply_arguments(argc, argv.data());
+		popgen.set_output_directory(scratch_directory);
+		const std::string popfile_name = popgen.generate(argc, argv.data());
+		r.hash = hash_popfile(popfile_name);
+	}
+	std::filesystem::remove_all(scratch_directory);
+
+	// The waves are simulated separately to measure them, since generating the popfile doesn't.
+	popfile_generator popgen(data);
+	popgen.apply_arguments(argc, argv.data());
+	popgen.set_measure_output(true);
+	rand_seed(seed);
+	for (const wave_generator::wave_summary& summary : popgen.simulate())
+	{
+		wave_stats w;
+		w.duration = summary.duration;
+		w.health = summary.health;
+		w.wavespawns = summary.wavespawns;
+		w.bots = summary.bots;
+		w.output_bytes = summary.output_bytes;
+		w.peak_live_spawns = summary.peak_live_spawns;
+		r.waves.emplace_back(w);
+	}
+	return r;
+}
+
+golden_verifier::outcome golden_verifier::compare(const run& golden, const run& actual) const
+{
+	const auto same_waves = [&](double allowed)
+	{
+		if (golden.waves.size() != actual.waves.size())
+		{
+			return false;
+		}
+		for (std::size_t i = 0; i < golden.waves.size(); ++i)
+		{
+			const wave_stats& g = golden.waves.at(i);
+			const wave_stats& a = actual.waves.at(i);
+			if (!within(g.duration, a.duration, allowed) || !within(g.health, a.health, allowed) ||
+				!within(g.wavespawns, a.wavespawns, allowed) || !within(g.bots, a.bots, allowed) ||
+				!within(g.output_bytes, a.output_bytes, allowed) || !within(g.peak_live_spawns, a.peak_live_spawns, allowed))
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+
+	if (golden.hash == actual.hash && same_waves(0.0))
+	{
+		return outcome::match;
+	}
+	if (tolerance > 0.0 && same_waves(tolerance))
+	{
+		return outcome::within_tolerance;
+	}
+	return outcome::mismatch;
+}
+
+std::string golden_verifier::hash_popfile(const std::string& filename)
+{
+	std::ifstream file(filename, std::ios::binary);
+	if (!file)
+	{
+		const std::string exstr = "golden_verifier::hash_popfile exception: Couldn't read \"" + filename + "\".";
+		throw std::exception(exstr.c_str());
+	}
+
+	// 64 bit FNV-1a, which is the same on every platform, unlike std::hash.
+	std::uint64_t hash = 14695981039346656037ull;
+	bool in_header = true;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+		// The header is the comments and blank lines before the WaveSchedule.
+		if (in_header && (line.empty() || line.compare(0, 2, "//") == 0))
+		{
+			continue;
+		}
+		in_header = false;
+
+		line += '\n';
+		for (const char c : line)
+		{
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 1099511628211ull;
+		}
+	}
+
+	std::ostringstream hex;
+	hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+	return hex.str();
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+// Checks that the generator's output hasn't changed, so that optimizations can land without changing any missions.
+// A fixed matrix of REDIST configurations is generated with fixed seeds. The popfile of each is hashed, and each of its waves is simulated and measured.
+// The hashes and the measurements are compared with golden ones that are checked in, or blessed as the new golden ones.
+// rand_util draws its random numbers the same way with every standard library, so one set of golden runs serves every build.
+
+#ifndef GOLDEN_VERIFIER_H
+#define GOLDEN_VERIFIER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class generator_data;
+
+class golden_verifier
+{
+public:
+	// The measurements of one simulated wave.
+	struct wave_stats
+	{
+		std::uint64_t duration;
+		std::uint64_t health;
+		std::uint64_t wavespawns;
+		std::uint64_t bots;
+		std::uint64_t output_bytes;
+		std::uint64_t peak_live_spawns;
+	};
+
+	// One configuration of the matrix and what generating it gave.
+	struct run
+	{
+		// The name of the .bat file.
+		std::string config;
+		// Arguments added after the .bat file's own.
+		std::vector<std::string> extra_arguments;
+		// The seed that the mission is generated with.
+		unsigned int seed;
+		// The hash of the popfile, from its WaveSchedule on, as 16 hexadecimal digits.
+		std::string hash;
+		// The measurements of each wave.
+		std::vector<wave_stats> waves;
+	};
+
+	// How a run compared with its golden run.
+	enum class outcome
+	{
+		// The hash and every measurement are the same.
+		match,
+		// The hash differs, but every measurement is within the tolerance.
+		within_tolerance,
+		// The hash differs, and so does some measurement.
+		mismatch
+	};
+
+	// Constructor. The configurations are read from the .bat files in a directory.
+	golden_verifier(generator_data& data, const std::string& bat_directory);
+
+	// Accept a hash that differs as long as every measurement is within this fraction of its golden value. 0 to require the hashes to match.
+	void set_tolerance(double in);
+
+	// Generate the matrix and write it as the golden runs.
+	void bless(const std::string& golden_filename);
+
+	// Generate every golden run again and compare. Returns whether every run matched or was within the tolerance.
+	// Throws if the golden runs can't be read.
+	bool verify(const std::string& golden_filename);
+
+private:
+	// Generate one configuration of the matrix.
+	run generate(const std::string& config, const std::vector<std::string>& extra_arguments, unsigned int seed) const;
+
+	// Compare a run with its golden run.
+	outcome compare(const run& golden, const run& actual) const;
+
+	// Hash a popfile, leaving out the comments at its top, which hold the version and the arguments.
+	// Line endings are normalized, so that the hash doesn't depend on the platform that wrote the file.
+	static std::string hash_popfile(const std::string& filename);
+
+	// The data that the generators are constructed with.
+	generator_data& data;
+	// The directory with the .bat files.
+	std::string bat_directory;
+	// The fraction that a measurement can differ by when the hashes differ.
+	double tolerance;
+};
+
+#endif
\ No newline at end of file
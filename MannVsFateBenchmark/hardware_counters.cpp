@@ -0,0 +1,150 @@
+#include "hardware_counters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace
+{
+	// The events of the group, in the order of the reading's fields.
+	const std::uint64_t events[] =
+	{
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES
+	};
+
+	constexpr std::size_t event_count = sizeof(events) / sizeof(events[0]);
+
+	// What reading the group leader gives with the read format below.
+	struct group_read
+	{
+		std::uint64_t nr;
+		std::uint64_t time_enabled;
+		std::uint64_t time_running;
+		std::uint64_t values[event_count];
+	};
+
+	// glibc doesn't wrap the system call.
+	int perf_event_open(perf_event_attr& attr, int group_fd)
+	{
+		return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+	}
+}
+
+hardware_counters::hardware_counters()
+{
+	for (const std::uint64_t event : events)
+	{
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = event;
+		// The group only counts between start and stop, which enable and disable the leader.
+		attr.disabled = descriptors.empty() ? 1 : 0;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		const int fd = perf_event_open(attr, descriptors.empty() ? -1 : descriptors.front());
+		if (fd == -1)
+		{
+			error = std::string("perf_event_open failed: ") + std::strerror(errno) + '.';
+			if (errno == EACCES || errno == EPERM)
+			{
+				error += " Lower /proc/sys/kernel/perf_event_paranoid to 2 or below to allow it.";
+			}
+			else if (errno == ENOENT || errno == EOPNOTSUPP)
+			{
+				error += " The CPU, or the virtual machine, doesn't expose this hardware counter.";
+			}
+			for (const int opened : descriptors)
+			{
+				close(opened);
+			}
+			descriptors.clear();
+			return;
+		}
+		descriptors.emplace_back(fd);
+	}
+}
+
+hardware_counters::~hardware_counters()
+{
+	for (const int fd : descriptors)
+	{
+		close(fd);
+	}
+}
+
+void hardware_counters::start()
+{
+	if (descriptors.empty())
+	{
+		return;
+	}
+	ioctl(descriptors.front(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(descriptors.front(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+hardware_counters::reading hardware_counters::stop()
+{
+	reading r = {};
+	if (descriptors.empty())
+	{
+		return r;
+	}
+	ioctl(descriptors.front(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+	group_read values = {};
+	if (read(descriptors.front(), &values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)) || values.time_running == 0)
+	{
+		return r;
+	}
+
+	const double scale = static_cast<double>(values.time_enabled) / values.time_running;
+	const auto scaled = [&](std::size_t i)
+	{
+		return static_cast<std::uint64_t>(values.values[i] * scale);
+	};
+	r.cycles = scaled(0);
+	r.instructions = scaled(1);
+	r.cache_misses = scaled(2);
+	r.branch_misses = scaled(3);
+	return r;
+}
+
+#else
+
+hardware_counters::hardware_counters()
+	: error("Hardware counters are only read on Linux.")
+{}
+
+hardware_counters::~hardware_counters()
+{}
+
+void hardware_counters::start()
+{}
+
+hardware_counters::reading hardware_counters::stop()
+{
+	return reading();
+}
+
+#endif
+
+bool hardware_counters::is_available() const
+{
+	return !descriptors.empty();
+}
+
+const std::string& hardware_counters::get_error() const
+{
+	return error;
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+// Reads the CPU's hardware performance counters around a region of code with Linux's perf_event_open.
+// The counters are opened as one group on the calling thread, counting user space only, so that an unprivileged user can read them.
+// On other platforms, or where the kernel or the CPU doesn't allow it, the counters are unavailable and the reason is kept.
+
+#ifndef HARDWARE_COUNTERS_H
+#define HARDWARE_COUNTERS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class hardware_counters
+{
+public:
+	// What the counters counted over a region.
+	struct reading
+	{
+		std::uint64_t cycles;
+		std::uint64_t instructions;
+		// Last level cache misses.
+		std::uint64_t cache_misses;
+		std::uint64_t branch_misses;
+	};
+
+	// Constructor. Opens the counters for the calling thread, which is the only thread they count.
+	hardware_counters();
+	// Destructor. Closes the counters.
+	~hardware_counters();
+
+	// Whether the counters could be opened.
+	bool is_available() const;
+	// Get why the counters couldn't be opened.
+	const std::string& get_error() const;
+
+	// Start counting from zero.
+	void start();
+	// Stop counting and read the counters.
+	// If the kernel had to share the hardware with other counters, the counts are scaled up to the whole region.
+	reading stop();
+
+	hardware_counters(const hardware_counters&) = delete;
+	hardware_counters& operator=(const hardware_counters&) = delete;
+
+private:
+	// The file descriptors of the counters, in the order of the reading's fields. The first one leads the group.
+	std::vector<int> descriptors;
+	// Why the counters couldn't be opened. Empty if they could.
+	std::string error;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,306 @@
+#include "macro_benchmark.h"
+#include "popfile_generator.h"
+#include "wave_generator.h"
+#include "rand_util.h"
+#include "time_util.h"
+#include "json.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#define popen _popen
+#define pclose _pclose
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+	// A child process prints its result on a line starting with this.
+	const std::string result_prefix = "MACRO_RESULT ";
+
+	// Get the most memory this process has had resident, in kilobytes.
+	std::uint64_t get_peak_rss_kb()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			return counters.PeakWorkingSetSize / 1024;
+		}
+		return 0;
+#else
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		// Linux reports kilobytes.
+		return static_cast<std::uint64_t>(usage.ru_maxrss);
+#endif
+	}
+
+	// Quote an argument for the shell.
+	std::string quote(const std::string& arg)
+	{
+		return '"' + arg + '"';
+	}
+}
+
+macro_benchmark::macro_benchmark(const std::string& program, unsigned int seed)
+	: program(program), seed(seed)
+{}
+
+void macro_benchmark::set_filter(const std::string& in)
+{
+	filter = in;
+}
+
+void macro_benchmark::run_all(const std::string& directory)
+{
+	std::vector<std::string> bat_filenames;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory))
+	{
+		const std::filesystem::path& path = entry.path();
+		if (entry.is_regular_file() && path.extension() == ".bat" &&
+			(filter.empty() || path.filename().string().find(filter) != std::string::npos))
+		{
+			bat_filenames.emplace_back(path.string());
+		}
+	}
+	std::sort(bat_filenames.begin(), bat_filenames.end());
+
+	for (const std::string& bat_filename : bat_filenames)
+	{
+		run_child(bat_filename);
+	}
+
+	for (const auto& failure : failures)
+	{
+		std::cout << failure.first << " failed: " << failure.second << std::endl;
+	}
+}
+
+void macro_benchmark::run_child(const std::string& bat_filename)
+{
+	std::string command = quote(program) + " -macrorun " + quote(bat_filename) + " -seed " + std::to_string(seed);
+#ifdef _WIN32
+	// cmd strips the outer quotes of a command that starts with one.
+	command = quote(command);
+#endif
+
+	const std::string config = std::filesystem::path(bat_filename).filename().string();
+	std::cout << "Running " << config << "..." << std::endl;
+
+	FILE* child = popen(command.c_str(), "r");
+	if (child == nullptr)
+	{
+		failures.emplace_back(config, "couldn't start the process");
+		return;
+	}
+
+	// Keep the last line too, which explains what went wrong if there's no result.
+	std::string result_line;
+	std::string last_line;
+	std::string line;
+	char buffer[4096];
+	while (std::fgets(buffer, sizeof(buffer), child) != nullptr)
+	{
+		line += buffer;
+		if (line.empty() || line.back() != '\n')
+		{
+			continue;
+		}
+		line.pop_back();
+		if (line.compare(0, result_prefix.size(), result_prefix) == 0)
+		{
+			result_line = line.substr(result_prefix.size());
+		}
+		else if (!line.empty())
+		{
+			last_line = line;
+		}
+		line.clear();
+	}
+	pclose(child);
+
+	if (result_line.empty())
+	{
+		failures.emplace_back(config, last_line);
+		return;
+	}
+
+	const nlohmann::json node = nlohmann::json::parse(result_line);
+	result r;
+	r.config = config;
+	r.setup_ms = node.at("setup_ms").get<double>();
+	r.wall_ms = node.at("wall_ms").get<double>();
+	r.peak_rss_kb = node.at("peak_rss_kb").get<std::uint64_t>();
+	r.bots = node.at("bots").get<std::uint64_t>();
+	r.wavespawns = node.at("wavespawns").get<std::uint64_t>();
+	r.output_bytes = node.at("output_bytes").get<std::uint64_t>();
+	r.simulated_seconds = node.at("simulated_seconds").get<std::uint64_t>();
+	results.emplace_back(r);
+
+	std::cout << "  " << r.wall_ms << " ms, " << r.peak_rss_kb << " KB peak, " << r.wavespawns << " WaveSpawns." << std::endl;
+}
+
+void macro_benchmark::run_one(const std::string& bat_filename, unsigned int seed, const std::vector<item_category>& categories)
+{
+	// The arguments are passed on the way that main would get them.
+	std::vector<std::string> args = read_bat(bat_filename);
+	args.insert(args.begin(), "MannVsFate.exe");
+	std::vector<char*> argv;
+	for (std::string& arg : args)
+	{
+		argv.emplace_back(&arg.front());
+	}
+
+	const auto setup_start = std::chrono::steady_clock::now();
+	generator_data data(categories);
+	popfile_generator popgen(data);
+	popgen.apply_arguments(static_cast<int>(argv.size()), argv.data());
+	popgen.set_measure_output(true);
+	const auto generation_start = std::chrono::steady_clock::now();
+
+	rand_seed(seed);
+	const std::vector<wave_generator::wave_summary> summaries = popgen.simulate();
+	const auto generation_end = std::chrono::steady_clock::now();
+
+	std::uint64_t bots = 0;
+	std::uint64_t wavespawns = 0;
+	std::uint64_t output_bytes = 0;
+	std::uint64_t simulated_seconds = 0;
+	for (const wave_generator::wave_summary& summary : summaries)
+	{
+		bots += summary.bots;
+		wavespawns += summary.wavespawns;
+		output_bytes += summary.output_bytes;
+		simulated_seconds += summary.duration;
+	}
+
+	nlohmann::json node;
+	node["setup_ms"] = milliseconds_between(setup_start, generation_start);
+	node["wall_ms"] = milliseconds_between(generation_start, generation_end);
+	node["peak_rss_kb"] = get_peak_rss_kb();
+	node["bots"] = bots;
+	node["wavespawns"] = wavespawns;
+	node["output_bytes"] = output_bytes;
+	node["simulated_seconds"] = simulated_seconds;
+	std::cout << result_prefix << node.dump() << std::endl;
+}
+
+std::vector<std::string> macro_benchmark::read_bat(const std::string& bat_filename)
+{
+	std::ifstream bat(bat_filename);
+	if (!bat)
+	{
+		const std::string exstr = "macro_benchmark::read_bat exception: Couldn't read \"" + bat_filename + "\".";
+		throw std::exception(exstr.c_str());
+	}
+
+	// The command is the first line that isn't blank.
+	std::string line;
+	while (std::getline(bat, line) && line.find_first_not_of(" \t\r") == std::string::npos)
+	{
+	}
+
+	// Split the command into arguments, keeping quoted arguments together.
+	std::vector<std::string> args;
+	std::string arg;
+	bool quoted = false;
+	bool has_arg = false;
+	for (const char c : line)
+	{
+		if (c == '"')
+		{
+			quoted = !quoted;
+			has_arg = true;
+		}
+		else if (!quoted && (c == ' ' || c == '\t' || c == '\r'))
+		{
+			if (has_arg)
+			{
+				args.emplace_back(arg);
+				arg.clear();
+				has_arg = false;
+			}
+		}
+		else
+		{
+			arg += c;
+			has_arg = true;
+		}
+	}
+	if (has_arg)
+	{
+		args.emplace_back(arg);
+	}
+
+	// Most of the files start with the program's name, but some only have the options.
+	if (!args.empty() && args.front().size() >= 4)
+	{
+		std::string extension = args.front().substr(args.front().size() - 4);
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		if (extension == ".exe")
+		{
+			args.erase(args.begin());
+		}
+	}
+	return args;
+}
+
+const std::vector<macro_benchmark::result>& macro_benchmark::get_results() const
+{
+	return results;
+}
+
+void macro_benchmark::write_table(std::ostream& out) const
+{
+	out << std::left << std::setw(32) << "Configuration" << std::right << std::setw(12) << "Wall ms" << std::setw(12) << "Peak KB"
+		<< std::setw(12) << "Bots" << std::setw(12) << "WaveSpawns" << std::setw(14) << "Output bytes" << std::setw(12) << "Simulated s" << '\n';
+	for (const result& r : results)
+	{
+		out << std::left << std::setw(32) << r.config << std::right << std::setw(12) << r.wall_ms << std::setw(12) << r.peak_rss_kb
+			<< std::setw(12) << r.bots << std::setw(12) << r.wavespawns << std::setw(14) << r.output_bytes << std::setw(12) << r.simulated_seconds << '\n';
+	}
+}
+
+void macro_benchmark::write_json(std::ostream& out) const
+{
+	nlohmann::json configs = nlohmann::json::array();
+	for (const result& r : results)
+	{
+		nlohmann::json node;
+		node["config"] = r.config;
+		node["setup_ms"] = r.setup_ms;
+		node["wall_ms"] = r.wall_ms;
+		node["peak_rss_kb"] = r.peak_rss_kb;
+		node["bots"] = r.bots;
+		node["wavespawns"] = r.wavespawns;
+		node["output_bytes"] = r.output_bytes;
+		node["simulated_seconds"] = r.simulated_seconds;
+		configs.push_back(node);
+	}
+
+	nlohmann::json failed = nlohmann::json::object();
+	for (const auto& failure : failures)
+	{
+		failed[failure.first] = failure.second;
+	}
+
+	nlohmann::json root;
+	root["version"] = wave_generator::get_version();
+	root["seed"] = seed;
+	root["configs"] = configs;
+	root["failures"] = failed;
+	out << root.dump(1) << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+// Replays the mission configurations of the .bat files in REDIST, which are the generator's real workloads.
+// Each configuration runs headless in a process of its own with a fixed seed, so that its peak memory use can be measured and nothing is written to the disk.
+
+#ifndef MACRO_BENCHMARK_H
+#define MACRO_BENCHMARK_H
+
+#include "item_category.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+class macro_benchmark
+{
+public:
+	// What running one configuration measured.
+	struct result
+	{
+		// The name of the .bat file.
+		std::string config;
+		// How long setting up the generators took, in milliseconds.
+		double setup_ms;
+		// How long generating the mission took, in milliseconds.
+		double wall_ms;
+		// The most memory the process had resident, in kilobytes.
+		std::uint64_t peak_rss_kb;
+		// How many TFBots were generated.
+		std::uint64_t bots;
+		// How many WaveSpawns the mission has.
+		std::uint64_t wavespawns;
+		// How many bytes the mission's Missions and waves would take up in the popfile.
+		std::uint64_t output_bytes;
+		// How many seconds the mission's waves last in total.
+		std::uint64_t simulated_seconds;
+	};
+
+	// Constructor. The program is run again with -macrorun for each configuration.
+	macro_benchmark(const std::string& program, unsigned int seed);
+
+	// Only run configurations whose file names contain this. Empty to run every configuration.
+	void set_filter(const std::string& in);
+
+	// Run every .bat file in a directory, in alphabetical order.
+	void run_all(const std::string& directory);
+
+	// Run one .bat file in this process and print its result for the parent process to read.
+	static void run_one(const std::string& bat_filename, unsigned int seed, const std::vector<item_category>& categories);
+
+	// Get the arguments that a .bat file runs the generator with, without the program name.
+	static std::vector<std::string> read_bat(const std::string& bat_filename);
+
+	// Get the results of every configuration that has run so far.
+	const std::vector<result>& get_results() const;
+
+	// Write the results as a human readable table.
+	void write_table(std::ostream& out) const;
+	// Write the results as JSON.
+	void write_json(std::ostream& out) const;
+
+private:
+	// Run one .bat file in a child process and collect its result.
+	void run_child(const std::string& bat_filename);
+
+	// The program to run for each configuration.
+	std::string program;
+	// The seed that every configuration is generated with.
+	unsigned int seed;
+	// Only configurations whose file names contain this are run.
+	std::string filter;
+	// The results of every configuration that has run so far.
+	std::vector<result> results;
+	// The configurations that failed to run, with the reason.
+	std::vector<std::pair<std::string, std::string>> failures;
+};
+
+#endif
\ No newline at end of file
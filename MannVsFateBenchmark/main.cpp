@@ -0,0 +1,291 @@
+// Mann vs Fate Benchmarks
+//
+// Benchmarks of the wave generator. Run this from the REDIST directory so that the data files can be found.
+// By default, microbenchmarks time the generator's hot paths. With -macro, every .bat file's configuration is replayed instead,
+// and with -scaling, the number of players, the wave time and the number of WaveSpawns are swept to see how the cost grows.
+// With -json, the results are also written as JSON so that runs from different commits can be compared.
+// With -perf on Linux, the microbenchmarks also read the CPU's cycles, instructions, cache misses and branch misses.
+// With -verify, a fixed matrix of configurations is generated and compared with the checked in golden hashes instead,
+// so that an optimization can be shown not to change any mission. -bless writes the golden hashes again after an intended change.
+
+#include "benchmark_runner.h"
+#include "hardware_counters.h"
+#include "microbenchmarks.h"
+#include "macro_benchmark.h"
+#include "scaling_benchmark.h"
+#include "golden_verifier.h"
+#include "generator_data.h"
+#include "json_reader_item_category.h"
+#include "data_pack.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Open the compiled data pack, if there is one that still matches the data files.
+std::unique_ptr<data_pack> load_data_pack()
+{
+	try
+	{
+		std::unique_ptr<data_pack> pack = data_pack::open(data_pack::default_filename);
+		if (pack != nullptr && pack->is_stale())
+		{
+			pack.reset();
+		}
+		return pack;
+	}
+	catch (const std::exception&)
+	{
+		return nullptr;
+	}
+}
+
+// Find the golden hashes when no file is given, wherever the benchmarks are run from.
+// They're checked in next to this source file, so that's looked in first. Builds outside the source tree can keep them next to the executable.
+// If there are none yet, blessing creates them next to this source file.
+std::string find_golden_file(const char* program_path)
+{
+	const std::string golden_name = "golden_hashes.json";
+	const std::filesystem::path candidates[] =
+	{
+		std::filesystem::path(__FILE__).parent_path() / golden_name,
+		std::filesystem::path(program_path).parent_path() / golden_name,
+		std::filesystem::path("..") / "MannVsFateBenchmark" / golden_name
+	};
+	std::error_code ec;
+	for (const std::filesystem::path& candidate : candidates)
+	{
+		if (std::filesystem::is_regular_file(candidate, ec))
+		{
+			return candidate.string();
+		}
+	}
+	return candidates[0].string();
+}
+
+// Open the file to write the results to. Throws if it can't be written.
+std::ofstream open_results(const std::string& filename)
+{
+	std::ofstream file(filename);
+	if (!file)
+	{
+		const std::string exstr = "main exception: Couldn't write the results to \"" + filename + "\".";
+		throw std::exception(exstr.c_str());
+	}
+	return file;
+}
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		benchmark_runner runner;
+		std::string json_filename;
+		std::string filter;
+		bool macro = false;
+		std::string macro_directory = ".";
+		std::string macro_run;
+		unsigned int seed = 1;
+		bool scaling = false;
+		std::string map_name = "mvm_bigrock";
+		std::unique_ptr<unsigned int> repetitions;
+		bool perf = false;
+		bool verify = false;
+		bool bless = false;
+		std::string golden_filename;
+		double tolerance = 0.0;
+		for (int i = 1; i < argc; ++i)
+		{
+			if (std::strcmp(argv[i], "-macro") == 0)
+			{
+				macro = true;
+				// The directory is optional.
+				if (i + 1 < argc && argv[i + 1][0] != '-')
+				{
+					++i;
+					macro_directory = argv[i];
+				}
+				continue;
+			}
+			if (std::strcmp(argv[i], "-perf") == 0)
+			{
+				perf = true;
+				continue;
+			}
+			if (std::strcmp(argv[i], "-verify") == 0 || std::strcmp(argv[i], "-bless") == 0)
+			{
+				verify = std::strcmp(argv[i], "-verify") == 0;
+				bless = !verify;
+				// The golden file is optional.
+				if (i + 1 < argc && argv[i + 1][0] != '-')
+				{
+					++i;
+					golden_filename = argv[i];
+				}
+				continue;
+			}
+			if (std::strcmp(argv[i], "-tolerance") == 0 && i + 1 < argc)
+			{
+				++i;
+				tolerance = std::stod(argv[i]);
+				continue;
+			}
+			if (std::strcmp(argv[i], "-scaling") == 0)
+			{
+				scaling = true;
+				continue;
+			}
+			if (std::strcmp(argv[i], "-map") == 0 && i + 1 < argc)
+			{
+				++i;
+				map_name = argv[i];
+				continue;
+			}
+			if (std::strcmp(argv[i], "-macrorun") == 0 && i + 1 < argc)
+			{
+				++i;
+				macro_run = argv[i];
+				continue;
+			}
+			if (std::strcmp(argv[i], "-seed") == 0 && i + 1 < argc)
+			{
+				++i;
+				seed = static_cast<unsigned int>(std::stoul(argv[i]));
+				continue;
+			}
+			if (std::strcmp(argv[i], "-json") == 0 && i + 1 < argc)
+			{
+				++i;
+				json_filename = argv[i];
+				continue;
+			}
+			if (std::strcmp(argv[i], "-filter") == 0 && i + 1 < argc)
+			{
+				++i;
+				filter = argv[i];
+				continue;
+			}
+			if (std::strcmp(argv[i], "-mintime") == 0 && i + 1 < argc)
+			{
+				++i;
+				runner.set_min_time(std::stod(argv[i]));
+				continue;
+			}
+			if (std::strcmp(argv[i], "-repetitions") == 0 && i + 1 < argc)
+			{
+				++i;
+				repetitions = std::make_unique<unsigned int>(std::stoi(argv[i]));
+				continue;
+			}
+		}
+
+		// The configurations run in processes of their own, which don't need the data in this one.
+		if (macro)
+		{
+			macro_benchmark benchmark(argv[0], seed);
+			benchmark.set_filter(filter);
+			benchmark.run_all(macro_directory);
+
+			std::cout << std::endl;
+			benchmark.write_table(std::cout);
+			if (!json_filename.empty())
+			{
+				std::ofstream file = open_results(json_filename);
+				benchmark.write_json(file);
+				std::cout << "Wrote the results to " << json_filename << '.' << std::endl;
+			}
+			return 0;
+		}
+
+		// Benchmark against the same data that the generator would use.
+		std::unique_ptr<data_pack> pack = load_data_pack();
+		data_pack::set_active(pack.get());
+
+		const std::vector<item_category> categories = pack != nullptr ? pack->get_item_categories() : json_reader_item_category().read();
+
+		if (!macro_run.empty())
+		{
+			macro_benchmark::run_one(macro_run, seed, categories);
+			return 0;
+		}
+
+		if (verify || bless)
+		{
+			if (golden_filename.empty())
+			{
+				golden_filename = find_golden_file(argv[0]);
+			}
+			generator_data data(categories);
+			golden_verifier verifier(data, macro_directory);
+			verifier.set_tolerance(tolerance);
+			if (bless)
+			{
+				verifier.bless(golden_filename);
+				return 0;
+			}
+			return verifier.verify(golden_filename) ? 0 : 1;
+		}
+
+		if (scaling)
+		{
+			generator_data data(categories);
+			scaling_benchmark benchmark(data, map_name, seed);
+			if (repetitions != nullptr)
+			{
+				benchmark.set_repetitions(*repetitions);
+			}
+			benchmark.run_all();
+
+			std::cout << std::endl;
+			benchmark.write_table(std::cout);
+			if (!json_filename.empty())
+			{
+				std::ofstream file = open_results(json_filename);
+				benchmark.write_json(file);
+				std::cout << "Wrote the results to " << json_filename << '.' << std::endl;
+			}
+			return 0;
+		}
+
+		std::cout << (pack != nullptr ? "Using the data pack." : "Using the data files, since there's no up to date data pack.") << std::endl;
+
+		runner.set_filter(filter);
+		if (repetitions != nullptr)
+		{
+			runner.set_repetitions(*repetitions);
+		}
+		// The counters only count this thread, which is the thread that every microbenchmark runs on.
+		std::unique_ptr<hardware_counters> counters;
+		if (perf)
+		{
+			counters = std::make_unique<hardware_counters>();
+			if (counters->is_available())
+			{
+				runner.set_hardware_counters(counters.get());
+			}
+			else
+			{
+				std::cout << "Not reading hardware counters. " << counters->get_error() << std::endl;
+			}
+		}
+		run_microbenchmarks(runner, categories);
+
+		std::cout << std::endl;
+		runner.write_table(std::cout);
+
+		if (!json_filename.empty())
+		{
+			std::ofstream file = open_results(json_filename);
+			runner.write_json(file);
+			std::cout << "Wrote the results to " << json_filename << '.' << std::endl;
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
\ No newline at end of file
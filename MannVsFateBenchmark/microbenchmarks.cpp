@@ -0,0 +1,192 @@
+#include "microbenchmarks.h"
+#include "rand_util.h"
+#include "list_reader.h"
+#include "json_reader_weapon.h"
+#include "currency_manager.h"
+#include "pressure_manager.h"
+#include "generator_data.h"
+#include "bot_generator.h"
+#include "tank_generator.h"
+#include "popfile_writer.h"
+#include "class_table.h"
+#include "player_class.h"
+#include "event_counters.h"
+#include <cstdio>
+#include <string>
+
+namespace
+{
+	// The classes whose bots are generated, which is every class.
+	const player_class all_player_classes[] =
+	{
+		player_class::scout,
+		player_class::soldier,
+		player_class::pyro,
+		player_class::demoman,
+		player_class::heavyweapons,
+		player_class::engineer,
+		player_class::medic,
+		player_class::sniper,
+		player_class::spy
+	};
+
+	// Where write_tfbot writes to. It's removed afterwards.
+	const std::string scratch_popfile = "benchmark.popt";
+
+	void run_rand_benchmarks(benchmark_runner& runner)
+	{
+		rand_seed(1);
+
+		runner.run("rand_int", [](std::size_t iterations)
+		{
+			std::size_t total = 0;
+			for (std::size_t i = 0; i < iterations; ++i)
+			{
+				total += rand_int(0, 100);
+			}
+			benchmark_runner::keep(total);
+		});
+
+		runner.run("rand_float", [](std::size_t iterations)
+		{
+			float total = 0.0f;
+			for (std::size_t i = 0; i < iterations; ++i)
+			{
+				total += rand_float(0.0f, 1.0f);
+			}
+			benchmark_runner::keep(static_cast<std::size_t>(total));
+		});
+
+		runner.run("rand_chance", [](std::size_t iterations)
+		{
+			std::size_t total = 0;
+			for (std::size_t i = 0; i < iterations; ++i)
+			{
+				total += rand_chance(0.5f);
+			}
+			benchmark_runner::keep(total);
+		});
+	}
+
+	void run_data_benchmarks(benchmark_runner& runner)
+	{
+		list_reader reader;
+		const std::string nouns = "data/names/nouns.txt";
+		reader.preload(std::vector<std::string>{ nouns });
+
+		runner.run("list_reader::get_random", [&](std::size_t iterations)
+		{
+			std::size_t total = 0;
+			for (std::size_t i = 0; i < iterations; ++i)
+			{
+				total += reader.get_random(nouns).size();
+			}
+			benchmark_runner::keep(total);
+		});
+
+		// This always reads the weapons JSON, even when there's a data pack, since the reader is what's measured.
+		const json_reader_weapon weapon_reader;
+
+		runner.run("json_reader_weapon::read_weapon", [&](std::size_t iterations)
+		{
+			std::size_t total = 0;
+			for (std::size_t i = 0; i < iterations; ++i)
+			{
+				total += weapon_reader.read_weapon("The B.A.S.E. Jumper", player_class::soldier).names.size();
+			}
+			benchmark_runner::keep(total);
+		});
+	}
+
+	void run_generator_benchmarks(benchmark_runner& runner, const std::vector<item_category>& categories)
+	{
+		currency_manager cm;
+		pressure_manager pm(cm);
+		generator_data data(categories);
+		bot_generator botgen(pm, data);
+		tank_generator tankgen(pm);
+		pm.calculate_pressure_decay_rate();
+
+		for (const player_class cl : all_player_classes)
+		{
+			botgen.set_possible_classes(class_table(player_class_flag(cl)));
+			runner.run("bot_generator::generate_bot/" + player_class_to_string(cl), [&](std::size_t iterations)
+			{
+				std::size_t total = 0;
+				for (std::size_t i = 0; i < iterations; ++i)
+				{
+					total += botgen.generate_bot().get_bot().health;
+				}
+				benchmark_runner::keep(total);
+			});
+		}
+		botgen.set_possible_classes(class_table());
+
+		runner.run("tank_generator::generate_tank", [&](std::size_t iterations)
+		{
+			std::size_t total = 0;
+			for (std::size_t i = 0; i < iterations; ++i)
+			{
+				total += tankgen.generate_tank(300.0f)->health;
+			}
+			benchmark_runner::keep(total);
+		});
+
+		// Each WaveSpawn of a simulation spawns one bot, so the number of WaveSpawns is the number of live spawns.
+		// Every iteration copies the prepared simulation before stepping through it, since stepping uses the simulation up.
+		// The work is measured in simulated seconds, so that the costs of a tick can be compared across simulation sizes.
+		for (const unsigned int live_spawns : { 1u, 10u, 100u, 1000u })
+		{
+			currency_manager prepared_cm;
+			pressure_manager prepared(prepared_cm);
+			prepared.calculate_pressure_decay_rate();
+			virtual_wavespawn vws = {};
+			vws.effective_pressure = 100.0f;
+			vws.time_to_kill = 30.0f;
+			vws.wait_between_spawns = 30.0f;
+			vws.time_until_next_spawn = 30.0f;
+			vws.spawns_remaining = 0;
+			for (unsigned int i = 0; i < live_spawns; ++i)
+			{
+				prepared.add_virtual_wavespawn(vws);
+			}
+
+			runner.run("pressure_manager::step_through_time/" + std::to_string(live_spawns), event_counters::counter::simulation_ticks, [&](std::size_t iterations)
+			{
+				std::size_t total = 0;
+				for (std::size_t i = 0; i < iterations; ++i)
+				{
+					currency_manager copy_cm;
+					pressure_manager copy(prepared, copy_cm);
+					int t = 0;
+					copy.step_through_time(t);
+					total += t;
+				}
+				benchmark_runner::keep(total);
+			});
+		}
+
+		const tfbot bot = botgen.generate_bot().get_bot();
+		const std::vector<std::string> spawnbots = { "spawnbot", "spawnbot_left", "spawnbot_right" };
+		popfile_writer writer;
+
+		runner.run("popfile_writer::write_tfbot", [&](std::size_t iterations)
+		{
+			// Each repetition starts the file over so that it doesn't keep growing.
+			writer.popfile_open(scratch_popfile);
+			for (std::size_t i = 0; i < iterations; ++i)
+			{
+				writer.write_tfbot(bot, spawnbots);
+			}
+			writer.popfile_close();
+		});
+		std::remove(scratch_popfile.c_str());
+	}
+}
+
+void run_microbenchmarks(benchmark_runner& runner, const std::vector<item_category>& categories)
+{
+	run_rand_benchmarks(runner);
+	run_data_benchmarks(runner);
+	run_generator_benchmarks(runner, categories);
+}
\ No newline at end of file
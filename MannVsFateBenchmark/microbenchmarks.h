@@ -0,0 +1,13 @@
+// Microbenchmarks of the generator's hot paths.
+
+#ifndef MICROBENCHMARKS_H
+#define MICROBENCHMARKS_H
+
+#include "benchmark_runner.h"
+#include "item_category.h"
+#include <vector>
+
+// Run every microbenchmark. Has to run from the directory containing the data directory.
+void run_microbenchmarks(benchmark_runner& runner, const std::vector<item_category>& categories);
+
+#endif
\ No newline at end of file
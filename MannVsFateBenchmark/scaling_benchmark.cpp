@@ -0,0 +1,295 @@
+#include "scaling_benchmark.h"
+#include "popfile_generator.h"
+#include "wave_generator.h"
+#include "rand_util.h"
+#include "time_util.h"
+#include "json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+	// Values from bottom to top, going up by about half an order of magnitude at a time: 1, 3, 10, 30, 100...
+	std::vector<double> half_decades(double bottom, double top)
+	{
+		std::vector<double> values;
+		for (double decade = bottom; decade <= top; decade *= 10.0)
+		{
+			values.emplace_back(decade);
+			if (decade * 3.0 <= top)
+			{
+				values.emplace_back(decade * 3.0);
+			}
+		}
+		return values;
+	}
+
+	// Values from bottom to top, doubling each time.
+	std::vector<double> doublings(double bottom, double top)
+	{
+		std::vector<double> values;
+		for (double value = bottom; value <= top; value *= 2.0)
+		{
+			values.emplace_back(value);
+		}
+		return values;
+	}
+
+	// Write a value of an option the way it would be typed.
+	std::string format_value(double value)
+	{
+		std::ostringstream ss;
+		ss << std::setprecision(12) << value;
+		return ss.str();
+	}
+}
+
+scaling_benchmark::scaling_benchmark(generator_data& data, const std::string& map_name, unsigned int seed)
+	: data(data), map_name(map_name), seed(seed), repetitions(3)
+{}
+
+void scaling_benchmark::set_repetitions(unsigned int in)
+{
+	repetitions = std::max(1u, in);
+}
+
+void scaling_benchmark::run_all()
+{
+	// The biggest REDIST configurations have millions of players.
+	run_sweep("-players", half_decades(1.0, 1000000.0), {});
+	run_sweep("-time", doublings(30.0, 7680.0), { "-players", "4" });
+	// The time and icon limits are lifted so that the WaveSpawn limit is what ends each wave.
+	run_sweep("-wavespawns", half_decades(1.0, 10000.0), { "-players", "4", "-time", "1000000", "-icons", "0" });
+}
+
+void scaling_benchmark::run_sweep(const std::string& option, const std::vector<double>& values, const std::vector<std::string>& base_arguments)
+{
+	sweep s;
+	s.option = option;
+	s.base_arguments = base_arguments;
+	for (const double value : values)
+	{
+		std::cout << "Generating with " << option << ' ' << format_value(value) << "..." << std::endl;
+		try
+		{
+			s.points.emplace_back(measure(option, value, base_arguments));
+		}
+		catch (const std::exception& e)
+		{
+			// Bigger values would only fail the same way, or take even longer to.
+			s.failure = option + ' ' + format_value(value) + ": " + e.what();
+			std::cout << s.failure << std::endl;
+			break;
+		}
+	}
+	sweeps.emplace_back(s);
+}
+
+scaling_benchmark::point scaling_benchmark::measure(const std::string& option, double value, const std::vector<std::string>& base_arguments) const
+{
+	// The arguments are passed on the way that main would get them.
+	std::vector<std::string> args = { "MannVsFate.exe", "-map", map_name };
+	args.insert(args.end(), base_arguments.begin(), base_arguments.end());
+	args.emplace_back(option);
+	args.emplace_back(format_value(value));
+	std::vector<char*> argv;
+	for (std::string& arg : args)
+	{
+		argv.emplace_back(&arg.front());
+	}
+
+	point p = {};
+	p.value = value;
+	for (unsigned int i = 0; i < repetitions; ++i)
+	{
+		popfile_generator popgen(data);
+		popgen.apply_arguments(static_cast<int>(argv.size()), argv.data());
+		rand_seed(seed);
+
+		const auto start = std::chrono::steady_clock::now();
+		const std::vector<wave_generator::wave_summary> summaries = popgen.simulate();
+		const double ms = milliseconds_between(start, std::chrono::steady_clock::now());
+
+		// Every repetition generates the same mission, so only the time can differ.
+		if (i == 0 || ms < p.ms)
+		{
+			p.ms = ms;
+		}
+		if (i == 0)
+		{
+			for (const wave_generator::wave_summary& summary : summaries)
+			{
+				p.wavespawns += summary.wavespawns;
+				p.health_fitting_iterations += summary.health_fitting_iterations;
+				p.peak_live_spawns = std::max(p.peak_live_spawns, summary.peak_live_spawns);
+				p.simulated_seconds += summary.duration;
+			}
+		}
+	}
+	return p;
+}
+
+scaling_benchmark::fit scaling_benchmark::fit_power_law(const std::vector<double>& x, const std::vector<double>& y)
+{
+	std::vector<double> log_x;
+	std::vector<double> log_y;
+	for (std::size_t i = 0; i < x.size() && i < y.size(); ++i)
+	{
+		if (x.at(i) > 0.0 && y.at(i) > 0.0)
+		{
+			log_x.emplace_back(std::log(x.at(i)));
+			log_y.emplace_back(std::log(y.at(i)));
+		}
+	}
+
+	fit f = { 0.0, 0.0, 0.0 };
+	const double n = static_cast<double>(log_x.size());
+	if (log_x.size() < 2)
+	{
+		return f;
+	}
+
+	double mean_x = 0.0;
+	double mean_y = 0.0;
+	for (std::size_t i = 0; i < log_x.size(); ++i)
+	{
+		mean_x += log_x.at(i);
+		mean_y += log_y.at(i);
+	}
+	mean_x /= n;
+	mean_y /= n;
+
+	double sxx = 0.0;
+	double sxy = 0.0;
+	double syy = 0.0;
+	for (std::size_t i = 0; i < log_x.size(); ++i)
+	{
+		const double dx = log_x.at(i) - mean_x;
+		const double dy = log_y.at(i) - mean_y;
+		sxx += dx * dx;
+		sxy += dx * dy;
+		syy += dy * dy;
+	}
+	if (sxx == 0.0)
+	{
+		return f;
+	}
+
+	f.exponent = sxy / sxx;
+	f.coefficient = std::exp(mean_y - f.exponent * mean_x);
+	// A measurement that doesn't change at all is fitted perfectly by a flat line.
+	f.r_squared = syy == 0.0 ? 1.0 : (sxy * sxy) / (sxx * syy);
+	return f;
+}
+
+std::vector<std::pair<std::string, scaling_benchmark::fit>> scaling_benchmark::fit_sweep(const sweep& s)
+{
+	std::vector<double> values;
+	std::vector<double> ms;
+	std::vector<double> wavespawns;
+	std::vector<double> health_fitting_iterations;
+	std::vector<double> peak_live_spawns;
+	for (const point& p : s.points)
+	{
+		values.emplace_back(p.value);
+		ms.emplace_back(p.ms);
+		wavespawns.emplace_back(static_cast<double>(p.wavespawns));
+		health_fitting_iterations.emplace_back(static_cast<double>(p.health_fitting_iterations));
+		peak_live_spawns.emplace_back(static_cast<double>(p.peak_live_spawns));
+	}
+	// Costs that grow faster than their sweep overall tend to only show it at the top of the sweep, so the top half gets a curve of its own.
+	const std::size_t half = values.size() / 2;
+	const std::vector<double> upper_values(values.begin() + half, values.end());
+	const std::vector<double> upper_ms(ms.begin() + half, ms.end());
+
+	return
+	{
+		{ "ms", fit_power_law(values, ms) },
+		{ "ms_upper_half", fit_power_law(upper_values, upper_ms) },
+		{ "wavespawns", fit_power_law(values, wavespawns) },
+		{ "health_fitting_iterations", fit_power_law(values, health_fitting_iterations) },
+		{ "peak_live_spawns", fit_power_law(values, peak_live_spawns) }
+	};
+}
+
+void scaling_benchmark::write_table(std::ostream& out) const
+{
+	for (const sweep& s : sweeps)
+	{
+		out << "Sweeping " << s.option << " on " << map_name;
+		for (const std::string& arg : s.base_arguments)
+		{
+			out << ' ' << arg;
+		}
+		out << ":\n";
+		out << std::right << std::setw(12) << s.option << std::setw(14) << "ms" << std::setw(12) << "WaveSpawns"
+			<< std::setw(16) << "Fitting iters" << std::setw(14) << "Peak spawns" << std::setw(14) << "Simulated s" << '\n';
+		for (const point& p : s.points)
+		{
+			out << std::setw(12) << format_value(p.value) << std::setw(14) << p.ms << std::setw(12) << p.wavespawns
+				<< std::setw(16) << p.health_fitting_iterations << std::setw(14) << p.peak_live_spawns << std::setw(14) << p.simulated_seconds << '\n';
+		}
+		if (!s.failure.empty())
+		{
+			out << "Stopped at " << s.failure << '\n';
+		}
+		for (const auto& f : fit_sweep(s))
+		{
+			out << "  " << f.first << " ~ " << f.second.coefficient << " * n^" << f.second.exponent << " (r^2 = " << f.second.r_squared << ")\n";
+		}
+		out << '\n';
+	}
+}
+
+void scaling_benchmark::write_json(std::ostream& out) const
+{
+	nlohmann::json sweeps_node = nlohmann::json::array();
+	for (const sweep& s : sweeps)
+	{
+		nlohmann::json points = nlohmann::json::array();
+		for (const point& p : s.points)
+		{
+			nlohmann::json node;
+			node["value"] = p.value;
+			node["ms"] = p.ms;
+			node["wavespawns"] = p.wavespawns;
+			node["health_fitting_iterations"] = p.health_fitting_iterations;
+			node["peak_live_spawns"] = p.peak_live_spawns;
+			node["simulated_seconds"] = p.simulated_seconds;
+			points.push_back(node);
+		}
+
+		nlohmann::json fits = nlohmann::json::object();
+		for (const auto& f : fit_sweep(s))
+		{
+			nlohmann::json node;
+			node["coefficient"] = f.second.coefficient;
+			node["exponent"] = f.second.exponent;
+			node["r_squared"] = f.second.r_squared;
+			fits[f.first] = node;
+		}
+
+		nlohmann::json node;
+		node["option"] = s.option;
+		node["base_arguments"] = s.base_arguments;
+		node["points"] = points;
+		node["fits"] = fits;
+		if (!s.failure.empty())
+		{
+			node["failure"] = s.failure;
+		}
+		sweeps_node.push_back(node);
+	}
+
+	nlohmann::json root;
+	root["version"] = wave_generator::get_version();
+	root["map"] = map_name;
+	root["seed"] = seed;
+	root["repetitions"] = repetitions;
+	root["sweeps"] = sweeps_node;
+	out << root.dump(1) << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+// Measures how the cost of generating a mission grows with one option, such as the number of players.
+// Each option is swept on a log scale with a fixed map and seed, and a power law is fitted to each measurement,
+// so that an exponent well above 1 points at pathological scaling.
+
+#ifndef SCALING_BENCHMARK_H
+#define SCALING_BENCHMARK_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+class generator_data;
+
+class scaling_benchmark
+{
+public:
+	// What generating one mission of a sweep measured.
+	struct point
+	{
+		// The value of the swept option.
+		double value;
+		// The fastest time that generating the mission took, in milliseconds.
+		double ms;
+		// How many WaveSpawns the mission has.
+		std::uint64_t wavespawns;
+		// How many times a TFBot's health and count were refitted.
+		std::uint64_t health_fitting_iterations;
+		// The most virtual spawns that were alive at once in any wave.
+		std::uint64_t peak_live_spawns;
+		// How many seconds the mission's waves last in total.
+		std::uint64_t simulated_seconds;
+	};
+
+	// A power law fitted to a measurement: y = coefficient * value ^ exponent.
+	struct fit
+	{
+		double coefficient;
+		double exponent;
+		// How well the law fits in log space, from 0 to 1.
+		double r_squared;
+	};
+
+	// One option swept over several values.
+	struct sweep
+	{
+		// The option that was swept.
+		std::string option;
+		// The options that every mission of the sweep was generated with, apart from the swept one.
+		std::vector<std::string> base_arguments;
+		// The missions that were generated, in order of value.
+		std::vector<point> points;
+		// Why the sweep stopped early. Empty if it didn't.
+		std::string failure;
+	};
+
+	// Constructor.
+	scaling_benchmark(generator_data& data, const std::string& map_name, unsigned int seed);
+
+	// Set how many times each mission is generated. The fastest time is kept.
+	void set_repetitions(unsigned int in);
+
+	// Sweep the number of players, the wave time and the number of WaveSpawns.
+	void run_all();
+
+	// Generate a mission for each value of an option, stopping at the first mission that fails.
+	void run_sweep(const std::string& option, const std::vector<double>& values, const std::vector<std::string>& base_arguments);
+
+	// Fit a power law by least squares in log space. Points that aren't positive are left out.
+	static fit fit_power_law(const std::vector<double>& x, const std::vector<double>& y);
+
+	// Write the results and the fitted curves as human readable tables.
+	void write_table(std::ostream& out) const;
+	// Write the results and the fitted curves as JSON.
+	void write_json(std::ostream& out) const;
+
+private:
+	// Generate one mission.
+	point measure(const std::string& option, double value, const std::vector<std::string>& base_arguments) const;
+
+	// Fit a power law to each measurement of a sweep.
+	static std::vector<std::pair<std::string, fit>> fit_sweep(const sweep& s);
+
+	// The data that the generators are constructed with.
+	generator_data& data;
+	// The map that every mission is generated for.
+	std::string map_name;
+	// The seed that every mission is generated with.
+	unsigned int seed;
+	// How many times each mission is generated.
+	unsigned int repetitions;
+	// Every sweep that has run so far.
+	std::vector<sweep> sweeps;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+# Checks that concurrent -serve requests for the same popfile don't write over each other.
+# Run it from the REDIST directory that tools/build_gcc.sh sets up, with the path of the generator it builds:
+#   tools/build_gcc.sh
+#   cd build_gcc/REDIST && python3 ../../tests/serve_concurrency_test.py ../MannVsFate
+# It starts a server with several workers, sends the same request on several connections at once a few times,
+# and checks that every reply succeeds and that the popfile it points at is complete.
+
+import json
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+REQUESTS = 6
+ROUNDS = 3
+ARGS = ["-map", "mvm_bigrock", "-players", "4", "-name", "serve_concurrency"]
+
+
+def request(socket_path, line, replies, index):
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as client:
+        client.connect(socket_path)
+        client.sendall((line + "\n").encode())
+        reply = b""
+        while not reply.endswith(b"\n"):
+            received = client.recv(65536)
+            if not received:
+                break
+            reply += received
+    replies[index] = json.loads(reply)
+
+
+def is_complete(path):
+    # A complete popfile closes its WaveSchedule block, so its braces balance and the last one closes it.
+    with open(path, encoding="utf-8", errors="replace") as popfile:
+        contents = popfile.read()
+    return "WaveSchedule" in contents and contents.count("{") == contents.count("}") and contents.rstrip().endswith("}")
+
+
+def main():
+    if len(sys.argv) != 2:
+        print("Usage: serve_concurrency_test.py <path to the generator>")
+        return 2
+
+    socket_path = os.path.join(tempfile.mkdtemp(), "mvf.sock")
+    server = subprocess.Popen([sys.argv[1], "-serve", socket_path, "-workers", str(REQUESTS)], stdout=subprocess.DEVNULL)
+    try:
+        for _ in range(100):
+            if os.path.exists(socket_path):
+                break
+            time.sleep(0.1)
+        else:
+            print("FAIL: The server didn't start.")
+            return 1
+
+        failures = 0
+        for round_number in range(1, ROUNDS + 1):
+            for reply_mode in ("path", "bytes"):
+                line = json.dumps({"args": ARGS, "reply": reply_mode})
+                replies = [None] * REQUESTS
+                threads = [threading.Thread(target=request, args=(socket_path, line, replies, i)) for i in range(REQUESTS)]
+                for thread in threads:
+                    thread.start()
+                for thread in threads:
+                    thread.join()
+
+                for i, reply in enumerate(replies):
+                    if reply is None or not reply.get("ok"):
+                        print("FAIL: Round %d, %s request %d: %s" % (round_number, reply_mode, i, reply))
+                        failures += 1
+                    elif reply_mode == "path" and not is_complete(reply["path"]):
+                        print("FAIL: Round %d, path request %d: %s is incomplete." % (round_number, i, reply["path"]))
+                        failures += 1
+                    elif reply_mode == "bytes" and not reply["popfile"].rstrip().endswith("}"):
+                        print("FAIL: Round %d, bytes request %d: The popfile is incomplete." % (round_number, i))
+                        failures += 1
+
+        leftovers = [name for name in os.listdir(".") if name.startswith(".serve_staging_") and os.listdir(name)]
+        if leftovers:
+            print("FAIL: Staging folders weren't cleaned up: %s" % leftovers)
+            failures += 1
+
+        print("%d rounds of %d concurrent requests, %d failures." % (ROUNDS, REQUESTS, failures))
+        return 1 if failures else 0
+    finally:
+        server.terminate()
+        server.wait()
+        for name in os.listdir("."):
+            if name.startswith("mvm_bigrock_4p_serve_concurrency"):
+                os.remove(name)
+            elif name.startswith(".serve_staging_") and not os.listdir(name):
+                # A terminated server doesn't get to remove its staging folder.
+                os.rmdir(name)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,52 @@
+#!/bin/sh
+# Builds the generator and the benchmarks with GCC, for Linux, into build_gcc/ at the top of the source tree.
+# The Visual Studio projects are the main build. This one exists so that the golden hashes in
+# MannVsFateBenchmark/golden_hashes.json can be verified and blessed again without MSVC:
+#   tools/build_gcc.sh
+#   cd build_gcc/REDIST && ../MannVsFateBenchmark -verify
+#
+# The sources use a few things that only MSVC accepts, so they're copied to build_gcc/src and patched there first.
+# The source tree itself is never changed.
+
+set -e
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+out="$root/build_gcc"
+src="$out/src"
+
+rm -rf "$src"
+mkdir -p "$src"
+cp -r "$root/MannVsFate" "$root/MannVsFateBenchmark" "$src/"
+
+# MSVC's std::exception takes a message, which the standard's doesn't.
+sed -i 's/std::exception(\([^)]\)/std::runtime_error(\1/g' "$src"/MannVsFate/*.cpp "$src"/MannVsFate/*.h "$src"/MannVsFateBenchmark/*.cpp "$src"/MannVsFateBenchmark/*.h
+# MSVC lets a vector of WaveSpawns grow through wavespawn's copy constructor, which takes a non-const reference.
+sed -i '0,/^\t{}$/s//\t{}\n\twavespawn(wavespawn\&\& ws) : wavespawn(ws) {}/' "$src/MannVsFate/wavespawn.h"
+
+# MSVC's headers include more of the standard library than the sources ask for.
+# __FILE__ is mapped back to the source tree, so that the benchmarks find and bless the checked in golden hashes.
+# Two warnings are turned off because the bundled json.hpp sets them off: it derives from std::iterator, which C++17 deprecates,
+# and GCC can't tell that the values it swaps are initialized.
+flags="-std=c++17 -O2 -Wall -Wextra -Wno-deprecated-declarations -Wno-maybe-uninitialized -pthread -ffile-prefix-map=$src=$root
+	-include stdexcept -include cstring -include cmath -include fstream -include memory -include vector -include string -include algorithm"
+
+generator_sources=$(ls "$src"/MannVsFate/*.cpp)
+g++ $flags $generator_sources -o "$out/MannVsFate"
+echo "Built $out/MannVsFate."
+
+library_sources=$(ls "$src"/MannVsFate/*.cpp | grep -v '/main\.cpp$')
+g++ $flags -I"$src/MannVsFate" "$src"/MannVsFateBenchmark/*.cpp $library_sources -o "$out/MannVsFateBenchmark"
+echo "Built $out/MannVsFateBenchmark."
+
+# The data files are looked up with the case of the class names, which only works on a case insensitive file system.
+# build_gcc/REDIST is a copy of REDIST to run from, with the class folders linked under those names too.
+rm -rf "$out/REDIST"
+cp -r "$root/REDIST" "$out/REDIST"
+for folder in "$out"/REDIST/data/items/*/; do
+	name=$(basename "$folder")
+	capitalized=$(echo "$name" | sed 's/^./\U&/')
+	if [ "$name" != "$capitalized" ] && [ ! -e "$out/REDIST/data/items/$capitalized" ]; then
+		ln -s "$name" "$out/REDIST/data/items/$capitalized"
+	fi
+done
+echo "Copied REDIST to $out/REDIST."